@@ -0,0 +1,277 @@
+#ifndef AFFINITY_H_INCLUDED
+#define AFFINITY_H_INCLUDED
+
+/**
+ * \file     affinity.hpp
+ * \mainpage Processor topology of the host and pinning of the OpenMP threads to
+ *           hardware threads according to different placement policies. The
+ *           threads pin themselves inside a parallel region, later parallel
+ *           regions with the same number of threads reuse the pinned threads.
+ * \warning  Pinning is only supported on Linux, on other operating systems the
+ *           threads are placed by the operating system.
+*/
+
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#ifdef __linux__
+    #include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+/**\enum  Placement
+ * \brief Policies for placing the OpenMP threads on the hardware threads
+*/
+enum class Placement
+{
+    none,     ///< no pinning, placement is left to the operating system
+    compact,  ///< fill the physical cores of a socket first, then their SMT siblings, then the next socket
+    scatter,  ///< distribute round-robin over the sockets, SMT siblings last
+    cores,    ///< one thread per physical core only (limited to the number of physical cores)
+    smt       ///< fill all SMT siblings of a physical core before moving on to the next core
+};
+
+
+/**\fn        placement_name
+ * \brief     Name of a placement \p policy
+ *
+ * \param[in] policy   the placement policy
+ * \return    The name of the policy
+*/
+inline char const* placement_name(Placement const policy)
+{
+    switch (policy)
+    {
+        case Placement::none:    return "none";
+        case Placement::compact: return "compact";
+        case Placement::scatter: return "scatter";
+        case Placement::cores:   return "cores";
+        case Placement::smt:     return "smt";
+    }
+    return "unknown";
+}
+
+
+/**\fn        placement_from_string
+ * \brief     Parse a placement policy from a string \p str such as "scatter"
+ *
+ * \param[in]  str      the string to be parsed
+ * \param[out] policy   the parsed placement policy
+ * \return     Boolean flag signalling if the string could be parsed
+*/
+inline bool placement_from_string(std::string const &str, Placement &policy)
+{
+    for (Placement const p: {Placement::none, Placement::compact, Placement::scatter, Placement::cores, Placement::smt})
+    {
+        if (str == placement_name(p))
+        {
+            policy = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**\struct HardwareThread
+ * \brief  A logical processor and its position in the topology of the host
+*/
+struct HardwareThread
+{
+    int cpu     = 0;  ///< logical processor number of the operating system
+    int package = 0;  ///< physical package (socket)
+    int core    = 0;  ///< physical core within the package
+    int smt     = 0;  ///< index among the SMT siblings of the physical core
+    int rank    = 0;  ///< index of the physical core within its package
+};
+
+
+/**\fn        read_topology_value
+ * \brief     Read a single integer from the sysfs topology of processor \p cpu
+ *
+ * \param[in] cpu    the logical processor
+ * \param[in] name   the name of the entry (e.g. "core_id")
+ * \return    The value or -1 if it could not be read
+*/
+inline int read_topology_value(int const cpu, char const* const name)
+{
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+    int value = -1;
+    if (file)
+    {
+        file >> value;
+    }
+    return value;
+}
+
+
+/**\fn        detect_topology
+ * \brief     Determine the hardware threads the process may run on and their
+ *            position in the topology of the host. Without information on the
+ *            topology every logical processor is treated as a physical core.
+ *
+ * \return    Vector of hardware threads sorted by logical processor number
+*/
+inline std::vector<HardwareThread> detect_topology()
+{
+    std::vector<HardwareThread> threads;
+
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                HardwareThread t;
+                t.cpu     = cpu;
+                t.package = std::max(read_topology_value(cpu, "physical_package_id"), 0);
+                t.core    = read_topology_value(cpu, "core_id");
+                t.core    = (t.core < 0) ? cpu : t.core;
+                threads.push_back(t);
+            }
+        }
+    }
+#endif
+
+    if (threads.empty() == true)
+    {
+        #ifdef _OPENMP
+            int const no_procs = omp_get_num_procs();
+        #else
+            int const no_procs = 1;
+        #endif
+        for (int cpu = 0; cpu < no_procs; ++cpu)
+        {
+            HardwareThread t;
+            t.cpu  = cpu;
+            t.core = cpu;
+            threads.push_back(t);
+        }
+    }
+
+    // number the SMT siblings of each core as well as the cores within each package
+    std::vector<std::tuple<int,int>> cores;
+    for (HardwareThread &t: threads)
+    {
+        std::tuple<int,int> const id{t.package, t.core};
+        t.smt = static_cast<int>(std::count(cores.begin(), cores.end(), id));
+        cores.push_back(id);
+    }
+    for (HardwareThread &t: threads)
+    {
+        std::vector<int> package_cores;
+        for (HardwareThread const &o: threads)
+        {
+            if ((o.package == t.package) && (o.smt == 0))
+            {
+                package_cores.push_back(o.core);
+            }
+        }
+        std::sort(package_cores.begin(), package_cores.end());
+        t.rank = static_cast<int>(std::lower_bound(package_cores.begin(), package_cores.end(), t.core) - package_cores.begin());
+    }
+
+    return threads;
+}
+
+
+/**\fn        placement_order
+ * \brief     Order in which the hardware threads are assigned to the OpenMP threads
+ *            for a given placement \p policy
+ *
+ * \param[in] topology   the hardware threads of the host
+ * \param[in] policy     the placement policy
+ * \return    Logical processor numbers, the i-th OpenMP thread is pinned to the i-th
+*/
+inline std::vector<int> placement_order(std::vector<HardwareThread> topology, Placement const policy)
+{
+    auto const key = [policy](HardwareThread const &t)
+    {
+        switch (policy)
+        {
+            case Placement::scatter: return std::make_tuple(t.smt, t.rank, t.package, t.cpu);
+            case Placement::smt:     return std::make_tuple(t.package, t.rank, t.smt, t.cpu);
+            case Placement::none:
+            case Placement::compact:
+            case Placement::cores:   break;
+        }
+        return std::make_tuple(t.package, t.smt, t.rank, t.cpu);
+    };
+
+    if (policy == Placement::cores)
+    {
+        topology.erase(std::remove_if(topology.begin(), topology.end(),
+                                      [](HardwareThread const &t){ return t.smt > 0; }), topology.end());
+    }
+    std::sort(topology.begin(), topology.end(),
+              [&key](HardwareThread const &a, HardwareThread const &b){ return key(a) < key(b); });
+
+    std::vector<int> order;
+    for (HardwareThread const &t: topology)
+    {
+        order.push_back(t.cpu);
+    }
+    return order;
+}
+
+
+/**\fn        pin_threads
+ * \brief     Set the number of OpenMP threads to \p no_threads and pin the i-th thread
+ *            of the team to the i-th logical processor in \p order. Without pinning
+ *            (empty order) all threads may run on every processor of the process.
+ *
+ * \param[in] no_threads   number of OpenMP threads
+ * \param[in] order        logical processors as returned by placement_order
+ * \return    Boolean flag signalling if all threads could be pinned
+*/
+inline bool pin_threads(size_t const no_threads, std::vector<int> const &order)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(static_cast<int>(no_threads));
+#endif
+
+#ifdef __linux__
+    // allow every thread to run on all processors that the process may run on
+    static cpu_set_t const initial = []()
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        return set;
+    }();
+
+    bool success = true;
+    #pragma omp parallel num_threads(no_threads) reduction(&&: success)
+    {
+        #ifdef _OPENMP
+            size_t const thread = static_cast<size_t>(omp_get_thread_num());
+        #else
+            size_t const thread = 0;
+        #endif
+
+        cpu_set_t set = initial;
+        if (thread < order.size())
+        {
+            CPU_ZERO(&set);
+            CPU_SET(order[thread], &set);
+        }
+        success = (sched_setaffinity(0, sizeof(set), &set) == 0);
+    }
+    return success;
+#else
+    return order.empty();
+#endif
+}
+
+#endif // AFFINITY_H_INCLUDED
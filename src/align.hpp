@@ -1,28 +1,345 @@
 #ifndef ALIGN_H_INCLUDED
 #define ALIGN_H_INCLUDED
 
-/**
- * \file     align.hpp
- * \mainpage File for setting cache related settings
+/**
+ * \file     align.hpp
+ * \mainpage File for setting cache related settings as well as a cache-aligned
+ *           allocator (optionally backed by huge pages) and a cache-aligned and
+ *           padded buffer that the span kernels can consume directly.
 */
 
 
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/mman.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "numa.hpp"
+
+
 /// size of the cache line of the architecture (typically 64 bit)
 #define CACHE_LINE    64
 
+/// size of a huge page (2 MiB on x86-64), allocations of at least this size may be backed by huge pages
+#define HUGE_PAGE     (2 << 20)
+
 /// define type to be used for arrays and vectors (must match the intrinsic data type!)
 typedef double        INTR;
 
 /// macro for padding
 #define PAD(N,T)      ((CACHE_LINE - sizeof(T)*N % CACHE_LINE) % CACHE_LINE) / sizeof(T)
 
-/// turn boost library aligned allocator on and off with variadic macro
-#if __has_include (<boost/align/aligned_allocator.hpp>)
-    #include <boost/align/aligned_allocator.hpp>
-    #include <boost/version.hpp>
-    #define VEC(T) std::vector<T, boost::alignment::aligned_allocator<T, CACHE_LINE>>
-#else
-    #define VEC(T) std::vector<T>
-#endif
+
+/**\enum  HugePages
+ * \brief Backing of large allocations (at least HUGE_PAGE bytes) by huge pages
+*/
+enum class HugePages
+{
+    none,         ///< regular pages only
+    transparent,  ///< regular mapping that is advised to be backed by transparent huge pages (madvise)
+    hugetlb       ///< explicit huge pages from the pool of the kernel (MAP_HUGETLB), transparent if none are available
+};
+
+
+/**\fn        huge_pages
+ * \brief     Process-wide policy for backing large allocations of the AlignedAllocator
+ *            by huge pages (default: transparent huge pages)
+ *
+ * \return    Reference to the policy
+*/
+inline HugePages& huge_pages()
+{
+    static HugePages policy = HugePages::transparent;
+    return policy;
+}
+
+
+/**\fn         huge_pages_from_string
+ * \brief      Parse a huge page policy from a string \p str ("none", "thp" or "explicit")
+ *
+ * \param[in]  str      the string to be parsed
+ * \param[out] policy   the parsed policy
+ * \return     Boolean flag signalling if the string could be parsed
+*/
+inline bool huge_pages_from_string(std::string const &str, HugePages &policy)
+{
+    if      (str == "none")     policy = HugePages::none;
+    else if (str == "thp")      policy = HugePages::transparent;
+    else if (str == "explicit") policy = HugePages::hugetlb;
+    else return false;
+    return true;
+}
+
+
+/**\class AlignedAllocator
+ * \brief Allocator for standard containers that guarantees an alignment of \p Alignment
+ *        bytes (at least a cache line). Allocations of at least HUGE_PAGE bytes are
+ *        mapped directly from the operating system (Linux) and backed by huge pages
+ *        according to the policy huge_pages() and placed on the NUMA nodes according to
+ *        numa_placement(). Whether a block is mapped or not only depends on its size so
+ *        that it is deallocated consistently. Elements are default-initialised (i.e.
+ *        not touched for arithmetic types) so that the pages can be first-touched in
+ *        parallel by the threads that will later work on them. The \p Tag only
+ *        distinguishes otherwise identical instantiations (see isa_namespace.hpp).
+*/
+template <typename T, size_t Alignment = CACHE_LINE, typename Tag = void>
+class AlignedAllocator
+{
+    static_assert(Alignment >= alignof(T), "Alignment must be at least the alignment of the type");
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef AlignedAllocator<U, Alignment, Tag> other;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template <typename U>
+        AlignedAllocator(AlignedAllocator<U, Alignment, Tag> const &) noexcept
+        {
+        }
+
+        /**\fn     allocate
+         * \brief  Allocate aligned memory for \p n elements
+         *
+         * \param[in] n   number of elements
+         * \return Pointer to the uninitialised memory
+        */
+        T* allocate(size_t const n)
+        {
+            if (n > static_cast<size_t>(-1)/sizeof(T) - Alignment)
+            {
+                throw std::bad_alloc();
+            }
+            size_t const bytes = RoundUp(n*sizeof(T), Alignment);
+
+            #ifdef __linux__
+            if (bytes >= HUGE_PAGE)
+            {
+                return static_cast<T*>(MapLarge(RoundUp(bytes, HUGE_PAGE)));
+            }
+            #endif
+
+            void* const ptr = std::aligned_alloc(Alignment, (bytes > 0) ? bytes : Alignment);
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(ptr);
+        }
+
+        /**\fn     construct
+         * \brief  Default-initialise an element, leaving arithmetic types untouched
+        */
+        template <typename U>
+        void construct(U* const ptr) noexcept(std::is_nothrow_default_constructible<U>::value)
+        {
+            ::new (static_cast<void*>(ptr)) U;
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* const ptr, Args&&... args)
+        {
+            ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+        }
+
+        /**\fn     deallocate
+         * \brief  Free the memory of \p n elements allocated by allocate
+         *
+         * \param[in] ptr   pointer returned by allocate
+         * \param[in] n     number of elements passed to allocate
+        */
+        void deallocate(T* const ptr, size_t const n) noexcept
+        {
+            size_t const bytes = RoundUp(n*sizeof(T), Alignment);
+
+            #ifdef __linux__
+            if (bytes >= HUGE_PAGE)
+            {
+                munmap(ptr, RoundUp(bytes, HUGE_PAGE));
+                return;
+            }
+            #endif
+
+            std::free(ptr);
+        }
+
+    private:
+        static constexpr size_t RoundUp(size_t const bytes, size_t const multiple)
+        {
+            return (bytes + multiple - 1)/multiple*multiple;
+        }
+
+        #ifdef __linux__
+        /**\fn     MapLarge
+         * \brief  Map \p bytes (a multiple of HUGE_PAGE) of anonymous memory according to
+         *         the huge page policy. Mappings are always page aligned.
+        */
+        static void* MapLarge(size_t const bytes)
+        {
+            void* ptr = MAP_FAILED;
+
+            #ifdef MAP_HUGETLB
+            if (huge_pages() == HugePages::hugetlb)
+            {
+                ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            }
+            #endif
+
+            if (ptr == MAP_FAILED)
+            {
+                ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (ptr == MAP_FAILED)
+                {
+                    throw std::bad_alloc();
+                }
+
+                #ifdef MADV_HUGEPAGE
+                if (huge_pages() != HugePages::none)
+                {
+                    madvise(ptr, bytes, MADV_HUGEPAGE);
+                }
+                #endif
+                #ifdef MADV_NOHUGEPAGE
+                if (huge_pages() == HugePages::none)
+                {
+                    madvise(ptr, bytes, MADV_NOHUGEPAGE);
+                }
+                #endif
+            }
+
+            // must happen before the first touch
+            apply_numa_placement(ptr, bytes, numa_placement());
+
+            return ptr;
+        }
+        #endif
+};
+
+template <typename T, typename U, size_t A, typename Tag>
+bool operator==(AlignedAllocator<T,A,Tag> const &, AlignedAllocator<U,A,Tag> const &) noexcept
+{
+    return true;
+}
+
+template <typename T, typename U, size_t A, typename Tag>
+bool operator!=(AlignedAllocator<T,A,Tag> const &, AlignedAllocator<U,A,Tag> const &) noexcept
+{
+    return false;
+}
+
+
+/// cache-aligned vector (independent of whether Boost is available)
+#define VEC(T) std::vector<T, AlignedAllocator<T, CACHE_LINE>>
+
+
+/**\class AlignedBuffer
+ * \brief Cache-aligned buffer of \p length elements whose tail is padded with zeros to a
+ *        full cache line (which corresponds to an entire AVX512 register), so that it can
+ *        be passed to all span kernels without copying. The elements are initialised in
+ *        parallel with the same static partition as the OpenMP kernels so that every page
+ *        is first touched by the thread that later reads it.
+*/
+template <typename T = double>
+class AlignedBuffer
+{
+    private:
+        size_t _length = 0;  ///< number of elements without padding
+        VEC(T) _data;        ///< elements including the zero padding
+
+    public:
+        typedef T value_type;
+
+        AlignedBuffer() = default;
+
+        /**\fn        AlignedBuffer
+         * \brief     Allocate a buffer of \p length elements initialised to \p value
+         *
+         * \param[in] length   number of elements (without padding)
+         * \param[in] value    initial value of the elements
+        */
+        explicit AlignedBuffer(size_t const length, T const value = static_cast<T>(0))
+            : _length(length), _data(length + PAD(length, T))
+        {
+            T* const     data   = _data.data();
+            size_t const padded = _data.size();
+
+            #pragma omp parallel for simd schedule(static)
+            for (size_t i = 0; i < padded; ++i)
+            {
+                data[i] = (i < length) ? value : static_cast<T>(0);
+            }
+        }
+
+        /**\fn        AlignedBuffer
+         * \brief     Allocate a buffer holding a copy of the elements of \p values
+         *
+         * \param[in] values   contiguous container with the elements
+        */
+        template <typename C, typename = decltype(std::declval<C const&>().data())>
+        explicit AlignedBuffer(C const &values)
+            : _length(values.size()), _data(values.size() + PAD(values.size(), T))
+        {
+            T* const       data   = _data.data();
+            T const* const src    = values.data();
+            size_t const   length = _length;
+            size_t const   padded = _data.size();
+
+            #pragma omp parallel for simd schedule(static)
+            for (size_t i = 0; i < padded; ++i)
+            {
+                data[i] = (i < length) ? src[i] : static_cast<T>(0);
+            }
+        }
+
+        size_t   size()        const { return _length;      }  ///< number of elements without padding
+        size_t   padded_size() const { return _data.size(); }  ///< number of elements including padding
+        T*       data()              { return _data.data(); }
+        T const* data()        const { return _data.data(); }
+        T*       begin()             { return _data.data(); }
+        T const* begin()       const { return _data.data(); }
+        T*       end()               { return _data.data() + _length; }
+        T const* end()         const { return _data.data() + _length; }
+
+        T&       operator[](size_t const i)       { assert(i < _data.size()); return _data[i]; }
+        T const& operator[](size_t const i) const { assert(i < _data.size()); return _data[i]; }
+
+        /**\fn     span
+         * \brief  Span over all elements including the zero padding as required by the
+         *         aligned kernels
+        */
+        std::span<T> span() { return std::span<T>(_data.data(), _data.size()); }
+
+        /**\fn     unpadded
+         * \brief  Span over the elements without padding
+        */
+        std::span<T> unpadded() { return std::span<T>(_data.data(), _length); }
+};
 
 #endif // ALIGN_H_INCLUDED
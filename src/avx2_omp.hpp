@@ -5,12 +5,15 @@
  * \file     avx2_omp.hpp
  * \brief    dot product calculated with AVX2 intrinsics and OpenMP
  * \mainpage Dot product: manual AVX2 implementation by means of double
- *           intrinsics with OpenMP parallel for with propietary reduction
- *           operation and partial loop unrolling so a single core always
- *           works  on its entire cache line. The arrays are assumed to be
+ *           intrinsics with OpenMP parallel for and partial loop unrolling
+ *           so a single core always works on entire cache lines. The
+ *           intrinsics are wrapped in a traits class for the policy-based
+ *           kernel (see simd_kernel.hpp). The arrays are assumed to be
  *           cache aligned and to be padded to be a multiple of the cache
- *           line size.
- * \warning  The arrays must be cache aligned!
+ *           line size. The unaligned variant accepts spans of any length
+ *           and alignment by peeling the head up to the next cache line and
+ *           loading the tail with masks.
+ * \warning  The arrays must be cache aligned (except for the unaligned variant)!
 */
 
 
@@ -29,8 +32,22 @@
 #endif
 
 #include <assert.h>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include "align.hpp"
+#include "batched.hpp"
+#include "simd_kernel.hpp"
+#include "topk.hpp"
+#include "gemm.hpp"
+#include "compensated.hpp"
+#include "complex.hpp"
+#include "compressed.hpp"
+#include "gemv.hpp"
+#include "reproducible.hpp"
+#include "soa.hpp"
+#include "sparse.hpp"
+#include "isa_namespace.hpp"
 
 #ifdef __AVX2__
 
@@ -42,6 +59,10 @@
 #define AVX2_REG_SIZE      sizeof(__m256d)/sizeof(INTR)
 
 
+inline namespace ISA_NAMESPACE
+{
+
+
 /// propietary OpenMP reduction operation for AVX2
 #pragma omp declare reduction \
     (addpd: __m256d: omp_out += omp_in) \
@@ -61,7 +82,383 @@ static inline double _mm256_reduce_add_pd(__m256d _a)
 }
 
 
-/**\fn        avx2_omp_arr
+/**\struct SimdAvx2
+ * \brief  Traits class of the AVX2 instruction set for the policy-based kernel
+*/
+struct SimdAvx2
+{
+    typedef double  value_type;
+    typedef double  y_type;
+    typedef double  result_type;
+    typedef __m256d reg;
+    typedef __m256d acc;
+    static constexpr size_t width          = AVX2_REG_SIZE;
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg    zero()                         { return _mm256_setzero_pd();         }
+    static inline reg    load(double const* p)          { return _mm256_load_pd(p);           }
+    static inline reg    loadu(double const* p)         { return _mm256_loadu_pd(p);          }
+    static inline reg    broadcast(double const v)      { return _mm256_set1_pd(v);           }
+    static inline void   storeu(double* p, reg _a)      { _mm256_storeu_pd(p, _a);            }
+    static inline reg    add(reg _a, reg _b)            { return _mm256_add_pd(_a, _b);       }
+    static inline reg    sub(reg _a, reg _b)            { return _mm256_sub_pd(_a, _b);       }
+    static inline reg    mul(reg _a, reg _b)            { return _mm256_mul_pd(_a, _b);       }
+    static inline reg    fmadd(reg _a, reg _b, reg _c)  { return _mm256_fmadd_pd(_a, _b, _c); }
+    static inline reg    fmsub(reg _a, reg _b, reg _c)  { return _mm256_fmsub_pd(_a, _b, _c); }
+    static inline reg    min(reg _a, reg _b)            { return _mm256_min_pd(_a, _b);       }
+    static inline reg    max(reg _a, reg _b)            { return _mm256_max_pd(_a, _b);       }
+    static inline double reduce(reg _a)                 { return _mm256_reduce_add_pd(_a);    }
+
+    /// load the first n (at most width) elements and set the remaining lanes to zero without accessing them
+    static inline reg load_partial(double const* p, size_t const n)
+    {
+        __m256i const _mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)),
+                                                 _mm256_setr_epi64x(0, 1, 2, 3));
+        return _mm256_maskload_pd(p, _mask);
+    }
+
+    /// gather the elements of base at the width 64 or 32 bit positions idx
+    static inline reg gather(double const* base, int64_t const* idx)
+    {
+        return _mm256_i64gather_pd(base, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx)), sizeof(double));
+    }
+    static inline reg gather(double const* base, int32_t const* idx)
+    {
+        return _mm256_i32gather_pd(base, _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx)), sizeof(double));
+    }
+
+    /// multiply-add the values x and y of equal positions of the width ascending positions a and b
+    /// to _acc: every position of a is broadcast and compared to all of b, its value is moved to
+    /// the lane of the equal position of b (a position occurs at most once in a and b)
+    static inline reg intersect(int64_t const* a, double const* x, int64_t const* b, double const* y, reg _acc)
+    {
+        __m256i const _b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b));
+        __m256d       _x = _mm256_setzero_pd();
+        #pragma GCC unroll 16
+        for (size_t k = 0; k < width; ++k)
+        {
+            __m256i const _equal = _mm256_cmpeq_epi64(_mm256_set1_epi64x(a[k]), _b);
+            _x = _mm256_blendv_pd(_x, _mm256_set1_pd(x[k]), _mm256_castsi256_pd(_equal));
+        }
+        return _mm256_fmadd_pd(_x, _mm256_loadu_pd(y), _acc);
+    }
+
+    /// swap the real and imaginary parts of the two complex numbers (see complex.hpp)
+    static inline reg swap_pairs(reg _a)
+    {
+        return _mm256_permute_pd(_a, 0x5);
+    }
+
+    /// load the two complex numbers at p and p + 2*inc by inserting the second into the upper half
+    static inline reg load_strided(double const* p, std::ptrdiff_t const inc)
+    {
+        return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(p)), _mm_loadu_pd(p + 2*inc), 1);
+    }
+};
+
+
+/**\fn        _mm256_reduce_add_ps
+ * \brief     Horizontal add function of all eight numbers in a 256bit AVX2 float intrinsic
+ *
+ * \param[in] _a   a 256bit AVX2 intrinsic with 8 float numbers
+ * \return    The horizontal added intrinsic as a float number
+*/
+static inline float _mm256_reduce_add_ps(__m256 _a)
+{
+    __m128 _sum = _mm_add_ps(_mm256_castps256_ps128(_a), _mm256_extractf128_ps(_a, 1));
+    _sum = _mm_add_ps(_sum, _mm_movehl_ps(_sum, _sum));
+    _sum = _mm_add_ss(_sum, _mm_movehdup_ps(_sum));
+    return _mm_cvtss_f32(_sum);
+}
+
+
+/**\fn        _mm256_reduce_add_epi64
+ * \brief     Horizontal add function of all four numbers in a 256bit AVX2 64 bit integer intrinsic
+ *
+ * \param[in] _a   a 256bit AVX2 intrinsic with 4 64 bit integers
+ * \return    The horizontal added intrinsic as a 64 bit integer
+*/
+static inline int64_t _mm256_reduce_add_epi64(__m256i _a)
+{
+    __m128i const _sum = _mm_add_epi64(_mm256_castsi256_si128(_a), _mm256_extracti128_si256(_a, 1));
+    return _mm_cvtsi128_si64(_sum) + _mm_extract_epi64(_sum, 1);
+}
+
+
+/**\fn        avx2_add_widened_epi32
+ * \brief     Sign-extend the eight 32 bit integers of \p _v to 64 bit and add them
+ *            pairwise to the four 64 bit integers of \p _sum
+ *
+ * \param[in] _sum   four 64 bit sums
+ * \param[in] _v     eight 32 bit integers
+ * \return    The updated sums
+*/
+static inline __m256i avx2_add_widened_epi32(__m256i _sum, __m256i _v)
+{
+    __m256i const _lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(_v));
+    __m256i const _hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(_v, 1));
+    return _mm256_add_epi64(_sum, _mm256_add_epi64(_lo, _hi));
+}
+
+
+/**\fn        avx2_load_partial_si256
+ * \brief     Load the first \p n (at most a register) integers starting at \p p into a
+ *            256bit register with the remaining lanes set to zero without accessing them
+ *            (AVX2 lacks masked loads of bytes and words)
+ *
+ * \param[in] p   pointer to the first element
+ * \param[in] n   number of elements
+ * \return    The loaded register
+*/
+template <typename P>
+static inline __m256i avx2_load_partial_si256(P const* p, size_t const n)
+{
+    alignas(sizeof(__m256i)) P buffer[sizeof(__m256i)/sizeof(P)] = {};
+    std::copy_n(p, n, buffer);
+    return _mm256_load_si256(reinterpret_cast<__m256i const*>(buffer));
+}
+
+
+/**\struct SimdAvx2Float
+ * \brief  Traits class of the AVX2 instruction set for single precision
+*/
+struct SimdAvx2Float
+{
+    typedef float  value_type;
+    typedef float  y_type;
+    typedef float  result_type;
+    typedef __m256 reg;
+    typedef __m256 acc;
+    static constexpr size_t width          = sizeof(__m256)/sizeof(float);
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg   zero()                         { return _mm256_setzero_ps();         }
+    static inline reg   load(float const* p)           { return _mm256_load_ps(p);           }
+    static inline reg   loadu(float const* p)          { return _mm256_loadu_ps(p);          }
+    static inline reg   broadcast(float const v)       { return _mm256_set1_ps(v);           }
+    static inline void  storeu(float* p, reg _a)       { _mm256_storeu_ps(p, _a);            }
+    static inline reg   add(reg _a, reg _b)            { return _mm256_add_ps(_a, _b);       }
+    static inline reg   fmadd(reg _a, reg _b, reg _c)  { return _mm256_fmadd_ps(_a, _b, _c); }
+    static inline float reduce(reg _a)                 { return _mm256_reduce_add_ps(_a);    }
+
+    static inline reg load_partial(float const* p, size_t const n)
+    {
+        __m256i const _mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)),
+                                                 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        return _mm256_maskload_ps(p, _mask);
+    }
+
+    /// swap the real and imaginary parts of the four complex numbers (see complex.hpp)
+    static inline reg swap_pairs(reg _a)
+    {
+        return _mm256_permute_ps(_a, 0xB1);
+    }
+
+    /// gather the four complex numbers at p, p + 2*inc, ... as 64 bit elements
+    static inline reg load_strided(float const* p, std::ptrdiff_t const inc)
+    {
+        __m256i const _idx = _mm256_setr_epi64x(0, inc, 2*inc, 3*inc);
+        return _mm256_castpd_ps(_mm256_i64gather_pd(reinterpret_cast<double const*>(p), _idx, sizeof(double)));
+    }
+};
+
+
+/**\fn        avx2_add_madd_epi16
+ * \brief     Multiply the sixteen 16 bit integers of \p _a and \p _b, sum adjacent pairs
+ *            of products to 32 bit (vpmaddwd) and add them sign-extended to the four 64 bit
+ *            sums \p _sum. The pair -32768*-32768 + -32768*-32768 = 2^31 wraps around to
+ *            -2^31 whereas all other pairs are greater than -2^31, so the pairs are biased
+ *            by -1 before they are widened and the bias of two pairs per 64 bit lane is
+ *            added back in 64 bit.
+ *
+ * \param[in] _sum   four 64 bit sums
+ * \param[in] _a     sixteen 16 bit integers
+ * \param[in] _b     sixteen 16 bit integers
+ * \return    The updated sums
+*/
+static inline __m256i avx2_add_madd_epi16(__m256i _sum, __m256i _a, __m256i _b)
+{
+    __m256i const _pairs = _mm256_sub_epi32(_mm256_madd_epi16(_a, _b), _mm256_set1_epi32(1));
+    return _mm256_add_epi64(avx2_add_widened_epi32(_sum, _pairs), _mm256_set1_epi64x(2));
+}
+
+
+/**\struct SimdAvx2Int16
+ * \brief  Traits class of the AVX2 instruction set for 16 bit integers: pairs of
+ *         products are summed to 32 bit (vpmaddwd) and immediately widened to 64 bit
+ *         so that the result is exact for any length (see avx2_add_madd_epi16)
+*/
+struct SimdAvx2Int16
+{
+    typedef int16_t value_type;
+    typedef int16_t y_type;
+    typedef int64_t result_type;
+    typedef __m256i reg;
+    typedef __m256i acc;
+    static constexpr size_t width          = sizeof(__m256i)/sizeof(int16_t);
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg     zero()                         { return _mm256_setzero_si256();                                      }
+    static inline reg     load(int16_t const* p)         { return _mm256_load_si256(reinterpret_cast<__m256i const*>(p));     }
+    static inline reg     loadu(int16_t const* p)        { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));    }
+    static inline acc     add(acc _a, acc _b)            { return _mm256_add_epi64(_a, _b);                                    }
+    static inline acc     fmadd(reg _a, reg _b, acc _c)  { return avx2_add_madd_epi16(_c, _a, _b);                             }
+    static inline int64_t reduce(acc _a)                 { return _mm256_reduce_add_epi64(_a);                                 }
+    static inline reg     load_partial(int16_t const* p, size_t const n) { return avx2_load_partial_si256(p, n);               }
+};
+
+
+/**\struct SimdAvx2U8S8
+ * \brief  Traits class of the AVX2 instruction set for unsigned (x) times signed (y)
+ *         8 bit integers: the bytes are widened to 16 bit and multiplied with
+ *         vpmaddwd. At most four products of at most 255*128 in magnitude are added
+ *         per 32 bit lane and update, so the 32 bit accumulators are flushed to 64 bit
+ *         after 8192 updates and the result is exact for any length.
+*/
+struct SimdAvx2U8S8
+{
+    typedef uint8_t value_type;
+    typedef int8_t  y_type;
+    typedef int64_t result_type;
+    typedef __m256i reg;
+    static constexpr size_t width          = sizeof(__m256i)/sizeof(uint8_t);
+    static constexpr size_t flush_interval = 8192;
+
+    /// accumulator consisting of 32 bit sums and the 64 bit sums they are flushed to
+    struct acc
+    {
+        __m256i narrow;
+        __m256i wide;
+    };
+
+    template <typename P>
+    static inline reg     load(P const* p)               { return _mm256_load_si256(reinterpret_cast<__m256i const*>(p));  }
+    template <typename P>
+    static inline reg     loadu(P const* p)              { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+    template <typename P>
+    static inline reg     load_partial(P const* p, size_t const n) { return avx2_load_partial_si256(p, n);                  }
+    static inline acc     zero()                         { return {_mm256_setzero_si256(), _mm256_setzero_si256()}; }
+    static inline acc     add(acc _a, acc _b)            { return {_mm256_add_epi32(_a.narrow, _b.narrow), _mm256_add_epi64(_a.wide, _b.wide)}; }
+    static inline acc     flush(acc _a)                  { return {_mm256_setzero_si256(), avx2_add_widened_epi32(_a.wide, _a.narrow)}; }
+    static inline int64_t reduce(acc _a)                 { return _mm256_reduce_add_epi64(flush(_a).wide); }
+
+    static inline acc fmadd(reg _x, reg _y, acc _c)
+    {
+        __m256i const _lo = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(_x)),
+                                              _mm256_cvtepi8_epi16(_mm256_castsi256_si128(_y)));
+        __m256i const _hi = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(_x, 1)),
+                                              _mm256_cvtepi8_epi16(_mm256_extracti128_si256(_y, 1)));
+        _c.narrow = _mm256_add_epi32(_c.narrow, _mm256_add_epi32(_lo, _hi));
+        return _c;
+    }
+};
+
+
+/**\struct Avx2Codec
+ * \brief  Operations shared by the AVX2 codecs of the compressed formats (see
+ *         compressed.hpp): every codec decodes 4 elements of a block to doubles
+ *         (decode_pd) and 8 elements to floats (decode_ps) inside the registers.
+ *         Half precision requires F16C.
+*/
+struct Avx2Codec
+{
+    typedef SimdAvx2      isa;
+    typedef SimdAvx2Float isa_float;
+
+    static inline __m256d broadcast(double const s)  { return _mm256_set1_pd(s); }
+
+    /// sum of the lower and upper half of a float register converted to double
+    static inline __m256d widen(__m256 _a)
+    {
+        return _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(_a)), _mm256_cvtps_pd(_mm256_extractf128_ps(_a, 1)));
+    }
+};
+
+/**\struct Avx2Fp16Codec
+ * \brief  AVX2 codec of the half precision blocks
+*/
+struct Avx2Fp16Codec: public Avx2Codec
+{
+    typedef BlockFp16 block;
+
+    static inline __m256d decode_pd(block const &b, size_t const k)
+    {
+        return _mm256_cvtps_pd(_mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.h + 4*k))));
+    }
+    static inline __m256 decode_ps(block const &b, size_t const k)
+    {
+        return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b.h + 8*k)));
+    }
+};
+
+/**\struct Avx2Bf16Codec
+ * \brief  AVX2 codec of the brain floating point blocks
+*/
+struct Avx2Bf16Codec: public Avx2Codec
+{
+    typedef BlockBf16 block;
+
+    static inline __m256d decode_pd(block const &b, size_t const k)
+    {
+        __m128i const _h = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.h + 4*k)));
+        return _mm256_cvtps_pd(_mm_castsi128_ps(_mm_slli_epi32(_h, 16)));
+    }
+    static inline __m256 decode_ps(block const &b, size_t const k)
+    {
+        __m256i const _h = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b.h + 8*k)));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(_h, 16));
+    }
+};
+
+/**\struct Avx2Q8Codec
+ * \brief  AVX2 codec of the 8 bit integer blocks
+*/
+struct Avx2Q8Codec: public Avx2Codec
+{
+    typedef BlockQ8 block;
+
+    static inline __m256d decode_pd(block const &b, size_t const k)
+    {
+        return _mm256_cvtepi32_pd(_mm_cvtepi8_epi32(_mm_loadu_si32(b.q + 4*k)));
+    }
+    static inline __m256 decode_ps(block const &b, size_t const k)
+    {
+        return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.q + 8*k))));
+    }
+};
+
+/**\struct Avx2Q4Codec
+ * \brief  AVX2 codec of the 4 bit integer blocks
+*/
+struct Avx2Q4Codec: public Avx2Codec
+{
+    typedef BlockQ4 block;
+
+    /// the first and second half of the block are held by the lower and upper nibbles
+    static inline __m256d decode_pd(block const &b, size_t const k)
+    {
+        size_t const  first  = 4*k;
+        __m128i const _bytes = _mm_cvtepu8_epi32(_mm_loadu_si32(b.q + first % (QUANT_BLOCK/2)));
+        __m128i const _q     = _mm_and_si128(_mm_srli_epi32(_bytes, static_cast<int>(4*(first/(QUANT_BLOCK/2)))), _mm_set1_epi32(0x0F));
+        return _mm256_cvtepi32_pd(_mm_sub_epi32(_q, _mm_set1_epi32(8)));
+    }
+    static inline __m256 decode_ps(block const &b, size_t const k)
+    {
+        size_t const  first  = 8*k;
+        __m256i const _bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.q + first % (QUANT_BLOCK/2))));
+        __m256i const _q     = _mm256_and_si256(_mm256_srli_epi32(_bytes, static_cast<int>(4*(first/(QUANT_BLOCK/2)))), _mm256_set1_epi32(0x0F));
+        return _mm256_cvtepi32_ps(_mm256_sub_epi32(_q, _mm256_set1_epi32(8)));
+    }
+};
+
+
+/// unroll factor, number of accumulators and prefetch distance of the AVX2 kernels (see --tune)
+#define AVX2_UNROLL        8
+#define AVX2_ACCUMULATORS  4
+#define AVX2_PREFETCH      0
+
+
+/**\fn        avx2_omp_span
  * \brief     Calculate dot product of two vectors \p x and \p y using 256bit
  *            AVX2 double intrinsics (4 double numbers, half a cache line),
  *            container: C++ span
@@ -71,27 +468,318 @@ static inline double _mm256_reduce_add_pd(__m256d _a)
  * \return    Dot product of the two vectors
 */
 inline double avx2_omp_span(std::span<double> const &x, std::span<double> const &y)
+{
+    assert(x.size() % (2*AVX2_REG_SIZE) == 0);
+    return simd_omp_span<SimdAvx2, AVX2_UNROLL, AVX2_ACCUMULATORS, AVX2_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx2_omp_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment using 256bit AVX2 double intrinsics: the head is peeled up to
+ *            the next cache line boundary of \p x, the main loop works on entire cache
+ *            lines of \p x and the tail is loaded with masks, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx2_omp_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    return simd_omp_unaligned<SimdAvx2, AVX2_UNROLL, AVX2_ACCUMULATORS, AVX2_PREFETCH>(x, y);
+}
+
+/**\fn        avx2_omp_dot2
+ * \brief     Calculate dot product of two vectors \p x and \p y in about twice the
+ *            working precision (Dot2, see compensated.hpp) using AVX2 double
+ *            intrinsics, container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx2_omp_dot2(std::span<double> const &x, std::span<double> const &y)
 {
     assert(x.size() == y.size());
-    size_t const N = x.size();
+    return simd_omp_dot2<SimdAvx2, AVX2_ACCUMULATORS, true>(x.data(), y.data(), x.size());
+}
 
-    // divide cache line into two variables handled by the same processor
-    __m256d _res1 = _mm256_setzero_pd();
-    __m256d _res2 = _mm256_setzero_pd();
 
-    #pragma omp parallel for shared(x, y) reduction(addpd: _res1) reduction(addpd: _res2)
-    for (size_t i = 0; i < N-AVX2_REG_SIZE; i += 2*AVX2_REG_SIZE)
-    {
-        // use partial loop unrolling in order to cover entire cache line
-        _res1 = _mm256_fmadd_pd(_mm256_load_pd(&x[i]),               _mm256_load_pd(&y[i]),               _res1);
-        _res2 = _mm256_fmadd_pd(_mm256_load_pd(&x[i+AVX2_REG_SIZE]), _mm256_load_pd(&y[i+AVX2_REG_SIZE]), _res2);
-    }
+/**\fn        avx2_omp_dot2_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment in about twice the working precision (Dot2, see compensated.hpp)
+ *            using AVX2 double intrinsics, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx2_omp_dot2_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_dot2<SimdAvx2, AVX2_ACCUMULATORS, false>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn        avx2_omp_reproducible
+ * \brief     Calculate dot product of two aligned and padded vectors \p x and \p y
+ *            bitwise independent of the number of threads (see reproducible.hpp) using
+ *            AVX2 double intrinsics, container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx2_omp_reproducible(std::span<double> const &x, std::span<double> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_reproducible<SimdAvx2, AVX2_ACCUMULATORS, true>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn        avx2_omp_reproducible_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment bitwise independent of the number of threads (see
+ *            reproducible.hpp) using AVX2 double intrinsics, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx2_omp_reproducible_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_reproducible<SimdAvx2, AVX2_ACCUMULATORS, false>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn         avx2_omp_batch
+ * \brief      Calculate the dot products of all \p pairs of a batch in a single parallel
+ *             region (see batched.hpp) using AVX2 double intrinsics
+ *
+ * \param[in]  pairs     the pairs of the batch
+ * \param[out] results   the dot products of the pairs
+*/
+inline void avx2_omp_batch(std::span<DotPair const> const &pairs, std::span<double> const &results)
+{
+    simd_omp_batch<SimdAvx2, AVX2_ACCUMULATORS>(pairs, results);
+}
+
+
+/// number of rows of a row-major and columns of a column-major matrix that are register-blocked
+#define AVX2_GEMV_ROWS    4
+#define AVX2_GEMV_COLUMNS 4
+
+
+/**\fn         avx2_omp_gemv
+ * \brief      Calculate the dot products r_j = y_j·x of \p x with all rows y_j of the
+ *             matrix \p a stored in \p layout (see gemv.hpp) using AVX2 double
+ *             intrinsics
+ *
+ * \param[in]  a        the matrix of r.size() rows and x.size() columns
+ * \param[in]  layout   storage order of the matrix
+ * \param[in]  x        the shared operand
+ * \param[out] r        the dot products of all rows
+*/
+inline void avx2_omp_gemv(std::span<double const> const &a, Layout const layout,
+                         std::span<double const> const &x, std::span<double> const &r)
+{
+    simd_omp_gemv<SimdAvx2, AVX2_GEMV_ROWS, AVX2_GEMV_COLUMNS>(a, layout, x, r);
+}
+
+
+/**\fn         avx2_omp_topk
+ * \brief      Search the \p k vectors of the \p collection with the largest dot product
+ *             with \p query (see topk.hpp) using AVX2 double intrinsics
+ *
+ * \param[in]  collection   the blocked collection
+ * \param[in]  query        the query of collection.dim elements
+ * \param[in]  k            number of wished results
+ * \param[out] hits         the (at most) k best vectors in the order of decreasing dot products
+ * \return     Number of blocks that were skipped
+*/
+inline size_t avx2_omp_topk(BlockedCollection const &collection, std::span<double const> const &query,
+                           size_t const k, std::vector<ScoredIndex> &hits)
+{
+    return simd_omp_topk<SimdAvx2>(collection, query, k, hits);
+}
+
+
+/// number of rows of the register tile of the matrix product (the tile has two registers per row)
+#define AVX2_GEMM_ROWS 6
+
+
+/**\fn         avx2_omp_dgemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) blocked for the cache hierarchy (see gemm.hpp) using
+ *             AVX2 double intrinsics
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+inline void avx2_omp_dgemm(std::span<double const> const &a, std::span<double const> const &b,
+                          std::span<double> const &c, size_t const m, size_t const n, size_t const k)
+{
+    simd_omp_gemm<SimdAvx2, AVX2_GEMM_ROWS>(a, b, c, m, n, k);
+}
+
+
+/**\fn         avx2_omp_sgemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) blocked for the cache hierarchy (see gemm.hpp) using
+ *             AVX2 single precision intrinsics
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+inline void avx2_omp_sgemm(std::span<float const> const &a, std::span<float const> const &b,
+                          std::span<float> const &c, size_t const m, size_t const n, size_t const k)
+{
+    simd_omp_gemm<SimdAvx2Float, AVX2_GEMM_ROWS>(a, b, c, m, n, k);
+}
+
+
+/**\fn         avx2_omp_peak
+ * \brief      Measure the attainable peak performance of AVX2 double fused
+ *             multiply-adds of all threads (see gemm.hpp)
+ *
+ * \param[in]  iterations   number of fused multiply-adds per chain
+ * \param[out] flops        number of floating point operations that were performed
+ * \return     Checksum of the chains
+*/
+inline double avx2_omp_peak(size_t const iterations, double &flops)
+{
+    return simd_omp_peak<SimdAvx2>(iterations, flops);
+}
+
+
+/**\fn         avx2_omp_peak_float
+ * \brief      Measure the attainable peak performance of AVX2 single precision fused
+ *             multiply-adds of all threads (see gemm.hpp)
+ *
+ * \param[in]  iterations   number of fused multiply-adds per chain
+ * \param[out] flops        number of floating point operations that were performed
+ * \return     Checksum of the chains
+*/
+inline double avx2_omp_peak_float(size_t const iterations, double &flops)
+{
+    return simd_omp_peak<SimdAvx2Float>(iterations, flops);
+}
+
+
+/**\fn         avx2_omp_soa
+ * \brief      Calculate the dot products r_j = x_j·y_j of all pairs of vectors of Dim
+ *             elements stored as structure of arrays (see soa.hpp) using AVX2 double
+ *             intrinsics across the pairs
+ *
+ * \param[in]  x   the first vectors of the pairs
+ * \param[in]  y   the second vectors of the pairs
+ * \param[out] r   the dot products of the pairs
+*/
+template <size_t Dim>
+inline void avx2_omp_soa(SoaVectors const &x, SoaVectors const &y, std::span<double> const &r)
+{
+    simd_omp_soa<SimdAvx2, Dim>(x, y, r);
+}
+
+
+/**\fn        avx2_omp_sparse
+ * \brief     Calculate dot product of the sparse vector \p x and the dense vector \p y
+ *            (see sparse.hpp) using AVX2 double intrinsics and gathers with 64 or 32
+ *            bit positions
+ *
+ * \param[in] x   the sparse vector
+ * \param[in] y   the dense vector
+ * \return    Dot product of the two vectors
+*/
+template <typename Index>
+inline double avx2_omp_sparse(SparseVector<Index> const &x, std::span<double const> const &y)
+{
+    return simd_omp_sparse<SimdAvx2, SPARSE_UNROLL>(x, y);
+}
+
+
+/**\fn        avx2_omp_sparse_sparse
+ * \brief     Calculate dot product of the sparse vectors \p x and \p y (see sparse.hpp)
+ *            by intersecting registers of 64 bit positions with AVX2 intrinsics
+ *
+ * \param[in] x   the first sparse vector
+ * \param[in] y   the second sparse vector
+ * \return    Dot product of the two vectors
+*/
+inline double avx2_omp_sparse_sparse(SparseVector<int64_t> const &x, SparseVector<int64_t> const &y)
+{
+    return simd_omp_sparse_sparse<SimdAvx2>(x, y);
+}
+
+
+/**\fn        avx2_omp_span_float
+ * \brief     Calculate dot product of two vectors \p x and \p y using 256bit AVX2
+ *            single precision intrinsics (8 float numbers, half a cache line),
+ *            container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline float avx2_omp_span_float(std::span<float> const &x, std::span<float> const &y)
+{
+    return simd_omp_span<SimdAvx2Float, AVX2_UNROLL, AVX2_ACCUMULATORS, AVX2_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx2_omp_unaligned_float
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment using 256bit AVX2 single precision intrinsics, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline float avx2_omp_unaligned_float(std::span<float const> const &x, std::span<float const> const &y)
+{
+    return simd_omp_unaligned<SimdAvx2Float, AVX2_UNROLL, AVX2_ACCUMULATORS, AVX2_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx2_omp_span_int16
+ * \brief     Calculate the exact dot product of two vectors \p x and \p y of 16 bit
+ *            integers using AVX2 (vpmaddwd, 16 numbers per register), container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t avx2_omp_span_int16(std::span<int16_t> const &x, std::span<int16_t> const &y)
+{
+    return simd_omp_span<SimdAvx2Int16, AVX2_UNROLL, AVX2_ACCUMULATORS, AVX2_PREFETCH>(x, y);
+}
+
 
-    // reduce all intrinsics to single double
-    __m256d _res = _mm256_add_pd(_res1, _res2);
-    return _mm256_reduce_add_pd(_res);
+/**\fn        avx2_omp_span_u8s8
+ * \brief     Calculate the exact dot product of a vector \p x of unsigned and a vector
+ *            \p y of signed 8 bit integers using AVX2 (widening and vpmaddwd, 32 numbers
+ *            per register), container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t avx2_omp_span_u8s8(std::span<uint8_t> const &x, std::span<int8_t> const &y)
+{
+    return simd_omp_span<SimdAvx2U8S8, AVX2_UNROLL, AVX2_ACCUMULATORS, AVX2_PREFETCH>(x, y);
 }
 
+} // namespace ISA_NAMESPACE
+
 #endif //__AVX2__
 
 #endif // AVX2_OMP_H_INCLUDED
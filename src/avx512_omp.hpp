@@ -5,10 +5,13 @@
  * \file     avx512_omp.hpp
  * \brief    dot product calculated with AVX512 intrinsics and OpenMP
  * \mainpage Dot product: manual AVX512 implementation by means of double
- *           intrinsics with OpenMP parallel for with propietary reduction
- *           operation. The arrays are assumed to be cache aligned and to
- *           be padded to be a multiple of the cache line size.
- * \warning  The arrays must be cache aligned!
+ *           intrinsics with OpenMP parallel for. The intrinsics are wrapped
+ *           in a traits class for the policy-based kernel (see
+ *           simd_kernel.hpp). The arrays are assumed to be cache aligned and
+ *           to be padded to be a multiple of the cache line size. The unaligned
+ *           variant accepts spans of any length and alignment by peeling the
+ *           head up to the next cache line and loading the tail with masks.
+ * \warning  The arrays must be cache aligned (except for the unaligned variant)!
 */
 
 
@@ -27,8 +30,22 @@
 #endif
 
 #include <assert.h>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include "align.hpp"
+#include "batched.hpp"
+#include "simd_kernel.hpp"
+#include "topk.hpp"
+#include "gemm.hpp"
+#include "compensated.hpp"
+#include "complex.hpp"
+#include "compressed.hpp"
+#include "gemv.hpp"
+#include "reproducible.hpp"
+#include "soa.hpp"
+#include "sparse.hpp"
+#include "isa_namespace.hpp"
 
 
 #ifdef __AVX512CD__
@@ -45,6 +62,10 @@
 #define AVX512_REG_SIZE      sizeof(__m512d)/sizeof(INTR)
 
 
+inline namespace ISA_NAMESPACE
+{
+
+
 /// propietary OpenMP reduction operation for AVX512
 #pragma omp declare reduction \
     (addpd: __m512d: omp_out += omp_in) \
@@ -68,6 +89,345 @@
 // #endif
 
 
+/**\struct SimdAvx512
+ * \brief  Traits class of the AVX512 instruction set for the policy-based kernel
+*/
+struct SimdAvx512
+{
+    typedef double  value_type;
+    typedef double  y_type;
+    typedef double  result_type;
+    typedef __m512d reg;
+    typedef __m512d acc;
+    static constexpr size_t width          = AVX512_REG_SIZE;
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg    zero()                         { return _mm512_setzero_pd();         }
+    static inline reg    load(double const* p)          { return _mm512_load_pd(p);           }
+    static inline reg    loadu(double const* p)         { return _mm512_loadu_pd(p);          }
+    static inline reg    broadcast(double const v)      { return _mm512_set1_pd(v);           }
+    static inline void   storeu(double* p, reg _a)      { _mm512_storeu_pd(p, _a);            }
+    static inline reg    add(reg _a, reg _b)            { return _mm512_add_pd(_a, _b);       }
+    static inline reg    sub(reg _a, reg _b)            { return _mm512_sub_pd(_a, _b);       }
+    static inline reg    mul(reg _a, reg _b)            { return _mm512_mul_pd(_a, _b);       }
+    static inline reg    fmadd(reg _a, reg _b, reg _c)  { return _mm512_fmadd_pd(_a, _b, _c); }
+    static inline reg    fmsub(reg _a, reg _b, reg _c)  { return _mm512_fmsub_pd(_a, _b, _c); }
+    static inline reg    min(reg _a, reg _b)            { return _mm512_min_pd(_a, _b);       }
+    static inline reg    max(reg _a, reg _b)            { return _mm512_max_pd(_a, _b);       }
+    static inline double reduce(reg _a)                 { return _mm512_reduce_add_pd(_a);    }
+
+    /// load the first n (at most width) elements and set the remaining lanes to zero without accessing them
+    static inline reg load_partial(double const* p, size_t const n)
+    {
+        return _mm512_maskz_loadu_pd(static_cast<__mmask8>((1u << n) - 1u), p);
+    }
+
+    /// gather the elements of base at the width 64 or 32 bit positions idx
+    static inline reg gather(double const* base, int64_t const* idx)
+    {
+        return _mm512_i64gather_pd(_mm512_loadu_si512(idx), base, sizeof(double));
+    }
+    static inline reg gather(double const* base, int32_t const* idx)
+    {
+        return _mm512_i32gather_pd(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx)), base, sizeof(double));
+    }
+
+    /// multiply-add the values x and y of equal positions of the width ascending positions a and b
+    /// to _acc: every position of a is broadcast and compared to all of b, its value is moved to
+    /// the lane of the equal position of b (a position occurs at most once in a and b)
+    static inline reg intersect(int64_t const* a, double const* x, int64_t const* b, double const* y, reg _acc)
+    {
+        __m512i const _b = _mm512_loadu_si512(b);
+        __m512d       _x = _mm512_setzero_pd();
+        #pragma GCC unroll 16
+        for (size_t k = 0; k < width; ++k)
+        {
+            __mmask8 const equal = _mm512_cmpeq_epi64_mask(_mm512_set1_epi64(a[k]), _b);
+            _x = _mm512_mask_mov_pd(_x, equal, _mm512_set1_pd(x[k]));
+        }
+        return _mm512_fmadd_pd(_x, _mm512_loadu_pd(y), _acc);
+    }
+
+    /// swap the real and imaginary parts of the four complex numbers (see complex.hpp)
+    static inline reg swap_pairs(reg _a)
+    {
+        return _mm512_permute_pd(_a, 0x55);
+    }
+
+    /// gather the four complex numbers at p, p + 2*inc, ... (real and imaginary parts separately)
+    static inline reg load_strided(double const* p, std::ptrdiff_t const inc)
+    {
+        __m512i const _idx = _mm512_setr_epi64(0, 1, 2*inc, 2*inc + 1, 4*inc, 4*inc + 1, 6*inc, 6*inc + 1);
+        return _mm512_i64gather_pd(_idx, p, sizeof(double));
+    }
+};
+
+
+/**\struct SimdAvx512Float
+ * \brief  Traits class of the AVX512 instruction set for single precision
+*/
+struct SimdAvx512Float
+{
+    typedef float  value_type;
+    typedef float  y_type;
+    typedef float  result_type;
+    typedef __m512 reg;
+    typedef __m512 acc;
+    static constexpr size_t width          = sizeof(__m512)/sizeof(float);
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg   zero()                         { return _mm512_setzero_ps();         }
+    static inline reg   load(float const* p)           { return _mm512_load_ps(p);           }
+    static inline reg   loadu(float const* p)          { return _mm512_loadu_ps(p);          }
+    static inline reg   broadcast(float const v)       { return _mm512_set1_ps(v);           }
+    static inline void  storeu(float* p, reg _a)       { _mm512_storeu_ps(p, _a);            }
+    static inline reg   add(reg _a, reg _b)            { return _mm512_add_ps(_a, _b);       }
+    static inline reg   fmadd(reg _a, reg _b, reg _c)  { return _mm512_fmadd_ps(_a, _b, _c); }
+    static inline float reduce(reg _a)                 { return _mm512_reduce_add_ps(_a);    }
+
+    static inline reg load_partial(float const* p, size_t const n)
+    {
+        return _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << n) - 1u), p);
+    }
+
+    /// swap the real and imaginary parts of the eight complex numbers (see complex.hpp)
+    static inline reg swap_pairs(reg _a)
+    {
+        return _mm512_permute_ps(_a, 0xB1);
+    }
+
+    /// gather the eight complex numbers at p, p + 2*inc, ... as 64 bit elements
+    static inline reg load_strided(float const* p, std::ptrdiff_t const inc)
+    {
+        __m512i const _idx = _mm512_setr_epi64(0, inc, 2*inc, 3*inc, 4*inc, 5*inc, 6*inc, 7*inc);
+        return _mm512_castpd_ps(_mm512_i64gather_pd(_idx, reinterpret_cast<double const*>(p), sizeof(double)));
+    }
+};
+
+
+/**\fn        avx512_add_widened_epi32
+ * \brief     Sign-extend the sixteen 32 bit integers of \p _v to 64 bit and add them
+ *            pairwise to the eight 64 bit integers of \p _sum
+ *
+ * \param[in] _sum   eight 64 bit sums
+ * \param[in] _v     sixteen 32 bit integers
+ * \return    The updated sums
+*/
+static inline __m512i avx512_add_widened_epi32(__m512i _sum, __m512i _v)
+{
+    __m512i const _even = _mm512_srai_epi64(_mm512_slli_epi64(_v, 32), 32);
+    __m512i const _odd  = _mm512_srai_epi64(_v, 32);
+    return _mm512_add_epi64(_sum, _mm512_add_epi64(_even, _odd));
+}
+
+
+/**\fn        avx512_add_madd_epi16
+ * \brief     Multiply the thirty-two 16 bit integers of \p _a and \p _b, sum adjacent pairs
+ *            of products to 32 bit (vpmaddwd) and add them sign-extended to the eight 64 bit
+ *            sums \p _sum. The pair -32768*-32768 + -32768*-32768 = 2^31 wraps around to
+ *            -2^31 whereas all other pairs are greater than -2^31, so the pairs are biased
+ *            by -1 before they are widened and the bias of two pairs per 64 bit lane is
+ *            added back in 64 bit.
+ *
+ * \param[in] _sum   eight 64 bit sums
+ * \param[in] _a     thirty-two 16 bit integers
+ * \param[in] _b     thirty-two 16 bit integers
+ * \return    The updated sums
+*/
+static inline __m512i avx512_add_madd_epi16(__m512i _sum, __m512i _a, __m512i _b)
+{
+    __m512i const _pairs = _mm512_sub_epi32(_mm512_madd_epi16(_a, _b), _mm512_set1_epi32(1));
+    return _mm512_add_epi64(avx512_add_widened_epi32(_sum, _pairs), _mm512_set1_epi64(2));
+}
+
+
+/**\struct SimdAvx512Int16
+ * \brief  Traits class of the AVX512 instruction set for 16 bit integers: pairs of
+ *         products are summed to 32 bit (vpmaddwd) and immediately widened to 64 bit
+ *         so that the result is exact for any length (see avx512_add_madd_epi16)
+*/
+struct SimdAvx512Int16
+{
+    typedef int16_t value_type;
+    typedef int16_t y_type;
+    typedef int64_t result_type;
+    typedef __m512i reg;
+    typedef __m512i acc;
+    static constexpr size_t width          = sizeof(__m512i)/sizeof(int16_t);
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg     zero()                         { return _mm512_setzero_si512();      }
+    static inline reg     load(int16_t const* p)         { return _mm512_load_si512(p);        }
+    static inline reg     loadu(int16_t const* p)        { return _mm512_loadu_si512(p);       }
+    static inline acc     add(acc _a, acc _b)            { return _mm512_add_epi64(_a, _b);    }
+    static inline int64_t reduce(acc _a)                 { return _mm512_reduce_add_epi64(_a); }
+
+    static inline acc fmadd(reg _a, reg _b, acc _c)
+    {
+        return avx512_add_madd_epi16(_c, _a, _b);
+    }
+
+    static inline reg load_partial(int16_t const* p, size_t const n)
+    {
+        return _mm512_maskz_loadu_epi16(static_cast<__mmask32>((1ull << n) - 1ull), p);
+    }
+};
+
+
+/**\struct SimdAvx512U8S8
+ * \brief  Traits class of the AVX512 BW instruction set for unsigned (x) times signed
+ *         (y) 8 bit integers: the bytes are widened to 16 bit and multiplied with
+ *         vpmaddwd. At most four products of at most 255*128 in magnitude are added
+ *         per 32 bit lane and update, so the 32 bit accumulators are flushed to 64 bit
+ *         after 8192 updates and the result is exact for any length.
+*/
+struct SimdAvx512U8S8
+{
+    typedef uint8_t value_type;
+    typedef int8_t  y_type;
+    typedef int64_t result_type;
+    typedef __m512i reg;
+    static constexpr size_t width          = sizeof(__m512i)/sizeof(uint8_t);
+    static constexpr size_t flush_interval = 8192;
+
+    /// accumulator consisting of 32 bit sums and the 64 bit sums they are flushed to
+    struct acc
+    {
+        __m512i narrow;
+        __m512i wide;
+    };
+
+    template <typename P>
+    static inline reg     load(P const* p)               { return _mm512_load_si512(p);  }
+    template <typename P>
+    static inline reg     loadu(P const* p)              { return _mm512_loadu_si512(p); }
+    static inline acc     zero()                         { return {_mm512_setzero_si512(), _mm512_setzero_si512()}; }
+    static inline acc     add(acc _a, acc _b)            { return {_mm512_add_epi32(_a.narrow, _b.narrow), _mm512_add_epi64(_a.wide, _b.wide)}; }
+    static inline acc     flush(acc _a)                  { return {_mm512_setzero_si512(), avx512_add_widened_epi32(_a.wide, _a.narrow)}; }
+    static inline int64_t reduce(acc _a)                 { return _mm512_reduce_add_epi64(flush(_a).wide); }
+
+    static inline acc fmadd(reg _x, reg _y, acc _c)
+    {
+        __m512i const _lo = _mm512_madd_epi16(_mm512_cvtepu8_epi16(_mm512_castsi512_si256(_x)),
+                                              _mm512_cvtepi8_epi16(_mm512_castsi512_si256(_y)));
+        __m512i const _hi = _mm512_madd_epi16(_mm512_cvtepu8_epi16(_mm512_extracti64x4_epi64(_x, 1)),
+                                              _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(_y, 1)));
+        _c.narrow = _mm512_add_epi32(_c.narrow, _mm512_add_epi32(_lo, _hi));
+        return _c;
+    }
+
+    template <typename P>
+    static inline reg load_partial(P const* p, size_t const n)
+    {
+        return _mm512_maskz_loadu_epi8((n < 64) ? ((1ull << n) - 1ull) : ~0ull, p);
+    }
+};
+
+
+/**\struct Avx512Codec
+ * \brief  Operations shared by the AVX512 codecs of the compressed formats (see
+ *         compressed.hpp): every codec decodes 8 elements of a block to doubles
+ *         (decode_pd) and 16 elements to floats (decode_ps) inside the registers
+*/
+struct Avx512Codec
+{
+    typedef SimdAvx512      isa;
+    typedef SimdAvx512Float isa_float;
+
+    static inline __m512d broadcast(double const s)  { return _mm512_set1_pd(s); }
+
+    /// sum of the lower and upper half of a float register converted to double
+    static inline __m512d widen(__m512 _a)
+    {
+        return _mm512_add_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(_a)),
+                             _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(_a), 1))));
+    }
+};
+
+/**\struct Avx512Fp16Codec
+ * \brief  AVX512 codec of the half precision blocks
+*/
+struct Avx512Fp16Codec: public Avx512Codec
+{
+    typedef BlockFp16 block;
+
+    static inline __m512d decode_pd(block const &b, size_t const k)
+    {
+        return _mm512_cvtps_pd(_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b.h + 8*k))));
+    }
+    static inline __m512 decode_ps(block const &b, size_t const k)
+    {
+        return _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b.h + 16*k)));
+    }
+};
+
+/**\struct Avx512Bf16Codec
+ * \brief  AVX512 codec of the brain floating point blocks
+*/
+struct Avx512Bf16Codec: public Avx512Codec
+{
+    typedef BlockBf16 block;
+
+    static inline __m512d decode_pd(block const &b, size_t const k)
+    {
+        __m256i const _h = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b.h + 8*k)));
+        return _mm512_cvtps_pd(_mm256_castsi256_ps(_mm256_slli_epi32(_h, 16)));
+    }
+    static inline __m512 decode_ps(block const &b, size_t const k)
+    {
+        __m512i const _h = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(b.h + 16*k)));
+        return _mm512_castsi512_ps(_mm512_slli_epi32(_h, 16));
+    }
+};
+
+/**\struct Avx512Q8Codec
+ * \brief  AVX512 codec of the 8 bit integer blocks
+*/
+struct Avx512Q8Codec: public Avx512Codec
+{
+    typedef BlockQ8 block;
+
+    static inline __m512d decode_pd(block const &b, size_t const k)
+    {
+        return _mm512_cvtepi32_pd(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.q + 8*k))));
+    }
+    static inline __m512 decode_ps(block const &b, size_t const k)
+    {
+        return _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b.q + 16*k))));
+    }
+};
+
+/**\struct Avx512Q4Codec
+ * \brief  AVX512 codec of the 4 bit integer blocks
+*/
+struct Avx512Q4Codec: public Avx512Codec
+{
+    typedef BlockQ4 block;
+
+    /// the first and second half of the block are held by the lower and upper nibbles
+    static inline __m512d decode_pd(block const &b, size_t const k)
+    {
+        size_t const  first  = 8*k;
+        __m256i const _bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(b.q + first % (QUANT_BLOCK/2))));
+        __m256i const _q     = _mm256_and_si256(_mm256_srli_epi32(_bytes, static_cast<int>(4*(first/(QUANT_BLOCK/2)))), _mm256_set1_epi32(0x0F));
+        return _mm512_cvtepi32_pd(_mm256_sub_epi32(_q, _mm256_set1_epi32(8)));
+    }
+    static inline __m512 decode_ps(block const &b, size_t const k)
+    {
+        size_t const  first  = 16*k;
+        __m512i const _bytes = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(b.q + first % (QUANT_BLOCK/2))));
+        __m512i const _q     = _mm512_and_si512(_mm512_srli_epi32(_bytes, static_cast<unsigned int>(4*(first/(QUANT_BLOCK/2)))), _mm512_set1_epi32(0x0F));
+        return _mm512_cvtepi32_ps(_mm512_sub_epi32(_q, _mm512_set1_epi32(8)));
+    }
+};
+
+
+/// unroll factor, number of accumulators and prefetch distance of the AVX512 kernels (see --tune)
+#define AVX512_UNROLL        8
+#define AVX512_ACCUMULATORS  4
+#define AVX512_PREFETCH      0
+
+
 /**\fn        avx512_omp_span
  * \brief     Calculate dot product of two vectors \p x and \p y using 512bit
  *            AVX512 double intrinsics (8 double numbers, entire cache line),
@@ -78,22 +438,353 @@
  * \return    Dot product of the two vectors
 */
 inline double avx512_omp_span(std::span<double> const &x, std::span<double> const &y)
+{
+    assert(x.size() % (AVX512_REG_SIZE) == 0);
+    return simd_omp_span<SimdAvx512, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx512_omp_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment using 512bit AVX512 double intrinsics: the head is peeled up to
+ *            the next cache line boundary of \p x, the main loop works on entire cache
+ *            lines of \p x and the tail is loaded with a mask, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx512_omp_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    return simd_omp_unaligned<SimdAvx512, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
+}
+
+/**\fn        avx512_omp_dot2
+ * \brief     Calculate dot product of two vectors \p x and \p y in about twice the
+ *            working precision (Dot2, see compensated.hpp) using AVX512 double
+ *            intrinsics, container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx512_omp_dot2(std::span<double> const &x, std::span<double> const &y)
 {
     assert(x.size() == y.size());
-    size_t const N = x.size();
+    return simd_omp_dot2<SimdAvx512, AVX512_ACCUMULATORS, true>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn        avx512_omp_dot2_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment in about twice the working precision (Dot2, see compensated.hpp)
+ *            using AVX512 double intrinsics, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx512_omp_dot2_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_dot2<SimdAvx512, AVX512_ACCUMULATORS, false>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn        avx512_omp_reproducible
+ * \brief     Calculate dot product of two aligned and padded vectors \p x and \p y
+ *            bitwise independent of the number of threads (see reproducible.hpp) using
+ *            AVX512 double intrinsics, container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx512_omp_reproducible(std::span<double> const &x, std::span<double> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_reproducible<SimdAvx512, AVX512_ACCUMULATORS, true>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn        avx512_omp_reproducible_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment bitwise independent of the number of threads (see
+ *            reproducible.hpp) using AVX512 double intrinsics, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double avx512_omp_reproducible_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_reproducible<SimdAvx512, AVX512_ACCUMULATORS, false>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn         avx512_omp_batch
+ * \brief      Calculate the dot products of all \p pairs of a batch in a single parallel
+ *             region (see batched.hpp) using AVX512 double intrinsics
+ *
+ * \param[in]  pairs     the pairs of the batch
+ * \param[out] results   the dot products of the pairs
+*/
+inline void avx512_omp_batch(std::span<DotPair const> const &pairs, std::span<double> const &results)
+{
+    simd_omp_batch<SimdAvx512, AVX512_ACCUMULATORS>(pairs, results);
+}
+
+
+/// number of rows of a row-major and columns of a column-major matrix that are register-blocked
+#define AVX512_GEMV_ROWS    8
+#define AVX512_GEMV_COLUMNS 4
+
+
+/**\fn         avx512_omp_gemv
+ * \brief      Calculate the dot products r_j = y_j·x of \p x with all rows y_j of the
+ *             matrix \p a stored in \p layout (see gemv.hpp) using AVX512 double
+ *             intrinsics
+ *
+ * \param[in]  a        the matrix of r.size() rows and x.size() columns
+ * \param[in]  layout   storage order of the matrix
+ * \param[in]  x        the shared operand
+ * \param[out] r        the dot products of all rows
+*/
+inline void avx512_omp_gemv(std::span<double const> const &a, Layout const layout,
+                           std::span<double const> const &x, std::span<double> const &r)
+{
+    simd_omp_gemv<SimdAvx512, AVX512_GEMV_ROWS, AVX512_GEMV_COLUMNS>(a, layout, x, r);
+}
+
+
+/**\fn         avx512_omp_topk
+ * \brief      Search the \p k vectors of the \p collection with the largest dot product
+ *             with \p query (see topk.hpp) using AVX512 double intrinsics
+ *
+ * \param[in]  collection   the blocked collection
+ * \param[in]  query        the query of collection.dim elements
+ * \param[in]  k            number of wished results
+ * \param[out] hits         the (at most) k best vectors in the order of decreasing dot products
+ * \return     Number of blocks that were skipped
+*/
+inline size_t avx512_omp_topk(BlockedCollection const &collection, std::span<double const> const &query,
+                             size_t const k, std::vector<ScoredIndex> &hits)
+{
+    return simd_omp_topk<SimdAvx512>(collection, query, k, hits);
+}
+
+
+/// number of rows of the register tile of the matrix product (the tile has two registers per row)
+#define AVX512_GEMM_ROWS 12
+
+
+/**\fn         avx512_omp_dgemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) blocked for the cache hierarchy (see gemm.hpp) using
+ *             AVX512 double intrinsics
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+inline void avx512_omp_dgemm(std::span<double const> const &a, std::span<double const> const &b,
+                            std::span<double> const &c, size_t const m, size_t const n, size_t const k)
+{
+    simd_omp_gemm<SimdAvx512, AVX512_GEMM_ROWS>(a, b, c, m, n, k);
+}
+
+
+/**\fn         avx512_omp_sgemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) blocked for the cache hierarchy (see gemm.hpp) using
+ *             AVX512 single precision intrinsics
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+inline void avx512_omp_sgemm(std::span<float const> const &a, std::span<float const> const &b,
+                            std::span<float> const &c, size_t const m, size_t const n, size_t const k)
+{
+    simd_omp_gemm<SimdAvx512Float, AVX512_GEMM_ROWS>(a, b, c, m, n, k);
+}
+
+
+/**\fn         avx512_omp_peak
+ * \brief      Measure the attainable peak performance of AVX512 double fused
+ *             multiply-adds of all threads (see gemm.hpp)
+ *
+ * \param[in]  iterations   number of fused multiply-adds per chain
+ * \param[out] flops        number of floating point operations that were performed
+ * \return     Checksum of the chains
+*/
+inline double avx512_omp_peak(size_t const iterations, double &flops)
+{
+    return simd_omp_peak<SimdAvx512>(iterations, flops);
+}
+
+
+/**\fn         avx512_omp_peak_float
+ * \brief      Measure the attainable peak performance of AVX512 single precision fused
+ *             multiply-adds of all threads (see gemm.hpp)
+ *
+ * \param[in]  iterations   number of fused multiply-adds per chain
+ * \param[out] flops        number of floating point operations that were performed
+ * \return     Checksum of the chains
+*/
+inline double avx512_omp_peak_float(size_t const iterations, double &flops)
+{
+    return simd_omp_peak<SimdAvx512Float>(iterations, flops);
+}
+
+
+/**\fn         avx512_omp_soa
+ * \brief      Calculate the dot products r_j = x_j·y_j of all pairs of vectors of Dim
+ *             elements stored as structure of arrays (see soa.hpp) using AVX512 double
+ *             intrinsics across the pairs
+ *
+ * \param[in]  x   the first vectors of the pairs
+ * \param[in]  y   the second vectors of the pairs
+ * \param[out] r   the dot products of the pairs
+*/
+template <size_t Dim>
+inline void avx512_omp_soa(SoaVectors const &x, SoaVectors const &y, std::span<double> const &r)
+{
+    simd_omp_soa<SimdAvx512, Dim>(x, y, r);
+}
+
+
+/**\fn        avx512_omp_sparse
+ * \brief     Calculate dot product of the sparse vector \p x and the dense vector \p y
+ *            (see sparse.hpp) using AVX512 double intrinsics and gathers with 64 or 32
+ *            bit positions
+ *
+ * \param[in] x   the sparse vector
+ * \param[in] y   the dense vector
+ * \return    Dot product of the two vectors
+*/
+template <typename Index>
+inline double avx512_omp_sparse(SparseVector<Index> const &x, std::span<double const> const &y)
+{
+    return simd_omp_sparse<SimdAvx512, SPARSE_UNROLL>(x, y);
+}
 
-    __m512d _res = _mm512_setzero_pd();
 
-    #pragma omp parallel for shared(x, y) reduction(addpd: _res)
-    for (size_t i = 0; i < N; i += AVX512_REG_SIZE)
+/**\fn        avx512_omp_sparse_sparse
+ * \brief     Calculate dot product of the sparse vectors \p x and \p y (see sparse.hpp)
+ *            by intersecting registers of 64 bit positions with AVX512 intrinsics
+ *
+ * \param[in] x   the first sparse vector
+ * \param[in] y   the second sparse vector
+ * \return    Dot product of the two vectors
+*/
+inline double avx512_omp_sparse_sparse(SparseVector<int64_t> const &x, SparseVector<int64_t> const &y)
+{
+    return simd_omp_sparse_sparse<SimdAvx512>(x, y);
+}
+
+
+/**\fn        avx512_omp_span_float
+ * \brief     Calculate dot product of two vectors \p x and \p y using 512bit
+ *            AVX512 single precision intrinsics (16 float numbers, entire cache
+ *            line), container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline float avx512_omp_span_float(std::span<float> const &x, std::span<float> const &y)
+{
+    return simd_omp_span<SimdAvx512Float, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx512_omp_unaligned_float
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment using 512bit AVX512 single precision intrinsics, container:
+ *            C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline float avx512_omp_unaligned_float(std::span<float const> const &x, std::span<float const> const &y)
+{
+    return simd_omp_unaligned<SimdAvx512Float, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx512_omp_span_int16
+ * \brief     Calculate the exact dot product of two vectors \p x and \p y of 16 bit
+ *            integers using AVX512 (vpmaddwd, 32 numbers per register), container:
+ *            C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t avx512_omp_span_int16(std::span<int16_t> const &x, std::span<int16_t> const &y)
+{
+    return simd_omp_span<SimdAvx512Int16, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
+}
+
+
+/**\fn        avx512_omp_span_u8s8
+ * \brief     Calculate the exact dot product of a vector \p x of unsigned and a vector
+ *            \p y of signed 8 bit integers using AVX512 BW (widening and vpmaddwd, 64
+ *            numbers per register), container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t avx512_omp_span_u8s8(std::span<uint8_t> const &x, std::span<int8_t> const &y)
+{
+    return simd_omp_span<SimdAvx512U8S8, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
+}
+
+
+#ifdef __AVX512VNNI__
+
+/**\struct SimdAvx512Vnni
+ * \brief  Traits class of AVX512 VNNI for unsigned times signed 8 bit integers: four
+ *         products per 32 bit lane are accumulated by a single instruction (vpdpbusd)
+*/
+struct SimdAvx512Vnni: public SimdAvx512U8S8
+{
+    static inline acc fmadd(reg _x, reg _y, acc _c)
     {
-        _res = _mm512_fmadd_pd(_mm512_load_pd(&x[i]), _mm512_load_pd(&y[i]), _res);
+        _c.narrow = _mm512_dpbusd_epi32(_c.narrow, _x, _y);
+        return _c;
     }
+};
 
-    // reduce intrinsic to single double
-    return _mm512_reduce_add_pd(_res);
+
+/**\fn        avx512_vnni_omp_span_u8s8
+ * \brief     Calculate the exact dot product of a vector \p x of unsigned and a vector
+ *            \p y of signed 8 bit integers using AVX512 VNNI (vpdpbusd, 64 numbers per
+ *            register), container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t avx512_vnni_omp_span_u8s8(std::span<uint8_t> const &x, std::span<int8_t> const &y)
+{
+    return simd_omp_span<SimdAvx512Vnni, AVX512_UNROLL, AVX512_ACCUMULATORS, AVX512_PREFETCH>(x, y);
 }
 
+#endif // __AVX512VNNI__
+
+} // namespace ISA_NAMESPACE
+
 #endif // __AVX512CD__
 
 #endif // AVX512_OMP_H_INCLUDED
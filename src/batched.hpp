@@ -0,0 +1,258 @@
+#ifndef BATCHED_H_INCLUDED
+#define BATCHED_H_INCLUDED
+
+/**
+ * \file     batched.hpp
+ * \brief    many independent dot products computed in a single parallel region
+ * \mainpage Batched dot products: every call of a single-pair kernel opens its own
+ *           parallel region and reduces the results of the threads, which dominates
+ *           the runtime for vectors of a few thousand elements. The batched kernels
+ *           instead compute the dot products of all pairs of a batch inside a single
+ *           parallel region, every pair is computed by a single thread without any
+ *           reduction. For load balancing across pairs of unequal length every pair is
+ *           split into chunks of at most BATCH_CHUNK elements, the chunks are sorted by
+ *           decreasing length and handed out dynamically (longest processing time
+ *           first). The partial results of the chunks of a pair are added in a fixed
+ *           order, so that the results do not depend on the number of threads.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+#include "align.hpp"
+#include "simd_kernel.hpp"
+#include "isa_namespace.hpp"
+
+
+/// maximum number of elements of a chunk of a pair that is computed by a single thread
+#define BATCH_CHUNK 16384
+
+
+/**\struct DotPair
+ * \brief  The two operands of a single dot product of a batch
+*/
+struct DotPair
+{
+    std::span<double const> x;  ///< first operand of any alignment
+    std::span<double const> y;  ///< second operand of the same length as x
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\struct BatchChunk
+ * \brief  A chunk of a pair of a batch computed by a single thread
+*/
+struct BatchChunk
+{
+    size_t pair;   ///< index of the pair
+    size_t begin;  ///< first element of the chunk
+    size_t end;    ///< element behind the last element of the chunk
+    size_t slot;   ///< index of the partial result of the chunk
+};
+
+
+/**\fn         batch_chunks
+ * \brief      Split all \p pairs of a batch into chunks of at most BATCH_CHUNK elements
+ *             sorted by decreasing length. The partial results of the chunks of pair
+ *             \p p are stored consecutively starting from \p first[p].
+ *
+ * \param[in]  pairs   the pairs of the batch
+ * \param[out] first   index of the first partial result of every pair (one more entry than pairs)
+ * \return     The chunks of all pairs
+*/
+inline KernelVector<BatchChunk> batch_chunks(std::span<DotPair const> const &pairs, KernelVector<size_t> &first)
+{
+    first.assign(pairs.size() + 1, 0);
+    for (size_t p = 0; p < pairs.size(); ++p)
+    {
+        assert(pairs[p].x.size() == pairs[p].y.size());
+        first[p + 1] = first[p] + (pairs[p].x.size() + BATCH_CHUNK - 1)/BATCH_CHUNK;
+    }
+
+    KernelVector<BatchChunk> chunks;
+    chunks.reserve(first.back());
+    for (size_t p = 0; p < pairs.size(); ++p)
+    {
+        size_t const N = pairs[p].x.size();
+        for (size_t c = 0; c < first[p + 1] - first[p]; ++c)
+        {
+            chunks.push_back({p, c*BATCH_CHUNK, std::min(N, (c + 1)*BATCH_CHUNK), first[p] + c});
+        }
+    }
+
+    std::stable_sort(chunks.begin(), chunks.end(), [](BatchChunk const &a, BatchChunk const &b)
+                     { return (a.end - a.begin) > (b.end - b.begin); });
+    return chunks;
+}
+
+
+/**\fn        pooled_pairs
+ * \brief     Pairs of a batch whose operands are stored back to back in two pooled
+ *            buffers: pair p consists of the elements [offsets[p], offsets[p+1]) of
+ *            \p x_pool and \p y_pool
+ *
+ * \param[in] x_pool    buffer holding the first operands of all pairs
+ * \param[in] y_pool    buffer holding the second operands of all pairs
+ * \param[in] offsets   offsets of the pairs into the buffers (one more entry than pairs)
+ * \return    The pairs of the batch
+*/
+inline std::vector<DotPair> pooled_pairs(std::span<double const> const &x_pool, std::span<double const> const &y_pool,
+                                         std::span<size_t const> const &offsets)
+{
+    assert(offsets.empty() == false);
+    assert((offsets.back() <= x_pool.size()) && (offsets.back() <= y_pool.size()));
+
+    std::vector<DotPair> pairs(offsets.size() - 1);
+    for (size_t p = 0; p < pairs.size(); ++p)
+    {
+        size_t const length = offsets[p + 1] - offsets[p];
+        pairs[p] = {x_pool.subspan(offsets[p], length), y_pool.subspan(offsets[p], length)};
+    }
+    return pairs;
+}
+
+
+/**\fn         omp_batch
+ * \brief      Calculate the dot products of all \p pairs of a batch in a single parallel
+ *             region with the single-threaded kernel \p kernel (see batch_chunks)
+ *
+ * \param[in]  pairs     the pairs of the batch
+ * \param[out] results   the dot products of the pairs
+ * \param[in]  kernel    callable computing the dot product of \p n elements of two pointers
+*/
+template <typename Kernel>
+void omp_batch(std::span<DotPair const> const &pairs, std::span<double> const &results, Kernel const &kernel)
+{
+    assert(pairs.size() == results.size());
+
+    KernelVector<size_t>           first;
+    KernelVector<BatchChunk> const chunks = batch_chunks(pairs, first);
+    KernelVector<double>           partials(chunks.size(), 0.0);
+
+    #pragma omp parallel shared(pairs, results, chunks, partials, first)
+    {
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t c = 0; c < chunks.size(); ++c)
+        {
+            BatchChunk const &chunk = chunks[c];
+            partials[chunk.slot] = kernel(pairs[chunk.pair].x.data() + chunk.begin,
+                                          pairs[chunk.pair].y.data() + chunk.begin, chunk.end - chunk.begin);
+        }
+
+        // partial results of the chunks of a pair in the order of the chunks
+        #pragma omp for schedule(static)
+        for (size_t p = 0; p < pairs.size(); ++p)
+        {
+            double res = 0.0;
+            for (size_t s = first[p]; s < first[p + 1]; ++s)
+            {
+                res += partials[s];
+            }
+            results[p] = res;
+        }
+    }
+}
+
+
+/**\fn         scalar_omp_batch
+ * \brief      Calculate the dot products of all \p pairs of a batch in a single parallel
+ *             region without manual vectorisation
+ *
+ * \param[in]  pairs     the pairs of the batch
+ * \param[out] results   the dot products of the pairs
+*/
+inline void scalar_omp_batch(std::span<DotPair const> const &pairs, std::span<double> const &results)
+{
+    omp_batch(pairs, results, [](double const* const x, double const* const y, size_t const n)
+    {
+        double res = 0.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            res += x[i]*y[i];
+        }
+        return res;
+    });
+}
+
+
+/**\fn        simd_batch_kernel
+ * \brief     Calculate the dot product of the \p N elements of \p x and \p y of any
+ *            alignment with the instruction set \p Isa on the calling thread only:
+ *            \p Accumulators independent accumulators and a masked tail
+ *
+ * \param[in] x   pointer to the first element of x
+ * \param[in] y   pointer to the first element of y
+ * \param[in] N   number of elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Accumulators>
+inline double simd_batch_kernel(double const* const x, double const* const y, size_t const N)
+{
+    static_assert(Accumulators > 0, "At least a single accumulator is required");
+
+    typedef typename Isa::reg reg;
+    constexpr size_t width = Isa::width;
+    constexpr size_t step  = Accumulators*width;
+    size_t const     body  = N/step*step;
+
+    reg _acc[Accumulators];
+    for (size_t a = 0; a < Accumulators; ++a)
+    {
+        _acc[a] = Isa::zero();
+    }
+
+    for (size_t i = 0; i < body; i += step)
+    {
+        #pragma GCC unroll 16
+        for (size_t a = 0; a < Accumulators; ++a)
+        {
+            _acc[a] = Isa::fmadd(Isa::loadu(x + i + a*width), Isa::loadu(y + i + a*width), _acc[a]);
+        }
+    }
+    _acc[0] = simd_accumulate_partial<Isa>(x + body, y + body, N - body, _acc[0]);
+
+    for (size_t stride = 1; stride < Accumulators; stride *= 2)
+    {
+        for (size_t a = 0; a + stride < Accumulators; a += 2*stride)
+        {
+            _acc[a] = Isa::add(_acc[a], _acc[a + stride]);
+        }
+    }
+    return Isa::reduce(_acc[0]);
+}
+
+
+/**\fn         simd_omp_batch
+ * \brief      Calculate the dot products of all \p pairs of a batch in a single parallel
+ *             region with the instruction set \p Isa (see simd_batch_kernel)
+ *
+ * \param[in]  pairs     the pairs of the batch
+ * \param[out] results   the dot products of the pairs
+*/
+template <typename Isa, size_t Accumulators>
+inline void simd_omp_batch(std::span<DotPair const> const &pairs, std::span<double> const &results)
+{
+    omp_batch(pairs, results, simd_batch_kernel<Isa, Accumulators>);
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // BATCHED_H_INCLUDED
@@ -0,0 +1,215 @@
+#ifndef BATCHING_H_INCLUDED
+#define BATCHING_H_INCLUDED
+
+/**
+ * \file     batching.hpp
+ * \mainpage Benchmark of the batched kernels (see batched.hpp): a batch of many
+ *           independent pairs of random length stored back to back in two pooled
+ *           buffers is computed for every instruction set of the host once by calling
+ *           the single-pair kernel in a loop (a parallel region per pair) and once by
+ *           the batched kernel (a single parallel region). Besides the throughput the
+ *           speed-up of the batched kernel and the largest relative deviation of its
+ *           results from the ones of the loop are reported.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "batched.hpp"
+#include "benchmark.hpp"
+#include "cpu_features.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "random.hpp"
+
+
+/**\struct BatchSettings
+ * \brief  Settings of the benchmark of the batched kernels
+*/
+struct BatchSettings
+{
+    size_t                   pairs      = 4096;   ///< number of pairs of a batch
+    size_t                   min_length = 1000;   ///< minimum number of elements of a pair
+    size_t                   max_length = 50000;  ///< maximum number of elements of a pair
+    std::vector<std::string> ids;                 ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv        = false;  ///< print comma-separated values instead of a table
+};
+
+
+/**\struct BatchRow
+ * \brief  Result of a single kernel of the benchmark of the batched kernels
+*/
+struct BatchRow
+{
+    std::string     name;         ///< name of the kernel
+    BenchmarkResult res;          ///< statistics and throughput of the kernel for the entire batch
+    double          speedup;      ///< speed-up over calling the single-pair kernel in a loop
+    double          deviation;    ///< largest relative deviation from the results of the loop
+};
+
+
+/**\fn         print_batch_row
+ * \brief      Print a row of the benchmark of the batched kernels (or the header if \p row
+ *             is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_batch_row(BatchRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,median_s,min_s,mad_s,ns_per_elem,gbs,speedup,max_rel_deviation,checksum" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(12) << "median[us]"
+            << std::setw(10) << "MAD%" << std::setw(10) << "ns/elem" << std::setw(10) << "GB/s"
+            << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::setw(18) << "checksum" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << s.median << "," << s.min << "," << s.mad << "," << row->res.ns_per_elem << ","
+            << row->res.gbs << "," << row->speedup << "," << row->deviation << "," << row->res.result << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setprecision(3)
+        << std::setw(12) << s.median*1.0e6 << std::setprecision(2) << std::setw(10) << 100.0*s.mad/s.median
+        << std::setprecision(4) << std::setw(10) << row->res.ns_per_elem << std::setprecision(2)
+        << std::setw(10) << row->res.gbs << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation
+        << std::fixed << std::setw(18) << row->res.result << std::endl;
+}
+
+
+/**\fn        batch_offsets
+ * \brief     Offsets of the pairs of a batch into the pooled buffers for random lengths
+ *            uniformly distributed in [min_length, max_length] (stream 2 of the seed)
+ *
+ * \param[in] batch   settings of the benchmark of the batched kernels
+ * \return    Offsets of the pairs (one more entry than pairs)
+*/
+inline std::vector<size_t> batch_offsets(BatchSettings const &batch)
+{
+    assert(batch.min_length <= batch.max_length);
+
+    std::uint64_t const key   = random_key(random_seed(), 2);
+    size_t const        range = batch.max_length - batch.min_length + 1;
+
+    std::vector<size_t> offsets(batch.pairs + 1, 0);
+    for (size_t p = 0; p < batch.pairs; ++p)
+    {
+        offsets[p + 1] = offsets[p] + batch.min_length + random_bits(key, p) % range;
+    }
+    return offsets;
+}
+
+
+/**\fn         run_batch
+ * \brief      Benchmark the single-pair kernels in a loop and the batched kernels of the
+ *             instruction sets supported by the host for a batch of random pairs
+ *
+ * \param[in]  batch      settings of the benchmark of the batched kernels
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_batch(BatchSettings const &batch, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    std::vector<size_t> const offsets = batch_offsets(batch);
+    size_t const              total   = offsets.back();
+
+    // the pooled buffers of both operands and the temporary vector a buffer is initialised from
+    size_t const required  = 3*total*sizeof(double);
+    size_t const available = detect_available_memory();
+    if ((available > 0) && (required > available))
+    {
+        std::cerr << "Error: a batch of " << batch.pairs << " pairs requires " << (required >> 20) << " MiB but only "
+                  << (available >> 20) << " MiB are available, reduce --length" << std::endl;
+        return;
+    }
+
+    AlignedBuffer<double> x(init_vec<double>(total));
+    AlignedBuffer<double> y(init_vec<double>(total, 1));
+    std::span<double const> const x_pool(x.span().data(), total);
+    std::span<double const> const y_pool(y.span().data(), total);
+
+    std::vector<DotPair> const pairs = pooled_pairs(x_pool, y_pool, offsets);
+    std::vector<double>        loop_results(batch.pairs, 0.0);
+    std::vector<double>        batch_results(batch.pairs, 0.0);
+
+    if (batch.csv == false)
+    {
+        out << "BATCHED DOT PRODUCTS (" << batch.pairs << " pairs of " << batch.min_length << " to " << batch.max_length
+            << " elements, " << total << " elements in total, chunks of " << BATCH_CHUNK << " elements)" << std::endl;
+    }
+    print_batch_row(nullptr, out, batch.csv);
+
+    // checksum over all results of a batch so that the harness has a result to report
+    auto const checksum = [](std::vector<double> const &results)
+    {
+        double sum = 0.0;
+        for (double const r: results)
+        {
+            sum += r;
+        }
+        return sum;
+    };
+
+    for (KernelTable const* table: available_kernels())
+    {
+        if ((batch.ids.empty() == false) && (std::find(batch.ids.begin(), batch.ids.end(), table->id) == batch.ids.end()))
+        {
+            continue;
+        }
+
+        BenchmarkResult const loop = benchmark_callable([&]()
+        {
+            for (size_t p = 0; p < pairs.size(); ++p)
+            {
+                loop_results[p] = table->dot_unaligned(pairs[p].x, pairs[p].y);
+            }
+            return checksum(loop_results);
+        }, total, 2.0*sizeof(double), 2.0, settings);
+        BatchRow const loop_row = {std::string(table->id) + " loop", loop, 1.0, 0.0};
+        print_batch_row(&loop_row, out, batch.csv);
+
+        BenchmarkResult const batched = benchmark_callable([&]()
+        {
+            table->batch(pairs, batch_results);
+            return checksum(batch_results);
+        }, total, 2.0*sizeof(double), 2.0, settings);
+
+        double deviation = 0.0;
+        for (size_t p = 0; p < pairs.size(); ++p)
+        {
+            deviation = std::max(deviation, std::abs(batch_results[p] - loop_results[p])/std::abs(loop_results[p]));
+        }
+        BatchRow const batch_row = {std::string(table->id) + " batch", batched, loop.stats.median/batched.stats.median, deviation};
+        print_batch_row(&batch_row, out, batch.csv);
+    }
+}
+
+#endif // BATCHING_H_INCLUDED
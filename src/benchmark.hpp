@@ -17,10 +17,21 @@
     }
 #endif
 
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include "align.hpp"
 #include "timer.hpp"
 #include "omp_simd.hpp"
-#include "avx_omp.hpp"
+#include "dispatch.hpp"
 
 
 /**\fn        test_alignment
@@ -29,15 +40,16 @@
  *            leftover bytes. For ideal performance the result should be 0 for
  *            both
  *
- * \param[in] first element   pointer to first element
- * \param[in] length          size of the corresponding container
+ * \param[in]  first element   pointer to first element
+ * \param[in]  length          size of the corresponding container
+ * \param[out] out             stream the result is written to
 */
 template <typename T>
-void test_alignment(T* const first_element, size_t const length)
+void test_alignment(T* const first_element, size_t const length, std::ostream &out = std::cout)
 {
-    std::cout.setf(std::ios::boolalpha);
-    std::cout << " first_element%cache_line: " << (size_t)(first_element) % CACHE_LINE  << std::endl;
-    std::cout << " length%cache_line:        " << (length*sizeof(INTR)) % CACHE_LINE    << std::endl;
+    out.setf(std::ios::boolalpha);
+    out << " first_element%cache_line: " << (size_t)(first_element) % CACHE_LINE  << std::endl;
+    out << " length%cache_line:        " << (length*sizeof(T)) % CACHE_LINE       << std::endl;
 }
 
 
@@ -51,34 +63,407 @@ inline void ignore_unused(const T&)
 }
 
 
-/**\fn        benchmark_fun
- * \brief     Function that benchmarks the performance of a function \p f that is
- *            operating on contiguous standard C++ containers by calling it \it
- *            times in a row.
+/**\struct BenchmarkSettings
+ * \brief  Settings of the benchmark harness: a kernel is called \p iterations times
+ *         in a row for every one of the \p repetitions timed samples, preceded by
+ *         \p warmup untimed samples
+*/
+struct BenchmarkSettings
+{
+    size_t warmup      = 2;     ///< number of untimed samples for warming up caches, TLB and frequency
+    size_t repetitions = 15;    ///< number of timed samples used for the statistics
+    size_t iterations  = 1000;  ///< number of calls per sample
+    double outlier     = 3.0;   ///< samples deviating by more than this many (scaled) MADs from the median are rejected, 0 to disable
+};
+
+
+/**\struct Statistics
+ * \brief  Statistics over the runtime of a single call of a kernel in seconds
+*/
+struct Statistics
+{
+    double median   = 0.0;  ///< median of all samples
+    double min      = 0.0;  ///< minimum of the retained samples
+    double mean     = 0.0;  ///< arithmetic mean of the retained samples
+    double stddev   = 0.0;  ///< sample standard deviation of the retained samples
+    double mad      = 0.0;  ///< median absolute deviation of all samples
+    size_t samples  = 0;    ///< number of samples
+    size_t rejected = 0;    ///< number of samples rejected as outliers
+};
+
+
+/**\fn        median_of
+ * \brief     Median of the given \p values
+ *
+ * \param[in] values   vector of values (taken by value as it is sorted partially)
+ * \return    The median of the values
+*/
+inline double median_of(std::vector<double> values)
+{
+    assert(values.empty() == false);
+
+    size_t const n   = values.size();
+    size_t const mid = n/2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double const upper = values[mid];
+    if (n % 2 == 1)
+    {
+        return upper;
+    }
+    double const lower = *std::max_element(values.begin(), values.begin() + mid);
+    return 0.5*(lower + upper);
+}
+
+
+/**\fn        compute_statistics
+ * \brief     Compute the robust statistics over the given \p samples: Median and
+ *            MAD are computed over all samples, samples further than \p outlier
+ *            times the scaled MAD (1.4826*MAD, consistent with the standard deviation
+ *            for normally distributed data) from the median are rejected before
+ *            computing minimum, mean and standard deviation
+ *
+ * \param[in] samples   the runtimes of the samples
+ * \param[in] outlier   threshold for rejection in scaled MADs (0 to disable)
+ * \return    The statistics over the samples
+*/
+inline Statistics compute_statistics(std::vector<double> const &samples, double const outlier)
+{
+    assert(samples.empty() == false);
+
+    Statistics stats;
+    stats.samples = samples.size();
+    stats.median  = median_of(samples);
+
+    std::vector<double> deviation(samples.size());
+    std::transform(samples.begin(), samples.end(), deviation.begin(),
+                   [&stats](double const s){ return std::abs(s - stats.median); });
+    stats.mad = median_of(deviation);
+
+    double const limit = outlier * 1.4826 * stats.mad;
+    std::vector<double> retained;
+    for (double const s: samples)
+    {
+        if ((outlier <= 0.0) || (stats.mad <= 0.0) || (std::abs(s - stats.median) <= limit))
+        {
+            retained.push_back(s);
+        }
+    }
+    stats.rejected = samples.size() - retained.size();
+
+    stats.min  = *std::min_element(retained.begin(), retained.end());
+    stats.mean = std::accumulate(retained.begin(), retained.end(), 0.0)/retained.size();
+
+    double sq = 0.0;
+    for (double const s: retained)
+    {
+        sq += (s - stats.mean)*(s - stats.mean);
+    }
+    stats.stddev = (retained.size() > 1) ? std::sqrt(sq/(retained.size() - 1)) : 0.0;
+
+    return stats;
+}
+
+
+/**\struct BenchmarkResult
+ * \brief  Result of benchmarking a single kernel: runtime statistics as well as
+ *         the derived throughput metrics
+*/
+struct BenchmarkResult
+{
+    Statistics stats;               ///< statistics over the runtime of a single call in seconds
+    size_t     length      = 0;     ///< number of elements per operand
+    double     ns_per_elem = 0.0;   ///< median runtime per element in nanoseconds
+    double     gbs         = 0.0;   ///< memory throughput in GB/s (based on the median)
+    double     gflops      = 0.0;   ///< floating point throughput in GFLOP/s (based on the median)
+    double     result      = 0.0;   ///< result of the kernel (for checking correctness)
+};
+
+
+/**\fn        benchmark_callable
+ * \brief     Benchmark an arbitrary callable \p f that performs a reduction over
+ *            \p length elements per operand
  *
- * \param[in] x   a (un)aligned C++ or boosted aligned std vector/array
- * \param[in] y   a (un)aligned C++ or boosted aligned std vector/array
- * \param[in] f   pointer to a function that takes two references to vectors/arrays as
- *                arguments
- * \param[in] it  number of iterations for test
-*/
-template <typename T1 = std::span<double>, typename T2 = double>
-void benchmark_fun(T1 const &x, T1 const &y, T2 (*f)(T1 const &x, T1 const &y), size_t it)
+ * \param[in] f          callable without arguments returning the result
+ * \param[in] length     number of elements per operand
+ * \param[in] bytes      number of bytes read per element (all operands)
+ * \param[in] flops      number of floating point operations per element
+ * \param[in] settings   settings of the benchmark harness
+ * \return    Statistics and throughput metrics of the kernel
+*/
+template <typename F>
+BenchmarkResult benchmark_callable(F const &f, size_t const length, double const bytes, double const flops,
+                                   BenchmarkSettings const &settings)
 {
-    typedef typename T1::value_type ded_type;
-    static_assert(std::is_same<ded_type,T2>::value == true);
+    assert(settings.repetitions > 0);
+    assert(settings.iterations  > 0);
 
     Timer stopwatch;
-    stopwatch.Start();
+    std::vector<double> samples;
+    samples.reserve(settings.repetitions);
 
-    for (size_t i = 0; i < it; ++i)
+    for (size_t r = 0; r < settings.warmup + settings.repetitions; ++r)
     {
-        INTR volatile res = (*f)(x, y);
-        ignore_unused(res);
+        stopwatch.Start();
+        for (size_t i = 0; i < settings.iterations; ++i)
+        {
+            auto volatile res = f();
+            ignore_unused(res);
+        }
+        double const runtime = stopwatch.Stop();
+
+        if (r >= settings.warmup)
+        {
+            samples.push_back(runtime/settings.iterations);
+        }
     }
 
-    stopwatch.Stop();
-    std::cout << " runtime: " << stopwatch.GetRuntime() << ", result: " << (*f)(x, y) << std::endl;
+    BenchmarkResult res;
+    res.stats       = compute_statistics(samples, settings.outlier);
+    res.length      = length;
+    res.ns_per_elem = res.stats.median*1.0e9/length;
+    res.gbs         = bytes*length/res.stats.median*1.0e-9;
+    res.gflops      = flops*length/res.stats.median*1.0e-9;
+    res.result      = static_cast<double>(f());
+    return res;
+}
+
+
+/**\fn        benchmark_fun
+ * \brief     Function that benchmarks the performance of a dot product \p f that is
+ *            operating on contiguous standard C++ containers. Reads a value of each
+ *            operand and performs two (floating point or integer) operations per
+ *            element. The operands may hold different element types (e.g. unsigned
+ *            and signed 8 bit integers) and the result may be wider than them.
+ *
+ * \param[in] x          a (un)aligned C++ or boosted aligned std vector/array
+ * \param[in] y          a (un)aligned C++ or boosted aligned std vector/array
+ * \param[in] f          pointer to a function that takes two references to vectors/arrays as
+ *                       arguments
+ * \param[in] settings   settings of the benchmark harness
+ * \return    Statistics and throughput metrics of the kernel
+*/
+template <typename T1 = std::span<double>, typename R = double, typename T2 = T1>
+BenchmarkResult benchmark_fun(T1 const &x, T2 const &y, R (*f)(T1 const &x, T2 const &y), BenchmarkSettings const &settings)
+{
+    typedef typename std::remove_cv<typename T1::value_type>::type x_type;
+    typedef typename std::remove_cv<typename T2::value_type>::type y_type;
+
+    return benchmark_callable([&x, &y, f](){ return (*f)(x, y); },
+                              x.size(), static_cast<double>(sizeof(x_type) + sizeof(y_type)), 2.0, settings);
+}
+
+
+/**\struct NamedKernel
+ * \brief  A dot product kernel operating on spans together with its name, the
+ *         element type of y and the result type follow from \p T (see DotTraits)
+*/
+template <typename T = double>
+struct NamedKernel
+{
+    typedef typename DotTraits<T>::y_type      y_type;
+    typedef typename DotTraits<T>::result_type result_type;
+
+    std::string id;                                                                   ///< short identifier used on the command line
+    std::string name;                                                                 ///< name of the kernel used in the output
+    result_type (*fun)(std::span<T> const &x, std::span<y_type> const &y);            ///< pointer to the kernel
+    result_type (*unaligned)(std::span<T const> const &x, std::span<y_type const> const &y) = nullptr;  ///< variant for any length and alignment (if available)
+};
+
+
+/**\fn        registered_kernels
+ * \brief     All span kernels for the element type \p T that can be benchmarked on
+ *            this host: the OpenMP auto-vectorised kernel as well as (for double,
+ *            float, 16 bit and 8 bit integers) the manually vectorised kernels of all
+ *            instruction sets supported by the host
+ *
+ * \return    Vector of the kernels and their names
+*/
+template <typename T = double>
+inline std::vector<NamedKernel<T>> registered_kernels()
+{
+    std::vector<NamedKernel<T>> kernels;
+    kernels.push_back({"omp_simd", "OMP SIMD", omp_simd_span<T>});
+    for (KernelTable const* table: available_kernels())
+    {
+        if constexpr (std::is_same<T,double>::value == true)
+        {
+            kernels.push_back({table->id, table->name, table->dot_span, table->dot_unaligned});
+        }
+        else if constexpr (std::is_same<T,float>::value == true)
+        {
+            kernels.push_back({table->id, table->name, table->dot_span_float, table->dot_unaligned_float});
+        }
+        else if constexpr (std::is_same<T,int16_t>::value == true)
+        {
+            kernels.push_back({table->id, table->name, table->dot_int16});
+        }
+        else if constexpr (std::is_same<T,uint8_t>::value == true)
+        {
+            kernels.push_back({table->id, table->name, table->dot_u8s8});
+        }
+    }
+    if constexpr (std::is_same<T,double>::value == true)
+    {
+        // accurate (compensated) kernels next to the naive ones to quantify the cost of the accuracy
+        for (KernelTable const* table: available_kernels())
+        {
+            kernels.push_back({std::string(table->id) + "_dot2", std::string(table->name) + " Dot2",
+                               table->dot2, table->dot2_unaligned});
+        }
+        // deterministic kernels whose result does not depend on the number of threads
+        for (KernelTable const* table: available_kernels())
+        {
+            kernels.push_back({std::string(table->id) + "_repro", std::string(table->name) + " Reproducible",
+                               table->repro, table->repro_unaligned});
+        }
+    }
+    if constexpr (std::is_same<T,uint8_t>::value == true)
+    {
+        if (vnni_kernel() != nullptr)
+        {
+            kernels.push_back({"vnni", "AVX512 VNNI OMP", vnni_kernel()});
+        }
+    }
+    return kernels;
+}
+
+
+/**\fn         select_kernels
+ * \brief      Registered kernels restricted to the given identifiers \p ids
+ *
+ * \param[in]  ids       identifiers of the wished kernels (all kernels if empty)
+ * \param[out] kernels   the selected kernels in the order of registration
+ * \return     Boolean flag signalling if all identifiers correspond to available kernels
+*/
+template <typename T = double>
+inline bool select_kernels(std::vector<std::string> const &ids, std::vector<NamedKernel<T>> &kernels)
+{
+    std::vector<NamedKernel<T>> const all = registered_kernels<T>();
+    kernels.clear();
+
+    bool found_all = true;
+    for (std::string const &id: ids)
+    {
+        if (std::none_of(all.begin(), all.end(), [&id](NamedKernel<T> const &k){ return k.id == id; }))
+        {
+            std::cerr << "Kernel '" << id << "' is not available on this host for this data type" << std::endl;
+            found_all = false;
+        }
+    }
+    std::copy_if(all.begin(), all.end(), std::back_inserter(kernels), [&ids](NamedKernel<T> const &k)
+                 { return ids.empty() || (std::find(ids.begin(), ids.end(), k.id) != ids.end()); });
+
+    return found_all;
+}
+
+
+/**\fn         check_extreme_operands
+ * \brief      Check that the integer kernels are exact for the operands at the end of the
+ *             range that the random fill avoids (see random_integer): x and y are set to
+ *             the minimum of their type (the maximum for unsigned x), e.g. the pairs of
+ *             products -32768*-32768 + -32768*-32768 = 2^31 of 16 bit integers exceed 32 bit
+ *
+ * \param[in]  kernels   the kernels to be checked
+ * \param[in]  length    number of elements of the operands
+ * \param[out] out       stream the results are written to
+ * \param[in]  csv       do not print anything but errors
+ * \return     Boolean flag signalling if all kernels are exact
+*/
+template <typename T, typename Y = typename DotTraits<T>::y_type>
+inline bool check_extreme_operands(std::vector<NamedKernel<T>> const &kernels, size_t const length,
+                                   std::ostream &out = std::cout, bool const csv = false)
+{
+    static_assert(std::is_integral<T>::value, "Only integral types are supported");
+    typedef typename DotTraits<T>::result_type R;
+
+    T const x_value = (std::is_signed<T>::value == true) ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    Y const y_value = std::numeric_limits<Y>::min();
+    R const exact   = static_cast<R>(length)*static_cast<R>(x_value)*static_cast<R>(y_value);
+
+    AlignedBuffer<T> x(length, x_value);
+    AlignedBuffer<Y> y(length, y_value);
+
+    if (csv == false)
+    {
+        out << "EXTREME OPERANDS (" << length << " elements " << static_cast<R>(x_value) << " and "
+            << static_cast<R>(y_value) << ", exact result " << exact << ")" << std::endl;
+    }
+
+    bool exact_all = true;
+    for (NamedKernel<T> const &kernel: kernels)
+    {
+        R const res = kernel.fun(x.span(), y.span());
+        if (res != exact)
+        {
+            std::cerr << "Error: kernel '" << kernel.id << "' returns " << res << " instead of " << exact
+                      << " for extreme operands" << std::endl;
+            exact_all = false;
+        }
+        else if (csv == false)
+        {
+            out << " -" << kernel.name << ": exact" << std::endl;
+        }
+    }
+    if (csv == false)
+    {
+        out << std::endl;
+    }
+    return exact_all;
+}
+
+
+/**\fn         print_header
+ * \brief      Print the header of the table (or comma-separated values) written by
+ *             print_result
+ *
+ * \param[out] out   stream the header is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_header(std::ostream &out = std::cout, bool const csv = false)
+{
+    if (csv == true)
+    {
+        out << "kernel,length,median_s,min_s,mean_s,stddev_s,mad_s,rejected,ns_per_elem,gbs,gflops,result" << std::endl;
+        return;
+    }
+    out << std::left  << std::setw(44) << " kernel" << std::right
+        << std::setw(12) << "median[us]" << std::setw(12) << "min[us]"
+        << std::setw(12) << "mean[us]"   << std::setw(10) << "stddev%"
+        << std::setw(10) << "MAD%"       << std::setw(6)  << "rej"
+        << std::setw(10) << "ns/elem"    << std::setw(10) << "GB/s"
+        << std::setw(10) << "GFLOP/s"    << std::setw(18) << "result" << std::endl;
+}
+
+
+/**\fn         print_result
+ * \brief      Print the statistics and throughput of a benchmarked kernel as a row of
+ *             a table (or as comma-separated values)
+ *
+ * \param[in]  name   name of the kernel
+ * \param[in]  res    result of the benchmark
+ * \param[out] out    stream the result is written to
+ * \param[in]  csv    print comma-separated values instead of a table
+*/
+inline void print_result(std::string const &name, BenchmarkResult const &res, std::ostream &out = std::cout, bool const csv = false)
+{
+    Statistics const &s = res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << name << "," << res.length << "," << s.median << "," << s.min << "," << s.mean << ","
+            << s.stddev << "," << s.mad << "," << s.rejected << "," << res.ns_per_elem << ","
+            << res.gbs << "," << res.gflops << "," << res.result << std::endl;
+        return;
+    }
+    out << std::fixed << std::setfill(' ')
+        << std::left  << std::setw(44) << (" -" + name) << std::right << std::setprecision(3)
+        << std::setw(12) << s.median*1.0e6 << std::setw(12) << s.min*1.0e6
+        << std::setw(12) << s.mean*1.0e6   << std::setprecision(2)
+        << std::setw(10) << 100.0*s.stddev/s.mean << std::setw(10) << 100.0*s.mad/s.median
+        << std::setw(6)  << s.rejected     << std::setprecision(4)
+        << std::setw(10) << res.ns_per_elem << std::setprecision(2)
+        << std::setw(10) << res.gbs << std::setw(10) << res.gflops
+        << std::setprecision(3) << std::setw(18) << res.result << std::endl;
 }
 
 #endif // BENCHMARK_H_INCLUDED
@@ -0,0 +1,182 @@
+/**
+ * \file     blas.cpp
+ * \mainpage BLAS interface of the shared library libompdot.so (see blas.hpp). Only the
+ *           symbols declared in blas.hpp are exported, the kernel tables and all inline
+ *           functions are hidden so that preloading the library does not interpose
+ *           anything else. Built with the make target lib.
+*/
+
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdlib>
+#include "blas.hpp"
+#include "complex.hpp"
+#include "dispatch.hpp"
+
+
+/// number of threads of the library, 0 for the OpenMP default
+static std::atomic<int> blas_threads = []()
+{
+    char const* const value = std::getenv(THREADS_ENV_VAR);
+    return (value == nullptr) ? 0 : std::max(0, std::atoi(value));
+}();
+
+
+/**\fn        with_threads
+ * \brief     Call \p f with the number of threads of the library, a single one for fewer
+ *            than BLAS_PARALLEL_MIN elements, and restore the number of threads of the
+ *            caller afterwards
+ *
+ * \param[in] n   number of elements
+ * \param[in] f   the callable computing the dot product
+ * \return    The result of \p f
+*/
+template <typename F>
+static inline auto with_threads(size_t const n, F const &f)
+{
+    int const threads = (n < BLAS_PARALLEL_MIN) ? 1 : blas_threads.load(std::memory_order_relaxed);
+    if (threads <= 0)
+    {
+        return f();
+    }
+
+    int const previous = omp_get_max_threads();
+    omp_set_num_threads(threads);
+    auto const res = f();
+    omp_set_num_threads(previous);
+    return res;
+}
+
+
+/**\fn        strided_dot
+ * \brief     Dot product of the real vectors \p x and \p y of \p n elements with the
+ *            increments \p incx and \p incy like the BLAS: the contiguous vectors with
+ *            the dispatched kernel, all others with an OpenMP loop
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+template <typename T>
+static inline T strided_dot(int const n, T const* x, int const incx, T const* y, int const incy)
+{
+    if (n <= 0)
+    {
+        return static_cast<T>(0);
+    }
+
+    size_t const length = static_cast<size_t>(n);
+    return with_threads(length, [&]()
+    {
+        if ((incx == 1) && (incy == 1))
+        {
+            return dot_unaligned(std::span<T const>(x, length), std::span<T const>(y, length));
+        }
+
+        T const* const x0  = first_element(x, length, incx);
+        T const* const y0  = first_element(y, length, incy);
+        T              res = static_cast<T>(0);
+
+        #pragma omp parallel for schedule(static) reduction(+: res)
+        for (size_t i = 0; i < length; ++i)
+        {
+            res += x0[static_cast<std::ptrdiff_t>(i)*incx]*y0[static_cast<std::ptrdiff_t>(i)*incy];
+        }
+        return res;
+    });
+}
+
+
+/**\fn        complex_dot
+ * \brief     Dot product of the complex double vectors \p x and \p y of \p n elements
+ *            with the increments \p incx and \p incy like the BLAS
+ *
+ * \param[in] n           number of elements
+ * \param[in] x           the first vector
+ * \param[in] incx        increment between two elements of \p x
+ * \param[in] y           the second vector
+ * \param[in] incy        increment between two elements of \p y
+ * \param[in] conjugate   conjugate \p x or not
+ * \return    Dot product of the two vectors
+*/
+static inline std::complex<double> complex_dot(int const n, void const* x, int const incx,
+                                               void const* y, int const incy, bool const conjugate)
+{
+    if (n <= 0)
+    {
+        return std::complex<double>(0.0, 0.0);
+    }
+
+    size_t const length = static_cast<size_t>(n);
+    return with_threads(length, [&]()
+    {
+        return dot_complex(length, static_cast<std::complex<double> const*>(x), incx,
+                           static_cast<std::complex<double> const*>(y), incy, conjugate);
+    });
+}
+
+
+extern "C"
+{
+
+double ddot_(int const* n, double const* x, int const* incx, double const* y, int const* incy)
+{
+    return strided_dot(*n, x, *incx, y, *incy);
+}
+
+float sdot_(int const* n, float const* x, int const* incx, float const* y, int const* incy)
+{
+    return strided_dot(*n, x, *incx, y, *incy);
+}
+
+ompdot_complex_double zdotc_(int const* n, void const* x, int const* incx, void const* y, int const* incy)
+{
+    return complex_dot(*n, x, *incx, y, *incy, true);
+}
+
+ompdot_complex_double zdotu_(int const* n, void const* x, int const* incx, void const* y, int const* incy)
+{
+    return complex_dot(*n, x, *incx, y, *incy, false);
+}
+
+double cblas_ddot(int const n, double const* x, int const incx, double const* y, int const incy)
+{
+    return strided_dot(n, x, incx, y, incy);
+}
+
+float cblas_sdot(int const n, float const* x, int const incx, float const* y, int const incy)
+{
+    return strided_dot(n, x, incx, y, incy);
+}
+
+void cblas_zdotc_sub(int const n, void const* x, int const incx, void const* y, int const incy, void* dotc)
+{
+    *static_cast<std::complex<double>*>(dotc) = complex_dot(n, x, incx, y, incy, true);
+}
+
+void cblas_zdotu_sub(int const n, void const* x, int const incx, void const* y, int const incy, void* dotu)
+{
+    *static_cast<std::complex<double>*>(dotu) = complex_dot(n, x, incx, y, incy, false);
+}
+
+void ompdot_set_num_threads(int const threads)
+{
+    blas_threads.store(std::max(0, threads), std::memory_order_relaxed);
+}
+
+int ompdot_get_num_threads(void)
+{
+    return blas_threads.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,169 @@
+#ifndef BLAS_H_INCLUDED
+#define BLAS_H_INCLUDED
+
+/**
+ * \file     blas.hpp
+ * \brief    interface of the shared library libompdot.so exporting the kernels as BLAS
+ * \mainpage The dot products of the reference BLAS (Fortran symbols ddot_, sdot_, zdotc_
+ *           and zdotu_) and of the CBLAS (cblas_ddot, cblas_sdot, cblas_zdotc_sub and
+ *           cblas_zdotu_sub) with the full semantics of the increments incx and incy:
+ *           zero or negative increments, the latter traversing the vectors backwards,
+ *           and no operation for n <= 0. The library selects the kernel table of the
+ *           host at runtime (see dispatch.hpp) so that it can replace the system BLAS for
+ *           these routines with LD_PRELOAD without recompiling the application. Contiguous
+ *           vectors use the tuned kernels, strided real vectors an OpenMP loop. Complex
+ *           results are returned like gfortran does (in registers as for a C99 double
+ *           _Complex). The number of threads is the OpenMP default unless it is set with
+ *           the environment variable THREADS_ENV_VAR or ompdot_set_num_threads, short
+ *           vectors below BLAS_PARALLEL_MIN elements are computed by a single thread.
+ *           The header may be included from C as well as from C++.
+ * \warning  Integers are 32 bit (LP64 interface), the ILP64 interface is not provided!
+*/
+
+
+#ifdef __cplusplus
+    #include <complex>
+    /// complex double result as returned by the Fortran interface
+    typedef std::complex<double> ompdot_complex_double;
+    extern "C" {
+#else
+    #include <complex.h>
+    /// complex double result as returned by the Fortran interface
+    typedef double _Complex ompdot_complex_double;
+#endif
+
+
+/// environment variable that sets the number of threads of the library (OpenMP default if unset)
+#define THREADS_ENV_VAR "DOTPROD_NUM_THREADS"
+
+/// number of elements below which the library computes a dot product with a single thread
+#define BLAS_PARALLEL_MIN 16384
+
+/// symbols exported by the library, all others are hidden
+#define OMPDOT_EXPORT __attribute__((visibility("default")))
+
+
+/**\fn        ddot_
+ * \brief     Dot product of the double vectors \p x and \p y of \p n elements with the
+ *            increments \p incx and \p incy (Fortran interface)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+OMPDOT_EXPORT double ddot_(int const* n, double const* x, int const* incx, double const* y, int const* incy);
+
+/**\fn        sdot_
+ * \brief     Dot product of the float vectors \p x and \p y of \p n elements with the
+ *            increments \p incx and \p incy (Fortran interface)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+OMPDOT_EXPORT float sdot_(int const* n, float const* x, int const* incx, float const* y, int const* incy);
+
+/**\fn        zdotc_
+ * \brief     Dot product of the conjugated complex double vector \p x and the vector \p y
+ *            of \p n elements with the increments \p incx and \p incy (Fortran interface)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector (interleaved real and imaginary parts)
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector (interleaved real and imaginary parts)
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+OMPDOT_EXPORT ompdot_complex_double zdotc_(int const* n, void const* x, int const* incx, void const* y, int const* incy);
+
+/**\fn        zdotu_
+ * \brief     Dot product of the complex double vectors \p x and \p y of \p n elements with
+ *            the increments \p incx and \p incy (Fortran interface)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector (interleaved real and imaginary parts)
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector (interleaved real and imaginary parts)
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+OMPDOT_EXPORT ompdot_complex_double zdotu_(int const* n, void const* x, int const* incx, void const* y, int const* incy);
+
+/**\fn        cblas_ddot
+ * \brief     Dot product of the double vectors \p x and \p y of \p n elements with the
+ *            increments \p incx and \p incy (C interface)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+OMPDOT_EXPORT double cblas_ddot(int const n, double const* x, int const incx, double const* y, int const incy);
+
+/**\fn        cblas_sdot
+ * \brief     Dot product of the float vectors \p x and \p y of \p n elements with the
+ *            increments \p incx and \p incy (C interface)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+OMPDOT_EXPORT float cblas_sdot(int const n, float const* x, int const incx, float const* y, int const incy);
+
+/**\fn         cblas_zdotc_sub
+ * \brief      Dot product of the conjugated complex double vector \p x and the vector \p y
+ *             of \p n elements with the increments \p incx and \p incy (C interface)
+ *
+ * \param[in]  n      number of elements
+ * \param[in]  x      the first vector (interleaved real and imaginary parts)
+ * \param[in]  incx   increment between two elements of \p x
+ * \param[in]  y      the second vector (interleaved real and imaginary parts)
+ * \param[in]  incy   increment between two elements of \p y
+ * \param[out] dotc   the dot product (real and imaginary part)
+*/
+OMPDOT_EXPORT void cblas_zdotc_sub(int const n, void const* x, int const incx, void const* y, int const incy, void* dotc);
+
+/**\fn         cblas_zdotu_sub
+ * \brief      Dot product of the complex double vectors \p x and \p y of \p n elements
+ *             with the increments \p incx and \p incy (C interface)
+ *
+ * \param[in]  n      number of elements
+ * \param[in]  x      the first vector (interleaved real and imaginary parts)
+ * \param[in]  incx   increment between two elements of \p x
+ * \param[in]  y      the second vector (interleaved real and imaginary parts)
+ * \param[in]  incy   increment between two elements of \p y
+ * \param[out] dotu   the dot product (real and imaginary part)
+*/
+OMPDOT_EXPORT void cblas_zdotu_sub(int const n, void const* x, int const incx, void const* y, int const incy, void* dotu);
+
+/**\fn        ompdot_set_num_threads
+ * \brief     Set the number of threads of the library (like openblas_set_num_threads)
+ *
+ * \param[in] threads   number of threads, the OpenMP default if not positive
+*/
+OMPDOT_EXPORT void ompdot_set_num_threads(int const threads);
+
+/**\fn        ompdot_get_num_threads
+ * \brief     Number of threads of the library
+ *
+ * \return    The number of threads set, 0 for the OpenMP default
+*/
+OMPDOT_EXPORT int ompdot_get_num_threads(void);
+
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif // BLAS_H_INCLUDED
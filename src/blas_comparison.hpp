@@ -0,0 +1,235 @@
+#ifndef BLAS_COMPARISON_H_INCLUDED
+#define BLAS_COMPARISON_H_INCLUDED
+
+/**
+ * \file     blas_comparison.hpp
+ * \mainpage Benchmark of the shared library libompdot.so (see blas.hpp) against the BLAS
+ *           libraries installed on the host: every library is loaded at runtime with
+ *           dlopen and its symbols ddot_, sdot_ and zdotc_ are called exactly like an
+ *           application linked against it would (Fortran interface), libraries that are
+ *           not installed or lack a symbol are skipped. The library libompdot.so is
+ *           expected next to the executable (make lib) and is the reference of the
+ *           speed-up and the deviation. The increments 1 and 2 are benchmarked.
+*/
+
+
+#include <dlfcn.h>
+#include <link.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "random.hpp"
+
+
+/**\struct BlasSettings
+ * \brief  Settings of the benchmark of the BLAS libraries
+*/
+struct BlasSettings
+{
+    size_t                   length     = 2097152;   ///< number of elements per vector
+    std::vector<int>         increments = {1, 2};    ///< increments between two elements of both vectors
+    std::vector<std::string> libraries  = {"libblas.so.3", "libopenblas.so.0", "libmkl_rt.so", "libblis.so.4"};  ///< system BLAS libraries tried
+    bool                     csv        = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\struct BlasLibrary
+ * \brief  A BLAS library loaded at runtime and its dot products (nullptr if it lacks them)
+*/
+struct BlasLibrary
+{
+    std::string name;   ///< name of the library
+    std::string path;   ///< path of the loaded library
+    double               (*ddot)(int const*, double const*, int const*, double const*, int const*) = nullptr;  ///< ddot_
+    float                (*sdot)(int const*, float const*, int const*, float const*, int const*)   = nullptr;  ///< sdot_
+    std::complex<double> (*zdotc)(int const*, void const*, int const*, void const*, int const*)    = nullptr;  ///< zdotc_
+};
+
+
+/**\struct BlasRow
+ * \brief  Result of a single library, routine and increment of the benchmark of the BLAS libraries
+*/
+struct BlasRow
+{
+    std::string     name;         ///< name of the library and the routine
+    int             increment;    ///< increment between two elements
+    BenchmarkResult res;          ///< statistics and throughput of the routine
+    double          speedup;      ///< speed-up over libompdot.so
+    double          deviation;    ///< relative deviation from the result of libompdot.so
+};
+
+
+/**\fn         print_blas_row
+ * \brief      Print a row of the benchmark of the BLAS libraries (or the header if \p row
+ *             is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_blas_row(BlasRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "routine,increment,median_s,min_s,mad_s,gbs,gflops,speedup,rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " routine" << std::right << std::setw(6) << "inc"
+            << std::setw(14) << "median[us]" << std::setw(10) << "MAD%" << std::setw(10) << "GB/s"
+            << std::setw(10) << "GFLOP/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->increment << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.gbs << "," << row->res.gflops << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(6) << row->increment
+        << std::setprecision(3) << std::setw(14) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setw(10) << row->res.gbs << std::setw(10) << row->res.gflops
+        << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         load_blas_library
+ * \brief      Load the BLAS library \p name (file name or path) at runtime and look up
+ *             its dot products
+ *
+ * \param[in]  name      file name or path of the library
+ * \param[out] library   the library and its dot products
+ * \return     Boolean argument signaling if the library could be loaded
+*/
+inline bool load_blas_library(std::string const &name, BlasLibrary &library)
+{
+    // the libraries are loaded locally so that their identical symbols do not interfere
+    void* const handle = dlopen(name.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        return false;
+    }
+
+    struct link_map* map = nullptr;
+    library.name  = std::filesystem::path(name).filename().string();
+    library.path  = ((dlinfo(handle, RTLD_DI_LINKMAP, &map) == 0) && (map != nullptr)) ? map->l_name : name;
+    library.ddot  = reinterpret_cast<decltype(library.ddot)>(dlsym(handle, "ddot_"));
+    library.sdot  = reinterpret_cast<decltype(library.sdot)>(dlsym(handle, "sdot_"));
+    library.zdotc = reinterpret_cast<decltype(library.zdotc)>(dlsym(handle, "zdotc_"));
+    return true;
+}
+
+
+/**\fn         run_blas_comparison
+ * \brief      Benchmark the dot products of libompdot.so against the BLAS libraries
+ *             installed on the host for different increments
+ *
+ * \param[in]  blas       settings of the benchmark of the BLAS libraries
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_blas_comparison(BlasSettings const &blas, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    std::error_code           error;
+    std::filesystem::path const executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    std::vector<BlasLibrary>  libraries;
+
+    std::vector<std::string> names = {(error) ? std::string("libompdot.so") : (executable.parent_path()/"libompdot.so").string()};
+    names.insert(names.end(), blas.libraries.begin(), blas.libraries.end());
+    for (std::string const &name: names)
+    {
+        BlasLibrary library;
+        bool const  loaded = load_blas_library(name, library);
+        if (loaded == true)
+        {
+            libraries.push_back(library);
+        }
+        if (blas.csv == false)
+        {
+            out << "BLAS library " << std::left << std::setw(20) << std::filesystem::path(name).filename().string()
+                << std::right << ((loaded == true) ? library.path : std::string("(not found)")) << std::endl;
+        }
+    }
+    if ((libraries.empty() == true) || (libraries.front().name != "libompdot.so"))
+    {
+        std::cerr << "Error: libompdot.so not found next to the executable (make lib)" << std::endl;
+        return;
+    }
+
+    if (blas.csv == false)
+    {
+        out << "BLAS DOT PRODUCTS (" << blas.length << " elements, Fortran interface)" << std::endl;
+    }
+    print_blas_row(nullptr, out, blas.csv);
+
+    int const    n       = static_cast<int>(blas.length);
+    int const    max_inc = *std::max_element(blas.increments.begin(), blas.increments.end());
+    size_t const size    = 2*blas.length*static_cast<size_t>(std::abs(max_inc));
+    AlignedBuffer<double> x(size), y(size);
+    AlignedBuffer<float>  x_float(size), y_float(size);
+    random_fill(x.data(), size, 0);
+    random_fill(y.data(), size, 1);
+    std::copy(x.data(), x.data() + size, x_float.data());
+    std::copy(y.data(), y.data() + size, y_float.data());
+
+    for (int const inc: blas.increments)
+    {
+        // routine of all libraries: libompdot.so first as the reference
+        auto const routine = [&](std::string const &name, auto const member, auto const &call, double const bytes, double const flops)
+        {
+            BenchmarkResult      reference;
+            std::complex<double> expected;
+            for (BlasLibrary const &library: libraries)
+            {
+                auto const f = library.*member;
+                if (f == nullptr)
+                {
+                    continue;
+                }
+
+                std::complex<double> value;
+                BenchmarkResult const res = benchmark_callable([&]()
+                {
+                    value = call(f);
+                    return value.real();
+                }, blas.length, bytes, flops, settings);
+
+                bool const first = (&library == &libraries.front());
+                reference = (first == true) ? res : reference;
+                expected  = (first == true) ? value : expected;
+
+                BlasRow const row = {library.name + " " + name, inc, res, reference.stats.median/res.stats.median,
+                                     std::abs(value - expected)/std::abs(expected)};
+                print_blas_row(&row, out, blas.csv);
+            }
+        };
+
+        routine("ddot_", &BlasLibrary::ddot, [&](auto const f)
+        {
+            return std::complex<double>(f(&n, x.data(), &inc, y.data(), &inc), 0.0);
+        }, 2.0*sizeof(double), 2.0);
+        routine("sdot_", &BlasLibrary::sdot, [&](auto const f)
+        {
+            return std::complex<double>(f(&n, x_float.data(), &inc, y_float.data(), &inc), 0.0);
+        }, 2.0*sizeof(float), 2.0);
+        routine("zdotc_", &BlasLibrary::zdotc, [&](auto const f)
+        {
+            return f(&n, x.data(), &inc, y.data(), &inc);
+        }, 4.0*sizeof(double), 8.0);
+    }
+}
+
+#endif // BLAS_COMPARISON_H_INCLUDED
@@ -0,0 +1,425 @@
+#ifndef CLI_H_INCLUDED
+#define CLI_H_INCLUDED
+
+/**
+ * \file     cli.hpp
+ * \mainpage Parser for the command line options of the benchmark so that the
+ *           vector length, the number of iterations and threads, the kernels
+ *           and the data type can be chosen without recompiling.
+*/
+
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "affinity.hpp"
+#include "align.hpp"
+#include "numa.hpp"
+#include "random.hpp"
+
+
+/**\enum  Mode
+ * \brief What the program should do
+*/
+enum class Mode
+{
+    benchmark,    ///< benchmark the kernels for a single vector length
+    sweep,        ///< sweep the vector length across the cache hierarchy
+    scaling,      ///< sweep the number of threads for the placement policies
+    tune,         ///< benchmark the instantiation matrix of the policy-based kernel
+    compressed,   ///< benchmark the compressed operand formats
+    reproducible, ///< benchmark the deterministic reduction and check it for 1..N threads
+    batch,        ///< benchmark the batched kernels against a loop of single-pair kernels
+    gemv,         ///< benchmark the one-vs-many dot products for matrices of different shapes
+    topk,         ///< benchmark the maximum inner product search for collections of increasing size
+    gemm,         ///< benchmark the cache-blocked matrix product against the peak performance
+    soa,          ///< benchmark the dot products of many pairs of tiny vectors stored as structure of arrays
+    fixed,        ///< benchmark the dot products whose length is known at compile time
+    sparse,       ///< benchmark the sparse-dense dot products for increasing densities
+    intersect,    ///< benchmark the sparse-sparse dot products for increasing ratios of the numbers of nonzeros
+    complex,      ///< benchmark the dot products of complex vectors for different increments
+    blas,         ///< benchmark the shared library with the BLAS interface against the system BLAS
+    fused,        ///< benchmark the cosine similarity in a single pass against three dot products
+    version,      ///< print the disclaimer and the compiler settings
+    help          ///< print the usage
+};
+
+
+/**\struct CommandLine
+ * \brief  Settings given on the command line
+*/
+struct CommandLine
+{
+    Mode                       mode        = Mode::benchmark;
+    size_t                     length      = 0;                        ///< number of elements per vector, 0 for the default of the mode
+    size_t                     iterations  = 0;                        ///< number of calls per sample, 0 to scale with the length
+    size_t                     repetitions = 15;                       ///< number of timed samples
+    size_t                     warmup      = 2;                        ///< number of untimed samples
+    size_t                     threads     = 1;                        ///< number of OpenMP threads (maximum for the thread scaling)
+    std::vector<std::string>   kernels;                                ///< identifiers of the kernels to be benchmarked, all if empty
+    std::string                dtype       = "double";                 ///< element type of the vectors
+    std::string                output;                                 ///< file the results are written to, console if empty
+    bool                       csv         = false;                    ///< write comma-separated values instead of a table
+    std::vector<Placement>     policies;                               ///< placement policies for the thread scaling, all if empty
+    HugePages                  huge_pages  = HugePages::transparent;   ///< backing of large buffers by huge pages
+    std::vector<NumaPlacement> numa        = {NumaPlacement::local};   ///< NUMA placements of the operands to be compared
+    std::uint64_t              seed        = DEFAULT_SEED;             ///< seed of the random operands
+};
+
+
+/**\struct ModeFlag
+ * \brief  Command line flag selecting a mode whose only optional value is "csv"
+*/
+struct ModeFlag
+{
+    char const* flag;    ///< the command line flag
+    Mode        mode;    ///< the mode selected by the flag
+    bool        dtype;   ///< the mode benchmarks the element type of --dtype, its element types are fixed otherwise
+};
+
+
+/// flags of the modes that accept "--flag" and "--flag=csv"
+inline constexpr ModeFlag MODE_FLAGS[] =
+{
+    {"--sweep",        Mode::sweep,         true },
+    {"--tune",         Mode::tune,          false},
+    {"--compressed",   Mode::compressed,    false},
+    {"--reproducible", Mode::reproducible,  false},
+    {"--batch",        Mode::batch,         false},
+    {"--gemv",         Mode::gemv,          false},
+    {"--topk",         Mode::topk,          false},
+    {"--gemm",         Mode::gemm,          false},
+    {"--soa",          Mode::soa,           false},
+    {"--fixed",        Mode::fixed,         false},
+    {"--sparse",       Mode::sparse,        false},
+    {"--intersect",    Mode::intersect,     false},
+    {"--complex",      Mode::complex,       false},
+    {"--blas",         Mode::blas,          false},
+    {"--fused",        Mode::fused,         false}
+};
+
+
+/**\fn        print_usage
+ * \brief     Print the available command line options
+ *
+ * \param[in] program   name of the executable
+*/
+inline void print_usage(char const* const program)
+{
+    std::cout << "Usage: " << program << " [mode] [options]"                                                     << std::endl
+              << "Modes:"                                                                                        << std::endl
+              << "  (none)                benchmark the kernels for a single vector length"                      << std::endl
+              << "  --sweep[=csv]         sweep the vector length across the cache hierarchy"                    << std::endl
+              << "  --scaling[=POLICY]    sweep the number of threads (POLICY: none, compact, scatter, cores, smt, csv)" << std::endl
+              << "  --tune[=csv]          benchmark unroll, accumulators and prefetching of the SIMD kernels"    << std::endl
+              << "  --compressed[=csv]    benchmark operands stored as fp16, bf16, q8 and q4 (error vs. double)" << std::endl
+              << "  --reproducible[=csv]  overhead of the thread-count independent reduction and check for 1..N threads" << std::endl
+              << "  --batch[=csv]         many independent pairs in a single parallel region vs. a loop of calls" << std::endl
+              << "                        (--length gives the number of pairs of 1e3 to 5e4 elements each,"     << std::endl
+              << "                        about 0.6 MB of memory per pair)"                                      << std::endl
+              << "  --gemv[=csv]          one vector times the rows of matrices of different shapes vs. a dot per row" << std::endl
+              << "                        (--length gives the number of elements of the matrices)"               << std::endl
+              << "  --topk[=csv]          top-k maximum inner product search with norm pruning vs. exhaustive search" << std::endl
+              << "                        (--length gives the number of vectors of the largest collection)"      << std::endl
+              << "  --gemm[=csv]          cache-blocked DGEMM and SGEMM for square matrices in GFLOP/s and % of peak" << std::endl
+              << "                        (--length gives the number of rows of the largest matrices)"           << std::endl
+              << "  --soa[=csv]           pairs of vectors of 3, 4, 8 and 16 elements as structure of arrays vs. a loop" << std::endl
+              << "                        (--length gives the number of pairs)"                                  << std::endl
+              << "  --fixed[=csv]         std::array and static-extent std::span of 3 to 1048576 elements vs. a loop" << std::endl
+              << "  --sparse[=csv]        sparse times dense vector for densities of 0.1% to 50% vs. the dense kernel" << std::endl
+              << "                        (--length gives the number of elements of the dense vectors)"          << std::endl
+              << "  --intersect[=csv]     sparse times sparse vector for nonzero ratios of 1 to 1024 vs. a scalar merge" << std::endl
+              << "                        (--length gives the number of nonzeros of the larger vector)"          << std::endl
+              << "  --complex[=csv]       zdotu/zdotc/cdotu/cdotc for increments 1, -1, 2, 4 vs. deinterleaving" << std::endl
+              << "                        (--length gives the number of complex elements)"                       << std::endl
+              << "  --blas[=csv]          ddot_/sdot_/zdotc_ of bin/libompdot.so (make lib) vs. the system BLAS"  << std::endl
+              << "                        (--length gives the number of elements)"                               << std::endl
+              << "  --fused[=csv]         cosine similarity in a single pass for 4096 to 16777216 elements vs. 3 dots" << std::endl
+              << "                        (--length gives the only number of elements)"                          << std::endl
+              << "  --version, --v        print disclaimer and compiler settings"                                << std::endl
+              << "  --help, -h            print this message"                                                    << std::endl
+              << "Options:"                                                                                      << std::endl
+              << "  --length N            number of elements per vector (e.g. 1e8)"                              << std::endl
+              << "  --iters N             number of calls per timed sample (default: 1e8/length)"                << std::endl
+              << "  --reps N              number of timed samples"                                               << std::endl
+              << "  --warmup N            number of untimed warm-up samples"                                     << std::endl
+              << "  --threads N           number of OpenMP threads (maximum for --scaling and --reproducible)"   << std::endl
+              << "  --kernels A,B,...     kernels to be benchmarked (e.g. omp_simd,avx2,avx512)"                 << std::endl
+              << "  --dtype T             element type: double, float, int16 or int8 (unsigned x, signed y)"      << std::endl
+              << "                        (only the benchmark of a single length, --sweep and --scaling)"        << std::endl
+              << "  --hugepages P         huge pages for large buffers: none, thp (default) or explicit"         << std::endl
+              << "  --numa P,...          NUMA placement of the operands: local (default), interleave, single"   << std::endl
+              << "                        or compare (all three, only for the benchmark of a single length)"     << std::endl
+              << "  --seed S              seed of the random operands (decimal or 0x-prefixed hexadecimal)"      << std::endl
+              << "  --output FILE         write the results to FILE instead of the console"                      << std::endl
+              << "  --csv                 write comma-separated values instead of a table"                       << std::endl;
+}
+
+
+/**\fn         parse_count
+ * \brief      Parse a positive integer given as \p str, also accepting floating point
+ *             notation such as "1e8"
+ *
+ * \param[in]  str          the string to be parsed
+ * \param[out] value        the parsed number
+ * \param[in]  allow_zero   accept zero as well
+ * \return     Boolean flag signalling if the string is a positive integer
+*/
+inline bool parse_count(std::string const &str, size_t &value, bool const allow_zero = false)
+{
+    char*        end    = nullptr;
+    double const parsed = std::strtod(str.c_str(), &end);
+    double const lowest = (allow_zero == true) ? 0.0 : 1.0;
+    // range check before the conversion (a NaN fails the comparisons): a double that does
+    // not fit into size_t (e.g. "1e30" or "inf") must not be cast at all
+    if ((str.empty() == true) || (*end != '\0') || !((parsed >= lowest) && (parsed < 0x1p64)))
+    {
+        return false;
+    }
+    // the conversion truncates, so a count with a fraction is smaller after it
+    if (static_cast<double>(static_cast<size_t>(parsed)) < parsed)
+    {
+        return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+
+/**\fn        split_list
+ * \brief     Split a comma-separated list \p str into its entries
+ *
+ * \param[in] str   the comma-separated list
+ * \return    Vector of the non-empty entries
+*/
+inline std::vector<std::string> split_list(std::string const &str)
+{
+    std::vector<std::string> entries;
+    std::stringstream        stream(str);
+    std::string              entry;
+    while (std::getline(stream, entry, ','))
+    {
+        if (entry.empty() == false)
+        {
+            entries.push_back(entry);
+        }
+    }
+    return entries;
+}
+
+
+/**\fn         parse_command_line
+ * \brief      Parse the command line arguments \p argv into \p cl. Options taking a value
+ *             accept both "--option value" and "--option=value".
+ *
+ * \param[in]  argc   number of command line arguments
+ * \param[in]  argv   the command line arguments
+ * \param[out] cl     the parsed settings
+ * \return     Boolean flag signalling if all arguments could be parsed
+*/
+inline bool parse_command_line(int const argc, char** const argv, CommandLine &cl)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string       arg = argv[i];
+        std::string       value;
+        bool              has_value = false;
+        size_t const      eq        = arg.find('=');
+        if (eq != std::string::npos)
+        {
+            value     = arg.substr(eq + 1);
+            arg       = arg.substr(0, eq);
+            has_value = true;
+        }
+
+        // fetch the value of an option either from after '=' or from the next argument
+        auto const next_value = [&]() -> bool
+        {
+            if (has_value == false)
+            {
+                if (i + 1 >= argc)
+                {
+                    std::cerr << "Option " << arg << " requires a value" << std::endl;
+                    return false;
+                }
+                value = argv[++i];
+            }
+            return true;
+        };
+        auto const count = [&](size_t &target, bool const allow_zero = false) -> bool
+        {
+            if ((next_value() == false) || (parse_count(value, target, allow_zero) == false))
+            {
+                std::cerr << "Option " << arg << " requires a " << (allow_zero ? "non-negative" : "positive")
+                          << " integer, got '" << value << "'" << std::endl;
+                return false;
+            }
+            return true;
+        };
+        ModeFlag const* const mode_flag = std::find_if(std::begin(MODE_FLAGS), std::end(MODE_FLAGS),
+                                                       [&](ModeFlag const &m) { return arg == m.flag; });
+
+        if ((arg == "--version") || (arg == "--v"))
+        {
+            cl.mode = Mode::version;
+        }
+        else if ((arg == "--help") || (arg == "-h"))
+        {
+            cl.mode = Mode::help;
+        }
+        else if (mode_flag != std::end(MODE_FLAGS))
+        {
+            cl.mode = mode_flag->mode;
+            if (has_value && (value == "csv"))
+            {
+                cl.csv = true;
+            }
+            else if (has_value)
+            {
+                std::cerr << "Unknown value '" << value << "' of " << arg << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--scaling")
+        {
+            cl.mode = Mode::scaling;
+            Placement policy = Placement::none;
+            if (has_value && (value == "csv"))
+            {
+                cl.csv = true;
+            }
+            else if (has_value && (placement_from_string(value, policy) == true))
+            {
+                cl.policies.push_back(policy);
+            }
+            else if (has_value)
+            {
+                std::cerr << "Unknown placement '" << value << "' (none, compact, scatter, cores, smt)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--length")
+        {
+            if (count(cl.length) == false) return false;
+        }
+        else if (arg == "--iters")
+        {
+            if (count(cl.iterations) == false) return false;
+        }
+        else if (arg == "--reps")
+        {
+            if (count(cl.repetitions) == false) return false;
+        }
+        else if (arg == "--warmup")
+        {
+            if (count(cl.warmup, true) == false) return false;
+        }
+        else if (arg == "--threads")
+        {
+            if (count(cl.threads) == false) return false;
+        }
+        else if (arg == "--kernels")
+        {
+            if (next_value() == false) return false;
+            cl.kernels = split_list(value);
+        }
+        else if (arg == "--dtype")
+        {
+            if (next_value() == false) return false;
+            if ((value != "double") && (value != "float") && (value != "int16") && (value != "int8"))
+            {
+                std::cerr << "Unknown data type '" << value << "' (double, float, int16, int8)" << std::endl;
+                return false;
+            }
+            cl.dtype = value;
+        }
+        else if (arg == "--hugepages")
+        {
+            if (next_value() == false) return false;
+            if (huge_pages_from_string(value, cl.huge_pages) == false)
+            {
+                std::cerr << "Unknown huge page policy '" << value << "' (none, thp, explicit)" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--numa")
+        {
+            if (next_value() == false) return false;
+            cl.numa.clear();
+            for (std::string const &entry: split_list(value))
+            {
+                NumaPlacement placement = NumaPlacement::local;
+                if (entry == "compare")
+                {
+                    cl.numa.insert(cl.numa.end(), {NumaPlacement::local, NumaPlacement::interleave, NumaPlacement::single});
+                }
+                else if (numa_placement_from_string(entry, placement) == true)
+                {
+                    cl.numa.push_back(placement);
+                }
+                else
+                {
+                    std::cerr << "Unknown NUMA placement '" << entry << "' (local, interleave, single, compare)" << std::endl;
+                    return false;
+                }
+            }
+            if (cl.numa.empty() == true)
+            {
+                cl.numa.push_back(NumaPlacement::local);
+            }
+        }
+        else if (arg == "--seed")
+        {
+            if (next_value() == false) return false;
+            // explicit base: with base 0 a leading zero would select octal
+            bool const        hex    = (value.rfind("0x", 0) == 0) || (value.rfind("0X", 0) == 0);
+            char const* const digits = value.c_str() + (hex ? 2 : 0);
+            char*             end    = nullptr;
+            errno                    = 0;
+            cl.seed                  = std::strtoull(digits, &end, hex ? 16 : 10);
+            // strtoull would also skip white space and accept a sign
+            bool const leading = (hex == true) ? (std::isxdigit(static_cast<unsigned char>(digits[0])) != 0)
+                                               : (std::isdigit(static_cast<unsigned char>(digits[0])) != 0);
+            if ((leading == false) || (*end != '\0') || (errno != 0))
+            {
+                std::cerr << "Option " << arg << " requires an unsigned 64 bit integer, got '" << value << "'" << std::endl;
+                return false;
+            }
+        }
+        else if (arg == "--output")
+        {
+            if (next_value() == false) return false;
+            cl.output = value;
+        }
+        else if (arg == "--csv")
+        {
+            cl.csv = true;
+        }
+        else
+        {
+            std::cerr << "Unknown option '" << argv[i] << "', see --help" << std::endl;
+            return false;
+        }
+    }
+
+    // modes of the table that do not benchmark the element type of --dtype
+    ModeFlag const* const selected = std::find_if(std::begin(MODE_FLAGS), std::end(MODE_FLAGS),
+                                                  [&](ModeFlag const &m) { return cl.mode == m.mode; });
+    if ((selected != std::end(MODE_FLAGS)) && (selected->dtype == false) && (cl.dtype != "double"))
+    {
+        std::cerr << "Option --dtype " << cl.dtype << " is not supported by " << selected->flag
+                  << ", its element types are fixed" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+#endif // CLI_H_INCLUDED
@@ -0,0 +1,243 @@
+#ifndef COMPENSATED_H_INCLUDED
+#define COMPENSATED_H_INCLUDED
+
+/**
+ * \file     compensated.hpp
+ * \brief    accurate dot product by means of error-free transformations
+ * \mainpage Dot product in about twice the working precision (Dot2 of Ogita,
+ *           Rump and Oishi, "Accurate sum and dot product", 2005): every product
+ *           is split into its rounded value and its exact rounding error with a
+ *           fused multiply-subtract (TwoProduct) and added to the running sum with
+ *           TwoSum, the errors are accumulated separately and added at the very
+ *           end. The result is as accurate as if computed in quadruple precision
+ *           and then rounded, unless the dot product is extremely ill-conditioned
+ *           (condition number beyond 1e16). Every thread accumulates sum and error
+ *           in its own registers, the partial results of the threads are combined
+ *           with TwoSum as well so that nothing is lost in the reduction.
+ * \warning  Must not be compiled with -ffast-math as it relies on the rounding of
+ *           every single operation!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn         two_sum
+ * \brief      Error-free transformation of the sum of \p a and \p b (Knuth): \p s is the
+ *             rounded sum and \p e its rounding error, so that a + b = s + e exactly
+ *
+ * \param[in]  a   first summand
+ * \param[in]  b   second summand
+ * \param[out] s   the rounded sum
+ * \param[out] e   the rounding error
+*/
+template <typename T = double>
+inline void two_sum(T const a, T const b, T &s, T &e)
+{
+    s = a + b;
+    T const z = s - a;
+    e = (a - (s - z)) + (b - z);
+}
+
+
+/**\fn        combine_partials
+ * \brief     Combine the partial sums \p sums and the accumulated errors \p errors of
+ *            several threads to the final result: the sums are added with TwoSum and all
+ *            errors are added at the end
+ *
+ * \param[in] sums     the partial sums
+ * \param[in] errors   the accumulated errors of the partial sums
+ * \return    The compensated result
+*/
+inline double combine_partials(KernelVector<double> const &sums, KernelVector<double> const &errors)
+{
+    assert(sums.size() == errors.size());
+
+    double s = 0.0;
+    double c = 0.0;
+    for (size_t t = 0; t < sums.size(); ++t)
+    {
+        double e = 0.0;
+        two_sum(s, sums[t], s, e);
+        c += e + errors[t];
+    }
+    return s + c;
+}
+
+
+/**\fn        scalar_omp_dot2
+ * \brief     Calculate the dot product of two vectors \p x and \p y of any length and
+ *            alignment in about twice the working precision (Dot2) without any
+ *            vectorisation (only OpenMP parallel). Serves as reference and fallback for
+ *            hosts without SIMD support (std::fma may be emulated in software there).
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double scalar_omp_dot2(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const N = x.size();
+
+    KernelVector<double> sums(omp_get_max_threads(), 0.0);
+    KernelVector<double> errors(sums.size(), 0.0);
+
+    #pragma omp parallel shared(x, y, sums, errors)
+    {
+        double s = 0.0;
+        double c = 0.0;
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < N; ++i)
+        {
+            double const p = x[i]*y[i];
+            double const q = std::fma(x[i], y[i], -p);
+            double       e = 0.0;
+            two_sum(s, p, s, e);
+            c += e + q;
+        }
+
+        sums[omp_get_thread_num()]   = s;
+        errors[omp_get_thread_num()] = c;
+    }
+
+    return combine_partials(sums, errors);
+}
+
+
+/**\fn        scalar_omp_dot2_span
+ * \brief     Calculate the dot product of two aligned and padded vectors \p x and \p y
+ *            in about twice the working precision (see scalar_omp_dot2), container:
+ *            C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double scalar_omp_dot2_span(std::span<double> const &x, std::span<double> const &y)
+{
+    return scalar_omp_dot2(std::span<double const>(x.data(), x.size()), std::span<double const>(y.data(), y.size()));
+}
+
+
+/**\fn        simd_omp_dot2
+ * \brief     Calculate the dot product of the \p N elements of \p x and \p y in about
+ *            twice the working precision (Dot2) with the instruction set \p Isa:
+ *            TwoProduct and TwoSum are applied lane-wise to \p Accumulators
+ *            independent pairs of sum and error registers, which are combined with
+ *            TwoSum per thread and across threads. The tail is loaded with masks, so
+ *            any length and alignment is supported (aligned loads for \p Aligned).
+ *
+ * \param[in] x   pointer to the first element of x
+ * \param[in] y   pointer to the first element of y
+ * \param[in] N   number of elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Accumulators, bool Aligned>
+inline double simd_omp_dot2(double const* const x, double const* const y, size_t const N)
+{
+    static_assert(Accumulators > 0, "At least a single accumulator is required");
+
+    typedef typename Isa::reg reg;
+    constexpr size_t width = Isa::width;
+    constexpr size_t step  = Accumulators*width;
+
+    size_t const body = N/step*step;
+
+    KernelVector<double> sums(omp_get_max_threads(), 0.0);
+    KernelVector<double> errors(sums.size(), 0.0);
+
+    #pragma omp parallel shared(sums, errors)
+    {
+        reg _s[Accumulators];
+        reg _c[Accumulators];
+        for (size_t a = 0; a < Accumulators; ++a)
+        {
+            _s[a] = Isa::zero();
+            _c[a] = Isa::zero();
+        }
+
+        // TwoProduct and TwoSum of a register, the errors of both are accumulated in _c
+        auto const accumulate = [](reg const _x, reg const _y, reg &_sum, reg &_err)
+        {
+            reg const _p = Isa::mul(_x, _y);
+            reg const _q = Isa::fmsub(_x, _y, _p);
+            reg const _t = Isa::add(_sum, _p);
+            reg const _z = Isa::sub(_t, _sum);
+            reg const _e = Isa::add(Isa::sub(_sum, Isa::sub(_t, _z)), Isa::sub(_p, _z));
+            _sum = _t;
+            _err = Isa::add(_err, Isa::add(_e, _q));
+        };
+
+        #pragma omp for schedule(static) nowait
+        for (size_t i = 0; i < body; i += step)
+        {
+            #pragma GCC unroll 16
+            for (size_t a = 0; a < Accumulators; ++a)
+            {
+                reg const _x = (Aligned == true) ? Isa::load(x + i + a*width) : Isa::loadu(x + i + a*width);
+                reg const _y = (Aligned == true) ? Isa::load(y + i + a*width) : Isa::loadu(y + i + a*width);
+                accumulate(_x, _y, _s[a], _c[a]);
+            }
+        }
+
+        // remaining elements that do not fill an unrolled iteration (masked loads)
+        #pragma omp for schedule(static) nowait
+        for (size_t i = body; i < N; i += width)
+        {
+            size_t const m = std::min(N - i, width);
+            accumulate(Isa::load_partial(x + i, m), Isa::load_partial(y + i, m), _s[0], _c[0]);
+        }
+
+        // combine the lanes of all accumulators without losing their rounding errors
+        double s = 0.0;
+        double c = 0.0;
+        for (size_t a = 0; a < Accumulators; ++a)
+        {
+            double sum_lanes[width];
+            double err_lanes[width];
+            std::memcpy(sum_lanes, &_s[a], sizeof(reg));
+            std::memcpy(err_lanes, &_c[a], sizeof(reg));
+            for (size_t l = 0; l < width; ++l)
+            {
+                double e = 0.0;
+                two_sum(s, sum_lanes[l], s, e);
+                c += e + err_lanes[l];
+            }
+        }
+
+        sums[omp_get_thread_num()]   = s;
+        errors[omp_get_thread_num()] = c;
+    }
+
+    return combine_partials(sums, errors);
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // COMPENSATED_H_INCLUDED
@@ -0,0 +1,261 @@
+#ifndef COMPLEX_H_INCLUDED
+#define COMPLEX_H_INCLUDED
+
+/**
+ * \file     complex.hpp
+ * \brief    dot products of complex vectors with increments like the BLAS
+ * \mainpage Unconjugated (zdotu, cdotu) and conjugated (zdotc, cdotc) dot products of
+ *           complex vectors in double and single precision stored interleaved (real and
+ *           imaginary part of every element one after the other) with the increments
+ *           incx and incy between two elements, negative increments traversing the
+ *           vector backwards like the BLAS. The SIMD kernels work on the interleaved
+ *           numbers directly instead of deinterleaving them into separate buffers: a
+ *           register of x is multiplied-added with a register of y as well as with y
+ *           whose real and imaginary parts are swapped by a permute, so that the four
+ *           sums xr*yr, xi*yi, xr*yi and xi*yr accumulate in the even and odd lanes of
+ *           two registers. The signs of conjugation are applied only once after the
+ *           reduction. Strided elements are loaded by gathers or by inserting the
+ *           single complex numbers into a register. The elements are distributed over
+ *           the threads statically.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <cstddef>
+#include <complex>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of pairs of registers per iteration of the SIMD kernels (independent accumulators)
+#define COMPLEX_UNROLL 4
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        combine_complex
+ * \brief     Dot product of two complex vectors from the sums of the products of their
+ *            real and imaginary parts
+ *
+ * \param[in] rr   sum of the products of the real parts of x and y
+ * \param[in] ii   sum of the products of the imaginary parts of x and y
+ * \param[in] ri   sum of the products of the real parts of x and the imaginary parts of y
+ * \param[in] ir   sum of the products of the imaginary parts of x and the real parts of y
+ * \return    The dot product with x conjugated if \p Conjugate
+*/
+template <bool Conjugate, typename T>
+inline std::complex<T> combine_complex(T const rr, T const ii, T const ri, T const ir)
+{
+    return (Conjugate == true) ? std::complex<T>(rr + ii, ri - ir) : std::complex<T>(rr - ii, ri + ir);
+}
+
+
+/**\fn        first_element
+ * \brief     Pointer to the first element of the vector \p x of \p n elements with the
+ *            increment \p inc (the last element in memory for negative increments)
+ *
+ * \param[in] x     pointer to the vector like the BLAS
+ * \param[in] n     number of elements
+ * \param[in] inc   increment between two elements
+ * \return    Pointer to the element with index 0
+*/
+template <typename T>
+inline T const* first_element(T const* const x, size_t const n, std::ptrdiff_t const inc)
+{
+    return (inc < 0) ? x + (1 - static_cast<std::ptrdiff_t>(n))*inc : x;
+}
+
+
+/**\fn        scalar_omp_dot_complex
+ * \brief     Calculate the dot product of the complex vectors \p x and \p y of \p n
+ *            elements with increments without manual vectorisation
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector (conjugated if \p Conjugate)
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+template <typename T, bool Conjugate>
+inline std::complex<T> scalar_omp_dot_complex(size_t const n, std::complex<T> const* x, std::ptrdiff_t const incx,
+                                              std::complex<T> const* y, std::ptrdiff_t const incy)
+{
+    x = first_element(x, n, incx);
+    y = first_element(y, n, incy);
+
+    T rr = 0, ii = 0, ri = 0, ir = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+: rr, ii, ri, ir)
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::complex<T> const a = x[static_cast<std::ptrdiff_t>(i)*incx];
+        std::complex<T> const b = y[static_cast<std::ptrdiff_t>(i)*incy];
+        rr += a.real()*b.real();
+        ii += a.imag()*b.imag();
+        ri += a.real()*b.imag();
+        ir += a.imag()*b.real();
+    }
+
+    return combine_complex<Conjugate>(rr, ii, ri, ir);
+}
+
+
+/**\fn        load_complex
+ * \brief     Load the complex numbers of a register starting at \p p either contiguous
+ *            or with the increment \p inc
+ *
+ * \param[in] p     pointer to the real part of the first number
+ * \param[in] inc   increment between two numbers (only used if \p Strided)
+ * \return    The register of interleaved real and imaginary parts
+*/
+template <typename Isa, bool Strided>
+inline typename Isa::reg load_complex(typename Isa::value_type const* const p, std::ptrdiff_t const inc)
+{
+    if constexpr (Strided == true)
+    {
+        return Isa::load_strided(p, inc);
+    }
+    else
+    {
+        return Isa::loadu(p);
+    }
+}
+
+
+/**\fn        simd_omp_dot_complex_sums
+ * \brief     Calculate the dot product of the complex vectors \p x and \p y whose
+ *            elements 0 are at x and y with the instruction set \p Isa (see complex.hpp)
+ *            loading registers contiguous or with increments, the last elements that do
+ *            not fill a register are added one by one
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector (element 0 at x)
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector (element 0 at y)
+ * \param[in] incy   increment between two elements of \p y
+ * \return    The dot product with x conjugated if \p Conjugate
+*/
+template <typename Isa, bool Conjugate, bool Strided>
+inline std::complex<typename Isa::value_type> simd_omp_dot_complex_sums(size_t const n,
+                                                                        std::complex<typename Isa::value_type> const* const x,
+                                                                        std::ptrdiff_t const incx,
+                                                                        std::complex<typename Isa::value_type> const* const y,
+                                                                        std::ptrdiff_t const incy)
+{
+    typedef typename Isa::value_type T;
+    typedef typename Isa::reg        reg;
+    constexpr size_t width = Isa::width;
+    constexpr size_t pairs = width/2;                 // complex numbers per register
+    constexpr size_t step  = COMPLEX_UNROLL*pairs;
+    size_t const     body  = n/step*step;
+    size_t const     end   = n/pairs*pairs;
+
+    T rr = 0, ii = 0, ri = 0, ir = 0;
+    for (size_t i = end; i < n; ++i)
+    {
+        std::complex<T> const a = x[static_cast<std::ptrdiff_t>(i)*incx];
+        std::complex<T> const b = y[static_cast<std::ptrdiff_t>(i)*incy];
+        rr += a.real()*b.real();
+        ii += a.imag()*b.imag();
+        ri += a.real()*b.imag();
+        ir += a.imag()*b.real();
+    }
+
+    #pragma omp parallel reduction(+: rr, ii, ri, ir)
+    {
+        // lanes of _same: xr*yr and xi*yi, lanes of _cross: xr*yi and xi*yr
+        reg _same[COMPLEX_UNROLL];
+        reg _cross[COMPLEX_UNROLL];
+        for (size_t u = 0; u < COMPLEX_UNROLL; ++u)
+        {
+            _same[u]  = Isa::zero();
+            _cross[u] = Isa::zero();
+        }
+
+        auto const accumulate = [&](size_t const i, size_t const u)
+        {
+            reg const _x = load_complex<Isa,Strided>(reinterpret_cast<T const*>(x + static_cast<std::ptrdiff_t>(i)*incx), incx);
+            reg const _y = load_complex<Isa,Strided>(reinterpret_cast<T const*>(y + static_cast<std::ptrdiff_t>(i)*incy), incy);
+            _same[u]  = Isa::fmadd(_x, _y, _same[u]);
+            _cross[u] = Isa::fmadd(_x, Isa::swap_pairs(_y), _cross[u]);
+        };
+
+        #pragma omp for schedule(static) nowait
+        for (size_t i = 0; i < body; i += step)
+        {
+            #pragma GCC unroll 16
+            for (size_t u = 0; u < COMPLEX_UNROLL; ++u)
+            {
+                accumulate(i + u*pairs, u);
+            }
+        }
+
+        // remaining entire registers that do not fill an unrolled iteration
+        #pragma omp for schedule(static) nowait
+        for (size_t i = body; i < end; i += pairs)
+        {
+            accumulate(i, 0);
+        }
+
+        for (size_t stride = 1; stride < COMPLEX_UNROLL; stride *= 2)
+        {
+            for (size_t u = 0; u + stride < COMPLEX_UNROLL; u += 2*stride)
+            {
+                _same[u]  = Isa::add(_same[u],  _same[u + stride]);
+                _cross[u] = Isa::add(_cross[u], _cross[u + stride]);
+            }
+        }
+
+        alignas(CACHE_LINE) T same[width];
+        alignas(CACHE_LINE) T cross[width];
+        Isa::storeu(same,  _same[0]);
+        Isa::storeu(cross, _cross[0]);
+        for (size_t l = 0; l < width; l += 2)
+        {
+            rr += same[l];
+            ii += same[l + 1];
+            ri += cross[l];
+            ir += cross[l + 1];
+        }
+    }
+
+    return combine_complex<Conjugate>(rr, ii, ri, ir);
+}
+
+
+/**\fn        simd_omp_dot_complex
+ * \brief     Calculate the dot product of the complex vectors \p x and \p y of \p n
+ *            elements with increments with the instruction set \p Isa (see complex.hpp)
+ *
+ * \param[in] n      number of elements
+ * \param[in] x      the first vector (conjugated if \p Conjugate)
+ * \param[in] incx   increment between two elements of \p x
+ * \param[in] y      the second vector
+ * \param[in] incy   increment between two elements of \p y
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, bool Conjugate>
+inline std::complex<typename Isa::value_type> simd_omp_dot_complex(size_t const n,
+                                                                   std::complex<typename Isa::value_type> const* const x,
+                                                                   std::ptrdiff_t const incx,
+                                                                   std::complex<typename Isa::value_type> const* const y,
+                                                                   std::ptrdiff_t const incy)
+{
+    if ((incx == 1) && (incy == 1))
+    {
+        return simd_omp_dot_complex_sums<Isa, Conjugate, false>(n, x, incx, y, incy);
+    }
+    return simd_omp_dot_complex_sums<Isa, Conjugate, true>(n, first_element(x, n, incx), incx,
+                                                           first_element(y, n, incy), incy);
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // COMPLEX_H_INCLUDED
@@ -0,0 +1,195 @@
+#ifndef COMPLEX_STRIDES_H_INCLUDED
+#define COMPLEX_STRIDES_H_INCLUDED
+
+/**
+ * \file     complex_strides.hpp
+ * \mainpage Benchmark of the dot products of complex vectors (see complex.hpp) for the
+ *           increments 1, -1 (backwards), 2 and 4. For every increment deinterleaving both
+ *           vectors into separate buffers of their real and imaginary parts followed by
+ *           four real dot products of the dispatched kernel is the reference. The
+ *           unconjugated and conjugated kernels in double and single precision of every
+ *           instruction set of the host are compared to it. The throughput counts the
+ *           bytes of the elements only, not the gaps between them.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "complex.hpp"
+#include "dispatch.hpp"
+#include "random.hpp"
+
+
+/**\struct ComplexSettings
+ * \brief  Settings of the benchmark of the dot products of complex vectors
+*/
+struct ComplexSettings
+{
+    size_t                      length     = 2097152;         ///< number of complex elements per vector
+    std::vector<std::ptrdiff_t> increments = {1, -1, 2, 4};   ///< increments between two elements of both vectors
+    std::vector<std::string>    ids;                          ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                        csv        = false;           ///< print comma-separated values instead of a table
+};
+
+
+/**\struct ComplexRow
+ * \brief  Result of a single kernel and increment of the benchmark of the dot products of complex vectors
+*/
+struct ComplexRow
+{
+    std::string     name;         ///< name of the kernel
+    std::ptrdiff_t  increment;    ///< increment between two elements
+    BenchmarkResult res;          ///< statistics and throughput of the kernel
+    double          speedup;      ///< speed-up over deinterleaving and real dot products
+    double          deviation;    ///< relative deviation from the result of the reference
+};
+
+
+/**\fn         print_complex_row
+ * \brief      Print a row of the benchmark of the dot products of complex vectors (or the
+ *             header if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_complex_row(ComplexRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,increment,median_s,min_s,mad_s,gbs,gflops,speedup,rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(6) << "inc"
+            << std::setw(14) << "median[us]" << std::setw(10) << "MAD%" << std::setw(10) << "GB/s"
+            << std::setw(10) << "GFLOP/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->increment << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.gbs << "," << row->res.gflops << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(6) << row->increment
+        << std::setprecision(3) << std::setw(14) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setw(10) << row->res.gbs << std::setw(10) << row->res.gflops
+        << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         run_complex_strides
+ * \brief      Benchmark the dot products of complex vectors of the instruction sets
+ *             supported by the host against deinterleaving and real dot products for
+ *             different increments
+ *
+ * \param[in]  complex    settings of the benchmark of the dot products of complex vectors
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_complex_strides(ComplexSettings const &complex, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (complex.csv == false)
+    {
+        out << "DOT PRODUCTS OF COMPLEX VECTORS (" << complex.length << " complex elements, interleaved, "
+            << COMPLEX_UNROLL << " pairs of registers per iteration)" << std::endl;
+    }
+    print_complex_row(nullptr, out, complex.csv);
+
+    size_t const          n = complex.length;
+    KernelTable const&    active = active_kernels();
+    AlignedBuffer<double> xr(n), xi(n), yr(n), yi(n);
+    std::span<double const> const xr_span(xr.data(), n), xi_span(xi.data(), n), yr_span(yr.data(), n), yi_span(yi.data(), n);
+
+    for (std::ptrdiff_t const inc: complex.increments)
+    {
+        // the elements are stored with gaps of |inc| - 1 complex numbers
+        size_t const          stride = static_cast<size_t>(std::abs(inc));
+        AlignedBuffer<double> x(2*n*stride), y(2*n*stride);
+        AlignedBuffer<float>  x_float(2*n*stride), y_float(2*n*stride);
+        random_fill(x.data(), x.size(), 0);
+        random_fill(y.data(), y.size(), 1);
+        std::copy(x.data(), x.data() + x.size(), x_float.data());
+        std::copy(y.data(), y.data() + y.size(), y_float.data());
+
+        auto const zx = reinterpret_cast<std::complex<double> const*>(x.data());
+        auto const zy = reinterpret_cast<std::complex<double> const*>(y.data());
+        auto const cx = reinterpret_cast<std::complex<float> const*>(x_float.data());
+        auto const cy = reinterpret_cast<std::complex<float> const*>(y_float.data());
+
+        // what has to be done without complex kernels: deinterleave both vectors and compute four real dot products
+        std::complex<double> dotu, dotc;
+        BenchmarkResult const reference = benchmark_callable([&]()
+        {
+            std::complex<double> const* const x0 = first_element(zx, n, inc);
+            std::complex<double> const* const y0 = first_element(zy, n, inc);
+            double* const                     pxr = xr.data();
+            double* const                     pxi = xi.data();
+            double* const                     pyr = yr.data();
+            double* const                     pyi = yi.data();
+
+            #pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < n; ++i)
+            {
+                std::complex<double> const a = x0[static_cast<std::ptrdiff_t>(i)*inc];
+                std::complex<double> const b = y0[static_cast<std::ptrdiff_t>(i)*inc];
+                pxr[i] = a.real();
+                pxi[i] = a.imag();
+                pyr[i] = b.real();
+                pyi[i] = b.imag();
+            }
+            double const rr = active.dot_unaligned(xr_span, yr_span);
+            double const ii = active.dot_unaligned(xi_span, yi_span);
+            double const ri = active.dot_unaligned(xr_span, yi_span);
+            double const ir = active.dot_unaligned(xi_span, yr_span);
+            dotu = combine_complex<false>(rr, ii, ri, ir);
+            dotc = combine_complex<true>(rr, ii, ri, ir);
+            return dotc.real();
+        }, n, 4.0*sizeof(double), 8.0, settings);
+        ComplexRow const reference_row = {std::string(active.id) + " deinterleave + dot", inc, reference, 1.0, 0.0};
+        print_complex_row(&reference_row, out, complex.csv);
+
+        auto const row = [&](std::string const &name, std::complex<double> const &expected, auto const &f, double const bytes)
+        {
+            std::complex<double> value;
+            BenchmarkResult const res = benchmark_callable([&]()
+            {
+                value = static_cast<std::complex<double>>(f());
+                return value.real();
+            }, n, bytes, 8.0, settings);
+            ComplexRow const r = {name, inc, res, reference.stats.median/res.stats.median,
+                                  std::abs(value - expected)/std::abs(expected)};
+            print_complex_row(&r, out, complex.csv);
+        };
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((complex.ids.empty() == false) && (std::find(complex.ids.begin(), complex.ids.end(), table->id) == complex.ids.end()))
+            {
+                continue;
+            }
+
+            std::string const id(table->id);
+            row(id + " zdotu", dotu, [&]() { return table->zdot.dotu(n, zx, inc, zy, inc); }, 4.0*sizeof(double));
+            row(id + " zdotc", dotc, [&]() { return table->zdot.dotc(n, zx, inc, zy, inc); }, 4.0*sizeof(double));
+            row(id + " cdotu", dotu, [&]() { return table->cdot.dotu(n, cx, inc, cy, inc); }, 4.0*sizeof(float));
+            row(id + " cdotc", dotc, [&]() { return table->cdot.dotc(n, cx, inc, cy, inc); }, 4.0*sizeof(float));
+        }
+    }
+}
+
+#endif // COMPLEX_STRIDES_H_INCLUDED
@@ -0,0 +1,505 @@
+#ifndef COMPRESSED_H_INCLUDED
+#define COMPRESSED_H_INCLUDED
+
+/**
+ * \file     compressed.hpp
+ * \brief    compressed storage formats of the operands and their dot products
+ * \mainpage Large dot products are bound by the memory bandwidth, so the bytes
+ *           per element can only be reduced by storing the operands in fewer
+ *           bits: half precision (fp16), brain floating point (bf16) as well as
+ *           8 and 4 bit integers with a single scale per block of QUANT_BLOCK
+ *           elements (q8, q4). Every format is stored in blocks of QUANT_BLOCK
+ *           elements so that the kernels can decode entire registers. The
+ *           compressed operand is either multiplied with a double operand
+ *           (accumulated in double) or with a second compressed operand of the
+ *           same format (accumulated in float per block and in double across
+ *           blocks). The SIMD kernels decode the blocks inside the registers by
+ *           means of a codec traits class (see avx2_omp.hpp, avx512_omp.hpp).
+ * \warning  Only finite numbers are supported by the encoders!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of elements sharing a scale (and processed as a unit by the kernels), 32 or 64
+#define QUANT_BLOCK  32
+
+static_assert((QUANT_BLOCK == 32) || (QUANT_BLOCK == 64), "Blocks of 32 or 64 elements are supported");
+
+
+/**\struct BlockFp16
+ * \brief  Block of IEEE 754 half precision numbers
+*/
+struct BlockFp16
+{
+    static constexpr char const* name   = "fp16";
+    static constexpr bool        scaled = false;
+
+    uint16_t h[QUANT_BLOCK];
+};
+
+/**\struct BlockBf16
+ * \brief  Block of brain floating point numbers (upper half of a float)
+*/
+struct BlockBf16
+{
+    static constexpr char const* name   = "bf16";
+    static constexpr bool        scaled = false;
+
+    uint16_t h[QUANT_BLOCK];
+};
+
+/**\struct BlockQ8
+ * \brief  Block of 8 bit integers in [-127,127] with a common scale
+*/
+struct BlockQ8
+{
+    static constexpr char const* name   = "q8";
+    static constexpr bool        scaled = true;
+
+    float  scale;
+    int8_t q[QUANT_BLOCK];
+};
+
+/**\struct BlockQ4
+ * \brief  Block of 4 bit integers in [-8,7] with a common scale: element i is stored
+ *         offset by 8 in the lower nibble of byte i for the first half of the block and
+ *         in the upper nibble of byte i - QUANT_BLOCK/2 for the second half
+*/
+struct BlockQ4
+{
+    static constexpr char const* name   = "q4";
+    static constexpr bool        scaled = true;
+
+    float   scale;
+    uint8_t q[QUANT_BLOCK/2];
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        float_bits
+ * \brief     Bit pattern of the float \p f
+*/
+inline uint32_t float_bits(float const f)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+/**\fn        bits_float
+ * \brief     Float with the bit pattern \p bits
+*/
+inline float bits_float(uint32_t const bits)
+{
+    float f = 0.0f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+
+/**\fn        float_to_half
+ * \brief     Convert the float \p f to half precision rounding to nearest even (values
+ *            beyond the range of half precision are converted to infinity)
+ *
+ * \param[in] f   the float
+ * \return    Bit pattern of the half precision number
+*/
+inline uint16_t float_to_half(float const f)
+{
+    uint32_t const x    = float_bits(f);
+    uint32_t const sign = (x >> 16) & 0x8000u;
+    uint32_t       absx = x & 0x7FFFFFFFu;
+
+    if (absx >= 0x7F800000u)
+    {
+        return static_cast<uint16_t>(sign | 0x7C00u | ((absx > 0x7F800000u) ? 0x0200u : 0u));
+    }
+    if (absx >= 0x477FF000u)
+    {
+        return static_cast<uint16_t>(sign | 0x7C00u);
+    }
+    if (absx < 0x38800000u)
+    {
+        // subnormal: multiples of 2^-24 (the product is exact, nearbyint rounds to nearest even)
+        return static_cast<uint16_t>(sign | static_cast<uint32_t>(std::nearbyint(bits_float(absx)*16777216.0f)));
+    }
+    // rebias the exponent from 127 to 15 and round the mantissa to nearest even
+    absx += 0xC8000FFFu + ((absx >> 13) & 1u);
+    return static_cast<uint16_t>(sign | (absx >> 13));
+}
+
+
+/**\fn        half_to_float
+ * \brief     Convert the half precision number with bit pattern \p h to float (exact)
+ *
+ * \param[in] h   bit pattern of the half precision number
+ * \return    The float
+*/
+inline float half_to_float(uint16_t const h)
+{
+    uint32_t const sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+    uint32_t const exp  = (h >> 10) & 0x1Fu;
+    uint32_t const mant = h & 0x3FFu;
+
+    if (exp == 0)
+    {
+        float const sub = std::ldexp(static_cast<float>(mant), -24);
+        return (sign != 0) ? -sub : sub;
+    }
+    if (exp == 0x1F)
+    {
+        return bits_float(sign | 0x7F800000u | (mant << 13));
+    }
+    return bits_float(sign | ((exp + 112) << 23) | (mant << 13));
+}
+
+
+/**\fn        float_to_bf16
+ * \brief     Convert the float \p f to brain floating point rounding to nearest even
+ *
+ * \param[in] f   the float
+ * \return    Bit pattern of the brain floating point number
+*/
+inline uint16_t float_to_bf16(float const f)
+{
+    uint32_t const x = float_bits(f);
+    return static_cast<uint16_t>((x + 0x7FFFu + ((x >> 16) & 1u)) >> 16);
+}
+
+
+/**\fn        bf16_to_float
+ * \brief     Convert the brain floating point number with bit pattern \p h to float (exact)
+ *
+ * \param[in] h   bit pattern of the brain floating point number
+ * \return    The float
+*/
+inline float bf16_to_float(uint16_t const h)
+{
+    return bits_float(static_cast<uint32_t>(h) << 16);
+}
+
+
+/**\fn         encode_block
+ * \brief      Encode the \p n (at most QUANT_BLOCK) numbers starting at \p src into the
+ *             block \p dst, the remaining elements of the block are set to zero
+ *
+ * \param[in]  src   pointer to the first number
+ * \param[in]  n     number of numbers
+ * \param[out] dst   the encoded block
+*/
+inline void encode_block(double const* src, size_t const n, BlockFp16 &dst)
+{
+    for (size_t i = 0; i < QUANT_BLOCK; ++i)
+    {
+        dst.h[i] = (i < n) ? float_to_half(static_cast<float>(src[i])) : 0;
+    }
+}
+
+inline void encode_block(double const* src, size_t const n, BlockBf16 &dst)
+{
+    for (size_t i = 0; i < QUANT_BLOCK; ++i)
+    {
+        dst.h[i] = (i < n) ? float_to_bf16(static_cast<float>(src[i])) : 0;
+    }
+}
+
+inline void encode_block(double const* src, size_t const n, BlockQ8 &dst)
+{
+    double amax = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        amax = std::max(amax, std::abs(src[i]));
+    }
+    dst.scale = static_cast<float>(amax/127.0);
+    double const inv = (dst.scale > 0.0f) ? 1.0/dst.scale : 0.0;
+    for (size_t i = 0; i < QUANT_BLOCK; ++i)
+    {
+        dst.q[i] = (i < n) ? static_cast<int8_t>(std::clamp(std::nearbyint(src[i]*inv), -127.0, 127.0)) : 0;
+    }
+}
+
+inline void encode_block(double const* src, size_t const n, BlockQ4 &dst)
+{
+    double amax = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        amax = std::max(amax, std::abs(src[i]));
+    }
+    dst.scale = static_cast<float>(amax/7.0);
+    double const inv = (dst.scale > 0.0f) ? 1.0/dst.scale : 0.0;
+    for (size_t i = 0; i < QUANT_BLOCK/2; ++i)
+    {
+        auto const nibble = [&](size_t const j) -> uint8_t
+        {
+            return (j < n) ? static_cast<uint8_t>(std::clamp(std::nearbyint(src[j]*inv), -8.0, 7.0) + 8.0) : 8;
+        };
+        dst.q[i] = static_cast<uint8_t>(nibble(i) | (nibble(i + QUANT_BLOCK/2) << 4));
+    }
+}
+
+
+/**\fn        decode
+ * \brief     Decode element \p i of the block \p b (without the scale of the block)
+ *
+ * \param[in] b   the block
+ * \param[in] i   index of the element in the block
+ * \return    The unscaled element
+*/
+inline float decode(BlockFp16 const &b, size_t const i) { return half_to_float(b.h[i]); }
+inline float decode(BlockBf16 const &b, size_t const i) { return bf16_to_float(b.h[i]); }
+inline float decode(BlockQ8   const &b, size_t const i) { return static_cast<float>(b.q[i]); }
+inline float decode(BlockQ4   const &b, size_t const i)
+{
+    uint8_t const byte = b.q[i % (QUANT_BLOCK/2)];
+    return static_cast<float>(((i < QUANT_BLOCK/2) ? (byte & 0x0F) : (byte >> 4)) - 8);
+}
+
+
+/**\fn        block_scale
+ * \brief     Scale of the block \p b (1 for the floating point formats)
+*/
+inline double block_scale(BlockFp16 const &) { return 1.0;                          }
+inline double block_scale(BlockBf16 const &) { return 1.0;                          }
+inline double block_scale(BlockQ8   const &b) { return static_cast<double>(b.scale); }
+inline double block_scale(BlockQ4   const &b) { return static_cast<double>(b.scale); }
+
+
+/**\fn        compressed_blocks
+ * \brief     Number of blocks needed to store \p length elements
+*/
+inline size_t compressed_blocks(size_t const length)
+{
+    return (length + QUANT_BLOCK - 1)/QUANT_BLOCK;
+}
+
+
+/**\fn        compress
+ * \brief     Encode the numbers \p x in blocks of format \p B, the last block is padded
+ *            with zeros. The blocks are encoded in parallel with the static partition of
+ *            the kernels (first touch).
+ *
+ * \param[in] x   the numbers to be encoded
+ * \return    Vector of the blocks
+*/
+template <typename B>
+VEC(B) compress(std::span<double const> const &x)
+{
+    size_t const blocks = compressed_blocks(x.size());
+    VEC(B)       res(blocks);
+    B* const     dst = res.data();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        encode_block(x.data() + b*QUANT_BLOCK, std::min<size_t>(QUANT_BLOCK, x.size() - b*QUANT_BLOCK), dst[b]);
+    }
+
+    return res;
+}
+
+
+/**\fn        scalar_omp_compressed
+ * \brief     Calculate dot product of the compressed vector \p x and the double vector
+ *            \p y without any vectorisation (only OpenMP parallel for). Serves as
+ *            reference and fallback for hosts without SIMD support.
+ *
+ * \param[in] x   the blocks of the compressed vector
+ * \param[in] y   a C++ span of x.size()*QUANT_BLOCK elements
+ * \return    Dot product of the two vectors
+*/
+template <typename B>
+inline double scalar_omp_compressed(std::span<B const> const &x, std::span<double const> const &y)
+{
+    assert(y.size() == x.size()*QUANT_BLOCK);
+    size_t const blocks = x.size();
+
+    double res = 0.0;
+
+    #pragma omp parallel for reduction(+: res)
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < QUANT_BLOCK; ++i)
+        {
+            sum += static_cast<double>(decode(x[b], i))*y[b*QUANT_BLOCK + i];
+        }
+        res += block_scale(x[b])*sum;
+    }
+
+    return res;
+}
+
+
+/**\fn        scalar_omp_compressed2
+ * \brief     Calculate dot product of the two compressed vectors \p x and \p y without
+ *            any vectorisation (only OpenMP parallel for): the products are accumulated
+ *            in float per block and in double across blocks
+ *
+ * \param[in] x   the blocks of the first compressed vector
+ * \param[in] y   the blocks of the second compressed vector
+ * \return    Dot product of the two vectors
+*/
+template <typename B>
+inline double scalar_omp_compressed2(std::span<B const> const &x, std::span<B const> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const blocks = x.size();
+
+    double res = 0.0;
+
+    #pragma omp parallel for reduction(+: res)
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < QUANT_BLOCK; ++i)
+        {
+            sum += decode(x[b], i)*decode(y[b], i);
+        }
+        res += block_scale(x[b])*block_scale(y[b])*static_cast<double>(sum);
+    }
+
+    return res;
+}
+
+
+/**\fn        simd_omp_compressed
+ * \brief     Calculate dot product of the compressed vector \p x and the double vector
+ *            \p y with the codec \p Codec: every block is decoded to doubles inside the
+ *            registers (Codec::decode_pd), multiplied with \p y in two independent
+ *            chains and scaled once per block
+ *
+ * \param[in] x   the blocks of the compressed vector
+ * \param[in] y   a C++ span of x.size()*QUANT_BLOCK elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Codec>
+inline double simd_omp_compressed(std::span<typename Codec::block const> const &x, std::span<double const> const &y)
+{
+    typedef typename Codec::isa Isa;
+    typedef typename Isa::reg   reg;
+    constexpr size_t groups = QUANT_BLOCK/Isa::width;
+    static_assert(groups % 2 == 0, "A block must fill an even number of registers");
+
+    assert(y.size() == x.size()*QUANT_BLOCK);
+    size_t const                        blocks = x.size();
+    typename Codec::block const* const  xb     = x.data();
+    double const* const                 yp     = y.data();
+
+    double res = 0.0;
+
+    #pragma omp parallel reduction(+: res)
+    {
+        reg _acc = Isa::zero();
+
+        #pragma omp for schedule(static) nowait
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            reg _sum[2] = {Isa::zero(), Isa::zero()};
+
+            #pragma GCC unroll 16
+            for (size_t k = 0; k < groups; ++k)
+            {
+                _sum[k % 2] = Isa::fmadd(Codec::decode_pd(xb[b], k), Isa::loadu(yp + b*QUANT_BLOCK + k*Isa::width), _sum[k % 2]);
+            }
+
+            if constexpr (Codec::block::scaled == true)
+            {
+                _acc = Isa::fmadd(Codec::broadcast(block_scale(xb[b])), Isa::add(_sum[0], _sum[1]), _acc);
+            }
+            else
+            {
+                _acc = Isa::add(_acc, Isa::add(_sum[0], _sum[1]));
+            }
+        }
+
+        res += Isa::reduce(_acc);
+    }
+
+    return res;
+}
+
+
+/**\fn        simd_omp_compressed2
+ * \brief     Calculate dot product of the two compressed vectors \p x and \p y with the
+ *            codec \p Codec: both blocks are decoded to floats inside the registers
+ *            (Codec::decode_ps), accumulated in float per block and in double across
+ *            blocks (Codec::widen)
+ *
+ * \param[in] x   the blocks of the first compressed vector
+ * \param[in] y   the blocks of the second compressed vector
+ * \return    Dot product of the two vectors
+*/
+template <typename Codec>
+inline double simd_omp_compressed2(std::span<typename Codec::block const> const &x,
+                                   std::span<typename Codec::block const> const &y)
+{
+    typedef typename Codec::isa       Isa;
+    typedef typename Codec::isa_float IsaFloat;
+    constexpr size_t groups = QUANT_BLOCK/IsaFloat::width;
+
+    assert(x.size() == y.size());
+    size_t const                        blocks = x.size();
+    typename Codec::block const* const  xb     = x.data();
+    typename Codec::block const* const  yb     = y.data();
+
+    double res = 0.0;
+
+    #pragma omp parallel reduction(+: res)
+    {
+        typename Isa::reg _acc = Isa::zero();
+
+        #pragma omp for schedule(static) nowait
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            typename IsaFloat::reg _sum = IsaFloat::zero();
+
+            #pragma GCC unroll 16
+            for (size_t k = 0; k < groups; ++k)
+            {
+                _sum = IsaFloat::fmadd(Codec::decode_ps(xb[b], k), Codec::decode_ps(yb[b], k), _sum);
+            }
+
+            if constexpr (Codec::block::scaled == true)
+            {
+                _acc = Isa::fmadd(Codec::broadcast(block_scale(xb[b])*block_scale(yb[b])), Codec::widen(_sum), _acc);
+            }
+            else
+            {
+                _acc = Isa::add(_acc, Codec::widen(_sum));
+            }
+        }
+
+        res += Isa::reduce(_acc);
+    }
+
+    return res;
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // COMPRESSED_H_INCLUDED
@@ -0,0 +1,194 @@
+#ifndef COMPRESSION_H_INCLUDED
+#define COMPRESSION_H_INCLUDED
+
+/**
+ * \file     compression.hpp
+ * \mainpage Benchmark of the compressed operand formats (see compressed.hpp): for
+ *           every instruction set of the host the dense double kernel is compared
+ *           to the kernels for a compressed x (times a double y) and for both
+ *           operands compressed. Besides the throughput the speed-up over the
+ *           dense kernel and the relative error with respect to the double
+ *           reference (omp_simd_span) are reported.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "compressed.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "omp_simd.hpp"
+
+
+/**\struct CompressionSettings
+ * \brief  Settings of the benchmark of the compressed formats
+*/
+struct CompressionSettings
+{
+    size_t                   length = 10000000;  ///< number of elements per vector (rounded up to entire blocks)
+    std::vector<std::string> ids;                ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv    = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\struct CompressedRow
+ * \brief  Result of a single kernel of the benchmark of the compressed formats
+*/
+struct CompressedRow
+{
+    std::string     name;         ///< name of the kernel
+    double          bytes;        ///< bytes read per element (both operands)
+    BenchmarkResult res;          ///< statistics and throughput of the kernel
+    double          speedup;      ///< speed-up over the dense double kernel of the same instruction set
+    double          error;        ///< relative error with respect to the double reference
+};
+
+
+/**\fn         print_compressed_row
+ * \brief      Print a row of the benchmark of the compressed formats (or the header if
+ *             \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_compressed_row(CompressedRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,bytes_per_elem,median_s,min_s,mad_s,ns_per_elem,gbs,speedup,rel_error,result" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(12) << "bytes/elem"
+            << std::setw(12) << "median[us]" << std::setw(10) << "MAD%" << std::setw(10) << "ns/elem"
+            << std::setw(10) << "GB/s" << std::setw(10) << "speedup" << std::setw(14) << "rel.error"
+            << std::setw(18) << "result" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->bytes << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.ns_per_elem << "," << row->res.gbs << "," << row->speedup << "," << row->error << ","
+            << row->res.result << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setprecision(3)
+        << std::setw(12) << row->bytes << std::setw(12) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setprecision(4) << std::setw(10) << row->res.ns_per_elem
+        << std::setprecision(2) << std::setw(10) << row->res.gbs << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->error
+        << std::fixed << std::setw(18) << row->res.result << std::endl;
+}
+
+
+/**\fn         run_compressed_format
+ * \brief      Benchmark the kernels of the compressed format \p B of the instruction set
+ *             \p table for the operands \p x and \p y and print a row for a compressed x
+ *             and one for both operands compressed
+ *
+ * \param[in]  table       kernel table of the instruction set
+ * \param[in]  x           the first operand in double precision
+ * \param[in]  y           the second operand in double precision
+ * \param[in]  reference   the dot product in double precision
+ * \param[in]  dense       median runtime of the dense double kernel of the instruction set
+ * \param[in]  settings    settings of the benchmark harness
+ * \param[out] out         stream the results are written to
+ * \param[in]  csv         print comma-separated values instead of a table
+*/
+template <typename B>
+void run_compressed_format(KernelTable const &table, std::span<double const> const &x, std::span<double const> const &y,
+                           double const reference, double const dense, BenchmarkSettings const &settings,
+                           std::ostream &out, bool const csv)
+{
+    VEC(B) const x_blocks = compress<B>(x);
+    VEC(B) const y_blocks = compress<B>(y);
+    std::span<B const> const x_span(x_blocks.data(), x_blocks.size());
+    std::span<B const> const y_span(y_blocks.data(), y_blocks.size());
+    CompressedKernels<B> const &kernels = compressed_kernels<B>(table);
+
+    double const block_bytes = static_cast<double>(sizeof(B))/QUANT_BLOCK;
+    auto const   report      = [&](std::string const &operands, double const bytes, BenchmarkResult const &res)
+    {
+        CompressedRow const row = {std::string(table.id) + " " + B::name + " " + operands, bytes, res,
+                                   dense/res.stats.median, std::abs(res.result - reference)/std::abs(reference)};
+        print_compressed_row(&row, out, csv);
+    };
+
+    report("x", block_bytes + sizeof(double),
+           benchmark_callable([&](){ return kernels.dot(x_span, y); }, x.size(), block_bytes + sizeof(double), 2.0, settings));
+    report("x,y", 2.0*block_bytes,
+           benchmark_callable([&](){ return kernels.dot2(x_span, y_span); }, x.size(), 2.0*block_bytes, 2.0, settings));
+}
+
+
+/**\fn         run_compressed_formats
+ * \brief      Benchmark the dense double kernel and the kernels of all compressed formats
+ *             of the instruction sets supported by the host
+ *
+ * \param[in]  compression   settings of the benchmark of the compressed formats
+ * \param[in]  settings      settings of the benchmark harness
+ * \param[out] out           stream the results are written to
+*/
+inline void run_compressed_formats(CompressionSettings const &compression, BenchmarkSettings const &settings,
+                                   std::ostream &out = std::cout)
+{
+    size_t const length = compressed_blocks(compression.length)*QUANT_BLOCK;
+
+    AlignedBuffer<double> x(init_vec<double>(length));
+    AlignedBuffer<double> y(init_vec<double>(length, 1));
+    std::span<double> const x_span = x.span();
+    std::span<double> const y_span = y.span();
+    std::span<double const> const x_const(x_span.data(), length);
+    std::span<double const> const y_const(y_span.data(), length);
+
+    double const reference = omp_simd_span<double>(x_span, y_span);
+
+    if (compression.csv == false)
+    {
+        out << "COMPRESSED OPERANDS (" << length << " elements, blocks of " << QUANT_BLOCK
+            << " elements, error relative to the double reference " << reference << ")" << std::endl;
+    }
+    print_compressed_row(nullptr, out, compression.csv);
+
+    for (KernelTable const* table: available_kernels())
+    {
+        if ((compression.ids.empty() == false) &&
+            (std::find(compression.ids.begin(), compression.ids.end(), table->id) == compression.ids.end()))
+        {
+            continue;
+        }
+
+        BenchmarkResult const dense = benchmark_fun<std::span<double>>(x_span, y_span, table->dot_span, settings);
+        CompressedRow const   row   = {std::string(table->id) + " double", 2.0*sizeof(double), dense, 1.0,
+                                       std::abs(dense.result - reference)/std::abs(reference)};
+        print_compressed_row(&row, out, compression.csv);
+
+        run_compressed_format<BlockFp16>(*table, x_const, y_const, reference, dense.stats.median, settings, out, compression.csv);
+        run_compressed_format<BlockBf16>(*table, x_const, y_const, reference, dense.stats.median, settings, out, compression.csv);
+        run_compressed_format<BlockQ8>  (*table, x_const, y_const, reference, dense.stats.median, settings, out, compression.csv);
+        run_compressed_format<BlockQ4>  (*table, x_const, y_const, reference, dense.stats.median, settings, out, compression.csv);
+    }
+}
+
+#endif // COMPRESSION_H_INCLUDED
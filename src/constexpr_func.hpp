@@ -5,11 +5,62 @@
  * \file     constexpr_func.hpp
  * \mainpage A series of functions that can evaluate to a constant expression and thus
  *           can make use of evaluation and optimisation at compile time.
+ *           The dot products of C++ arrays and spans of static extent know the number of
+ *           elements at compile time, so that the entire implementation is chosen at
+ *           compile time (see cef::FixedPolicy): the traits class of the widest
+ *           instruction set the translation unit is compiled for (none for other element
+ *           types than double and float), the number of accumulators, whether short
+ *           vectors are unrolled entirely with index sequences and whether very long
+ *           vectors are distributed over the threads at all. The tail of the vectors is
+ *           handled with exactly as many masked elements as remain. Evaluated as constant
+ *           expression they use independent scalar partial sums instead of registers.
 */
 
 
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <array>
 #include <limits>
+#include <type_traits>
+#include <utility>
 #include <assert.h>
+#include "simd_kernel.hpp"
+
+/// traits classes of the widest instruction set the translation unit is compiled for
+#if defined(__AVX512F__) && defined(__AVX512CD__)
+    #include "avx512_omp.hpp"
+    #define CEF_SIMD_BYTES 64
+#elif defined(__AVX2__) && defined(__FMA__)
+    #include "avx2_omp.hpp"
+    #define CEF_SIMD_BYTES 32
+#elif defined(__SSE2__)
+    #include "sse2_omp.hpp"
+    #define CEF_SIMD_BYTES 16
+#else
+    #define CEF_SIMD_BYTES 8
+#endif
+
+/// largest number of independent registers of partial sums of the fixed-size dot products
+#define CEF_ACCUMULATORS 4
+
+/// largest number of elements of a fixed-size dot product that is unrolled entirely
+#define CEF_UNROLL_MAX 64
+
+/// smallest number of elements of a fixed-size dot product that is distributed over the threads
+#define CEF_PARALLEL_MIN 262144
 
 
 namespace cef
@@ -46,6 +97,320 @@ namespace cef
                ? static_cast<T>(sqrtNewton(x_d, x_d, 0.0))
                : ret_NaN;
     }
+
+
+    /**\struct cef::FixedIsa
+     * \brief  Traits class of the widest instruction set the translation unit is compiled
+     *         for with elements of type \p T (void if there is none)
+    */
+    template <typename T>
+    struct FixedIsa
+    {
+        typedef void type;
+    };
+
+#if defined(__AVX512F__) && defined(__AVX512CD__)
+    template <>
+    struct FixedIsa<double>
+    {
+        typedef SimdAvx512 type;
+    };
+
+    template <>
+    struct FixedIsa<float>
+    {
+        typedef SimdAvx512Float type;
+    };
+#elif defined(__AVX2__) && defined(__FMA__)
+    template <>
+    struct FixedIsa<double>
+    {
+        typedef SimdAvx2 type;
+    };
+
+    template <>
+    struct FixedIsa<float>
+    {
+        typedef SimdAvx2Float type;
+    };
+#elif defined(__SSE2__)
+    template <>
+    struct FixedIsa<double>
+    {
+        typedef SimdSse2 type;
+    };
+#endif
+
+
+    /**\struct cef::FixedPolicy
+     * \brief  Implementation of the dot product of \p N elements of type \p T chosen at
+     *         compile time: registers of the instruction set if it fills at least one,
+     *         otherwise (and in constant expressions) independent scalar partial sums,
+     *         unrolled entirely up to CEF_UNROLL_MAX elements and parallel from
+     *         CEF_PARALLEL_MIN elements on
+    */
+    template <typename T, size_t N>
+    struct FixedPolicy
+    {
+        typedef typename FixedIsa<T>::type isa;   ///< traits class of the instruction set (or void)
+
+        static constexpr size_t width        = std::max<size_t>(1, CEF_SIMD_BYTES/sizeof(T));                     ///< elements per register
+        static constexpr size_t registers    = N/width;                                                          ///< entire registers
+        static constexpr size_t accumulators = std::clamp<size_t>(registers/2, 1, CEF_ACCUMULATORS);             ///< independent registers of partial sums
+        static constexpr size_t step         = accumulators*width;                                               ///< elements of a block of all accumulators
+        static constexpr size_t lanes        = std::min(step, std::max<size_t>(1, N));                           ///< independent scalar partial sums
+        static constexpr bool   vectorised   = (std::is_void_v<isa> == false) && (registers > 0);                ///< use the instruction set
+        static constexpr bool   unrolled     = (N <= CEF_UNROLL_MAX);                                            ///< unroll all elements
+        static constexpr bool   parallel     = (N >= CEF_PARALLEL_MIN);                                          ///< distribute the elements over the threads
+    };
+
+
+    /**\fn         cef::accumulate_fixed
+     * \brief      Add the products of the elements \p Offset + I of \p x and \p y to the
+     *             partial sums I modulo the number of partial sums, unrolled entirely
+     *
+     * \param[in]  x     pointer to the first element of x
+     * \param[in]  y     pointer to the first element of y
+     * \param[out] acc   the partial sums
+    */
+    template <size_t Offset, typename T, size_t Lanes, size_t... I>
+    constexpr void accumulate_fixed([[maybe_unused]] T const* const x, [[maybe_unused]] T const* const y,
+                                    [[maybe_unused]] std::array<T,Lanes> &acc, std::index_sequence<I...>)
+    {
+        ((acc[I % Lanes] += x[Offset + I]*y[Offset + I]), ...);
+    }
+
+
+    /**\fn        cef::init_fixed
+     * \brief     Initialise the partial sums with the products of the first elements of
+     *            \p x and \p y (instead of adding them to zeros)
+     *
+     * \param[in] x   pointer to the first element of x
+     * \param[in] y   pointer to the first element of y
+     * \return    The partial sums
+    */
+    template <typename T, size_t... I>
+    constexpr std::array<T,sizeof...(I)> init_fixed(T const* const x, T const* const y, std::index_sequence<I...>)
+    {
+        return {(x[I]*y[I])...};
+    }
+
+
+    /**\fn        cef::reduce_fixed
+     * \brief     Reduce the partial sums \p acc pairwise to a single result by adding the
+     *            upper half to the lower half recursively
+     *
+     * \param[in] acc   the partial sums
+     * \return    The sum of the partial sums
+    */
+    template <typename T, size_t Lanes>
+    constexpr T reduce_fixed(std::array<T,Lanes> const &acc)
+    {
+        if constexpr (Lanes == 1)
+        {
+            return acc[0];
+        }
+        else
+        {
+            constexpr size_t half = (Lanes + 1)/2;
+            return [&acc]<size_t... I>(std::index_sequence<I...>)
+            {
+                return reduce_fixed(std::array<T,half>{((I + half < Lanes) ? acc[I] + acc[I + half] : acc[I])...});
+            }(std::make_index_sequence<half>{});
+        }
+    }
+
+
+    /**\fn        cef::dot_fixed_scalar
+     * \brief     Calculate the dot product of the \p N elements of \p x and \p y with
+     *            independent scalar partial sums (see cef::FixedPolicy), serially for
+     *            constant expressions
+     *
+     * \param[in] x   pointer to the first element of x
+     * \param[in] y   pointer to the first element of y
+     * \return    Dot product of the two vectors
+    */
+    template <typename T, size_t N>
+    constexpr T dot_fixed_scalar(T const* const x, T const* const y)
+    {
+        typedef FixedPolicy<T,N> policy;
+        constexpr size_t lanes = policy::lanes;
+        constexpr size_t body  = N/lanes*lanes;
+
+        std::array<T,lanes> acc = init_fixed(x, y, std::make_index_sequence<lanes>{});
+        if constexpr (policy::unrolled == true)
+        {
+            accumulate_fixed<lanes>(x, y, acc, std::make_index_sequence<N - lanes>{});
+            return reduce_fixed(acc);
+        }
+        else
+        {
+            T res = static_cast<T>(0);
+            if ((policy::parallel == true) && (std::is_constant_evaluated() == false))
+            {
+                #pragma omp parallel for simd schedule(static) reduction(+: res)
+                for (size_t i = lanes; i < body; ++i)
+                {
+                    res += x[i]*y[i];
+                }
+            }
+            else
+            {
+                for (size_t i = lanes; i < body; i += lanes)
+                {
+                    #pragma GCC unroll 64
+                    for (size_t l = 0; l < lanes; ++l)
+                    {
+                        acc[l] += x[i + l]*y[i + l];
+                    }
+                }
+            }
+            accumulate_fixed<body>(x, y, acc, std::make_index_sequence<N - body>{});
+            return reduce_fixed(acc) + res;
+        }
+    }
+
+
+    /**\fn        cef::dot_fixed_simd
+     * \brief     Calculate the dot product of the \p N elements of \p x and \p y with the
+     *            traits class \p Isa (see cef::FixedPolicy): the registers are distributed
+     *            round-robin over the accumulators, the last elements are loaded with a
+     *            mask of exactly the remaining elements
+     *
+     * \param[in] x   pointer to the first element of x
+     * \param[in] y   pointer to the first element of y
+     * \return    Dot product of the two vectors
+    */
+    template <typename Isa, size_t N>
+    inline typename Isa::result_type dot_fixed_simd(typename Isa::value_type const* const x,
+                                                    typename Isa::value_type const* const y)
+    {
+        typedef FixedPolicy<typename Isa::value_type,N> policy;
+        typedef typename Isa::reg                       reg;
+        constexpr size_t width        = Isa::width;
+        constexpr size_t accumulators = policy::accumulators;
+        constexpr size_t step         = policy::step;
+        constexpr size_t body         = N/step*step;
+        constexpr size_t end          = N/width*width;
+        static_assert(width == policy::width, "The register width must match the instruction set of the translation unit");
+
+        if constexpr (policy::parallel == true)
+        {
+            return simd_omp_kernel<Isa, 2*accumulators, accumulators, 0, false>(x, y, N);
+        }
+        else
+        {
+            reg _acc[accumulators];
+            for (size_t a = 0; a < accumulators; ++a)
+            {
+                _acc[a] = Isa::zero();
+            }
+
+            auto const accumulate = [&]<size_t Offset, size_t... I>(std::index_sequence<I...>)
+            {
+                ((_acc[I % accumulators] = Isa::fmadd(Isa::loadu(x + Offset + I*width), Isa::loadu(y + Offset + I*width),
+                                                      _acc[I % accumulators])), ...);
+            };
+
+            if constexpr (policy::unrolled == true)
+            {
+                accumulate.template operator()<0>(std::make_index_sequence<policy::registers>{});
+            }
+            else
+            {
+                for (size_t i = 0; i < body; i += step)
+                {
+                    #pragma GCC unroll 16
+                    for (size_t a = 0; a < accumulators; ++a)
+                    {
+                        _acc[a] = Isa::fmadd(Isa::loadu(x + i + a*width), Isa::loadu(y + i + a*width), _acc[a]);
+                    }
+                }
+                accumulate.template operator()<body>(std::make_index_sequence<(end - body)/width>{});
+            }
+
+            if constexpr (end < N)
+            {
+                _acc[0] = Isa::fmadd(Isa::load_partial(x + end, N - end), Isa::load_partial(y + end, N - end), _acc[0]);
+            }
+
+            #pragma GCC unroll 16
+            for (size_t stride = 1; stride < accumulators; stride *= 2)
+            {
+                #pragma GCC unroll 16
+                for (size_t a = 0; a + stride < accumulators; a += 2*stride)
+                {
+                    _acc[a] = Isa::add(_acc[a], _acc[a + stride]);
+                }
+            }
+            return Isa::reduce(_acc[0]);
+        }
+    }
+
+
+    /**\fn        cef::dot_fixed
+     * \brief     Calculate the dot product of the \p N elements of \p x and \p y with the
+     *            implementation chosen at compile time (see cef::FixedPolicy), can be
+     *            evaluated as a constant expression
+     *
+     * \param[in] x   pointer to the first element of x
+     * \param[in] y   pointer to the first element of y
+     * \return    Dot product of the two vectors
+    */
+    template <typename T, size_t N>
+    constexpr T dot_fixed(T const* const x, T const* const y)
+    {
+        typedef FixedPolicy<T,N> policy;
+
+        if constexpr (N == 0)
+        {
+            return static_cast<T>(0);
+        }
+        else
+        {
+            if constexpr (policy::vectorised == true)
+            {
+                if (std::is_constant_evaluated() == false)
+                {
+                    return dot_fixed_simd<typename policy::isa, N>(x, y);
+                }
+            }
+            return dot_fixed_scalar<T,N>(x, y);
+        }
+    }
+
+
+    /**\fn        cef::dot
+     * \brief     Calculate dot product of two vectors \p x and \p y whose length is known at
+     *            compile time (see cef::dot_fixed), container: C++ array
+     *
+     * \param[in] x   a (un)aligned C++ array
+     * \param[in] y   a (un)aligned C++ array
+     * \return    Dot product of the two vectors
+    */
+    template <typename T, size_t N>
+    constexpr T dot(std::array<T,N> const &x, std::array<T,N> const &y)
+    {
+        return dot_fixed<T,N>(x.data(), y.data());
+    }
+
+
+    /**\fn        cef::dot
+     * \brief     Calculate dot product of two vectors \p x and \p y whose length is known at
+     *            compile time (see cef::dot_fixed), container: C++ span of static extent
+     *
+     * \param[in] x   a (un)aligned C++ span of static extent
+     * \param[in] y   a (un)aligned C++ span of static extent
+     * \return    Dot product of the two vectors
+    */
+    template <typename T, typename U, size_t N>
+    constexpr std::remove_cv_t<T> dot(std::span<T,N> const &x, std::span<U,N> const &y)
+    {
+        static_assert(N != std::span<T>::extent, "The length of the spans must be known at compile time");
+        static_assert(std::is_same_v<std::remove_cv_t<T>, std::remove_cv_t<U>>, "Elements of x and y must be of the same type");
+
+        return dot_fixed<std::remove_cv_t<T>,N>(x.data(), y.data());
+    }
 }
 
 #endif // CONSTEXPR_FUNC_H_INCLUDED
@@ -0,0 +1,312 @@
+#ifndef CPU_FEATURES_H_INCLUDED
+#define CPU_FEATURES_H_INCLUDED
+
+/**
+ * \file     cpu_features.hpp
+ * \mainpage Detection of the instruction set extensions supported by the host
+ *           at runtime by means of CPUID and XGETBV. Contrary to the compiler
+ *           macros (e.g. __AVX2__) this reflects the machine the binary is
+ *           running on and not the machine it was compiled for. Additionally
+ *           the cache sizes of the host are determined.
+ * \warning  Must be compiled without any ISA-specific flags (e.g. -mavx2) as it
+ *           is called before it is known which instructions may be executed!
+*/
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+#endif
+
+
+/**\enum  IsaLevel
+ * \brief Instruction set levels a kernel might be compiled for, sorted ascending
+ *        so that a level implies support of all lower levels
+*/
+enum class IsaLevel : int
+{
+    scalar = 0,
+    sse2   = 1,
+    avx2   = 2,  ///< AVX2, FMA3 and F16C
+    avx512 = 3   ///< AVX512 F, CD, BW, DQ and VL (Skylake-SP and later)
+};
+
+
+/// environment variable that allows to force a lower instruction set level
+#define ISA_ENV_VAR "DOTPROD_ISA"
+
+
+/**\fn        isa_name
+ * \brief     Human-readable name of an instruction set \p level
+ *
+ * \param[in] level   the instruction set level
+ * \return    The name of the instruction set level
+*/
+inline char const* isa_name(IsaLevel const level)
+{
+    switch (level)
+    {
+        case IsaLevel::scalar: return "scalar";
+        case IsaLevel::sse2:   return "SSE2";
+        case IsaLevel::avx2:   return "AVX2";
+        case IsaLevel::avx512: return "AVX512";
+    }
+    return "unknown";
+}
+
+
+/**\fn        isa_from_string
+ * \brief     Parse an instruction set level from a (case-sensitive) string \p str
+ *            such as "avx2"
+ *
+ * \param[in]  str     the string to be parsed
+ * \param[out] level   the parsed instruction set level
+ * \return     Boolean flag signalling if the string could be parsed
+*/
+inline bool isa_from_string(char const* const str, IsaLevel &level)
+{
+    if      (strcmp(str, "scalar") == 0) level = IsaLevel::scalar;
+    else if (strcmp(str, "sse2")   == 0) level = IsaLevel::sse2;
+    else if (strcmp(str, "avx2")   == 0) level = IsaLevel::avx2;
+    else if (strcmp(str, "avx512") == 0) level = IsaLevel::avx512;
+    else return false;
+    return true;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+/**\fn        xgetbv0
+ * \brief     Read the extended control register XCR0 that signals which register
+ *            states are saved by the operating system on a context switch. Written
+ *            in assembly so that the file does not have to be compiled with -mxsave
+ *
+ * \return    The content of XCR0
+*/
+inline uint64_t xgetbv0()
+{
+    uint32_t eax = 0, edx = 0;
+    __asm__ volatile (".byte 0x0f, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+#endif
+
+
+/**\fn        detect_isa
+ * \brief     Determine the highest instruction set level that is supported by both
+ *            the processor (CPUID) and the operating system (XGETBV)
+ *
+ * \return    The highest supported instruction set level
+*/
+inline IsaLevel detect_isa()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return IsaLevel::scalar;
+    }
+    bool const has_sse2    = (edx & bit_SSE2)    != 0;
+    bool const has_fma     = (ecx & bit_FMA)     != 0;
+    bool const has_f16c    = (ecx & bit_F16C)    != 0;
+    bool const has_osxsave = (ecx & bit_OSXSAVE) != 0;
+
+    if (has_sse2 == false)
+    {
+        return IsaLevel::scalar;
+    }
+    if (has_osxsave == false)
+    {
+        return IsaLevel::sse2;
+    }
+
+    // the operating system has to save the XMM/YMM (bits 1,2) and opmask/ZMM (bits 5,6,7) states
+    uint64_t const xcr0       = xgetbv0();
+    bool const     os_avx     = (xcr0 & 0x06) == 0x06;
+    bool const     os_avx512  = (xcr0 & 0xE6) == 0xE6;
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return IsaLevel::sse2;
+    }
+    bool const has_avx2    = (ebx & bit_AVX2)     != 0;
+    bool const has_avx512  = ((ebx & bit_AVX512F)  != 0) && ((ebx & bit_AVX512CD) != 0) &&
+                             ((ebx & bit_AVX512BW) != 0) && ((ebx & bit_AVX512DQ) != 0) &&
+                             ((ebx & bit_AVX512VL) != 0);
+
+    if (os_avx && has_avx2 && has_fma && has_f16c)
+    {
+        if (os_avx512 && has_avx512)
+        {
+            return IsaLevel::avx512;
+        }
+        return IsaLevel::avx2;
+    }
+    return IsaLevel::sse2;
+#else
+    return IsaLevel::scalar;
+#endif
+}
+
+
+/**\fn        detect_avx512_vnni
+ * \brief     Determine if the processor supports the vector neural network instructions
+ *            of AVX512 (vpdpbusd, Cascade Lake and later). Only meaningful if AVX512 is
+ *            supported by the processor and the operating system (see detect_isa).
+ *
+ * \return    Boolean flag signalling support of AVX512 VNNI
+*/
+inline bool detect_avx512_vnni()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+    {
+        return false;
+    }
+    return (ecx & bit_AVX512VNNI) != 0;
+#else
+    return false;
+#endif
+}
+
+
+/**\fn        select_isa
+ * \brief     Instruction set level that should be used for the kernels: The highest
+ *            level supported by the host unless a lower one is forced with the
+ *            environment variable ISA_ENV_VAR (e.g. DOTPROD_ISA=avx2). The result is
+ *            determined once and cached.
+ *
+ * \return    The instruction set level to be used
+*/
+inline IsaLevel select_isa()
+{
+    static IsaLevel const level = []()
+    {
+        IsaLevel const supported = detect_isa();
+        char const*    forced    = std::getenv(ISA_ENV_VAR);
+
+        if ((forced == nullptr) || (forced[0] == '\0'))
+        {
+            return supported;
+        }
+
+        IsaLevel requested = supported;
+        if (isa_from_string(forced, requested) == false)
+        {
+            std::cerr << "Warning: unknown value '" << forced << "' of " << ISA_ENV_VAR
+                      << " (scalar, sse2, avx2, avx512), using " << isa_name(supported) << std::endl;
+            return supported;
+        }
+        if (requested > supported)
+        {
+            std::cerr << "Warning: " << isa_name(requested) << " requested by " << ISA_ENV_VAR
+                      << " is not supported by this host, using " << isa_name(supported) << std::endl;
+            return supported;
+        }
+        return requested;
+    }();
+
+    return level;
+}
+
+
+/**\struct CacheSizes
+ * \brief  Sizes of the data caches of the host in bytes (0 if unknown)
+*/
+struct CacheSizes
+{
+    size_t l1 = 0;  ///< level 1 data cache (per core)
+    size_t l2 = 0;  ///< level 2 cache (typically per core)
+    size_t l3 = 0;  ///< last level cache (typically shared by a socket)
+};
+
+
+/**\fn        detect_cache_sizes
+ * \brief     Determine the data cache sizes of the host from the Linux sysfs
+ *            (/sys/devices/system/cpu/cpu0/cache). On other operating systems
+ *            all sizes are reported as unknown.
+ *
+ * \return    The sizes of the data caches
+*/
+inline CacheSizes detect_cache_sizes()
+{
+    CacheSizes sizes;
+
+    for (int index = 0; index < 8; ++index)
+    {
+        std::string const dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+        std::ifstream level_file(dir + "level");
+        std::ifstream type_file(dir + "type");
+        std::ifstream size_file(dir + "size");
+        if (!level_file || !type_file || !size_file)
+        {
+            break;
+        }
+
+        int         level = 0;
+        std::string type;
+        std::string size_str;
+        level_file >> level;
+        type_file  >> type;
+        size_file  >> size_str;
+        if ((type == "Instruction") || size_str.empty())
+        {
+            continue;
+        }
+
+        // sizes are given as e.g. "48K" or "2048K"
+        size_t size = std::stoul(size_str);
+        switch (size_str.back())
+        {
+            case 'K': size <<= 10; break;
+            case 'M': size <<= 20; break;
+            case 'G': size <<= 30; break;
+            default:  break;
+        }
+
+        switch (level)
+        {
+            case 1:  sizes.l1 = size; break;
+            case 2:  sizes.l2 = size; break;
+            case 3:  sizes.l3 = size; break;
+            default: break;
+        }
+    }
+
+    return sizes;
+}
+
+
+/**\fn        detect_available_memory
+ * \brief     Determine the memory available for new allocations without swapping from
+ *            the Linux procfs (MemAvailable of /proc/meminfo). On other operating
+ *            systems the available memory is reported as unknown.
+ *
+ * \return    The available memory in bytes, 0 if unknown
+*/
+inline size_t detect_available_memory()
+{
+    std::ifstream meminfo("/proc/meminfo");
+    std::string   key;
+    size_t        kib = 0;
+    std::string   unit;
+    while (meminfo >> key >> kib >> unit)
+    {
+        // the sizes are given as e.g. "MemAvailable:   12345678 kB"
+        if (key == "MemAvailable:")
+        {
+            return kib << 10;
+        }
+    }
+    return 0;
+}
+
+#endif // CPU_FEATURES_H_INCLUDED
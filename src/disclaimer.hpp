@@ -17,6 +17,7 @@
 
 #include <unordered_map>
 #include <iostream>
+#include "cpu_features.hpp"
 
 
 /**\fn        print_disclaimer
@@ -99,13 +100,23 @@ void print_disclaimer()
     #endif
 
     std::cout << " Vector intrinsics ";
-    #ifdef __AVX512CD__
-        std::cout << "AVX512 (512bit, 8 doubles, 16 floats)" << std::endl;
-    #elif __AVX2__
-        std::cout << "AVX2 (256bit, 4 doubles, 8 floats)"   << std::endl;
-    #else
-        std::cout << "not supported" << std::endl;
-    #endif
+    switch (detect_isa())
+    {
+        case IsaLevel::avx512:
+            std::cout << "AVX512 (512bit, 8 doubles, 16 floats)" << std::endl;
+            break;
+        case IsaLevel::avx2:
+            std::cout << "AVX2 (256bit, 4 doubles, 8 floats)"    << std::endl;
+            break;
+        case IsaLevel::sse2:
+            std::cout << "SSE2 (128bit, 2 doubles, 4 floats)"    << std::endl;
+            break;
+        case IsaLevel::scalar:
+            std::cout << "not supported" << std::endl;
+            break;
+    }
+    std::cout << " Selected kernels " << isa_name(select_isa())
+              << " (override with " << ISA_ENV_VAR << "=scalar|sse2|avx2|avx512)" << std::endl;
 
     return;
 }
@@ -0,0 +1,687 @@
+#ifndef DISPATCH_H_INCLUDED
+#define DISPATCH_H_INCLUDED
+
+/**
+ * \file     dispatch.hpp
+ * \mainpage Runtime dispatch of the dot product kernels: every kernel is compiled
+ *           once per instruction set level in its own translation unit
+ *           (kernels_<isa>.cpp, see Makefile for the corresponding flags) and
+ *           registered in a table of function pointers. At startup the table of
+ *           the fastest level supported by the host is selected.
+ * \warning  Only call kernels of a table whose level is supported by the host!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <assert.h>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "align.hpp"
+#include "batched.hpp"
+#include "complex.hpp"
+#include "compressed.hpp"
+#include "cpu_features.hpp"
+#include "fused.hpp"
+#include "gemm.hpp"
+#include "gemv.hpp"
+#include "soa.hpp"
+#include "sparse.hpp"
+#include "topk.hpp"
+
+
+/// signature of a dot product kernel operating on two aligned and padded spans
+typedef double (*dot_span_fun)(std::span<double> const &x, std::span<double> const &y);
+
+/// signature of a dot product kernel operating on two read-only spans of any length and alignment
+typedef double (*dot_unaligned_fun)(std::span<double const> const &x, std::span<double const> const &y);
+
+/// signature of a kernel computing the dot products of all pairs of a batch
+typedef void (*dot_batch_fun)(std::span<DotPair const> const &pairs, std::span<double> const &results);
+
+/// signature of a kernel computing the dot products of a vector with all rows of a matrix
+typedef void (*dot_gemv_fun)(std::span<double const> const &a, Layout const layout,
+                             std::span<double const> const &x, std::span<double> const &r);
+
+/// signature of a kernel searching the k vectors of a collection with the largest dot product with a query
+typedef size_t (*dot_topk_fun)(BlockedCollection const &collection, std::span<double const> const &query,
+                               size_t const k, std::vector<ScoredIndex> &hits);
+
+/// signatures of the kernels computing the matrix product c = a·b of row-major matrices
+typedef void (*dot_dgemm_fun)(std::span<double const> const &a, std::span<double const> const &b,
+                              std::span<double> const &c, size_t const m, size_t const n, size_t const k);
+typedef void (*dot_sgemm_fun)(std::span<float const> const &a, std::span<float const> const &b,
+                              std::span<float> const &c, size_t const m, size_t const n, size_t const k);
+
+/// signature of a kernel measuring the attainable peak performance of the arithmetic
+typedef double (*dot_peak_fun)(size_t const iterations, double &flops);
+
+/// signature of a kernel computing the dot products of all pairs of tiny vectors stored as structure of arrays
+typedef void (*dot_soa_fun)(SoaVectors const &x, SoaVectors const &y, std::span<double> const &r);
+
+/// signatures of the kernels computing the dot product of a sparse vector with 64 or 32 bit positions and a dense vector
+typedef double (*dot_sparse_fun)(SparseVector<int64_t> const &x, std::span<double const> const &y);
+typedef double (*dot_sparse32_fun)(SparseVector<int32_t> const &x, std::span<double const> const &y);
+
+/// signature of a kernel computing the dot product of two sparse vectors with 64 bit positions
+typedef double (*dot_sparse_sparse_fun)(SparseVector<int64_t> const &x, SparseVector<int64_t> const &y);
+
+/// signature of a kernel computing the dot product and the squared norms of two vectors in a single pass
+typedef FusedSums (*dot_fused_fun)(std::span<double const> const &x, std::span<double const> const &y);
+
+/// signatures of the single precision kernels
+typedef float (*dot_span_float_fun)(std::span<float> const &x, std::span<float> const &y);
+typedef float (*dot_unaligned_float_fun)(std::span<float const> const &x, std::span<float const> const &y);
+
+/// signatures of the integer kernels (accumulated exactly in 64 bit)
+typedef int64_t (*dot_int16_fun)(std::span<int16_t> const &x, std::span<int16_t> const &y);
+typedef int64_t (*dot_u8s8_fun)(std::span<uint8_t> const &x, std::span<int8_t> const &y);
+
+
+/**\struct CompressedKernels
+ * \brief  Kernels for operands stored in the compressed format \p B (see compressed.hpp)
+*/
+template <typename B>
+struct CompressedKernels
+{
+    double (*dot)(std::span<B const> const &x, std::span<double const> const &y);  ///< compressed x times double y
+    double (*dot2)(std::span<B const> const &x, std::span<B const> const &y);      ///< compressed x times compressed y
+};
+
+
+/**\struct ComplexKernels
+ * \brief  Kernels of the dot products of complex vectors of precision \p T with increments
+ *         like the BLAS (see complex.hpp)
+*/
+template <typename T>
+struct ComplexKernels
+{
+    std::complex<T> (*dotu)(size_t const n, std::complex<T> const* const x, std::ptrdiff_t const incx,
+                            std::complex<T> const* const y, std::ptrdiff_t const incy);  ///< sum of x_i*y_i
+    std::complex<T> (*dotc)(size_t const n, std::complex<T> const* const x, std::ptrdiff_t const incx,
+                            std::complex<T> const* const y, std::ptrdiff_t const incy);  ///< sum of conj(x_i)*y_i
+};
+
+
+/**\struct FusedKernels
+ * \brief  Kernels computing several reductions of two vectors in a single pass (see fused.hpp)
+*/
+struct FusedKernels
+{
+    dot_fused_fun norms;  ///< x·y, ‖x‖² and ‖y‖²
+    dot_fused_fun stats;  ///< additionally the sums, minima and maxima of x and y
+};
+
+
+/**\struct SoaKernels
+ * \brief  Kernels for pairs of tiny vectors stored as structure of arrays (see soa.hpp),
+ *         one per number of elements
+*/
+struct SoaKernels
+{
+    dot_soa_fun dim3;   ///< vectors of 3 elements
+    dot_soa_fun dim4;   ///< vectors of 4 elements
+    dot_soa_fun dim8;   ///< vectors of 8 elements
+    dot_soa_fun dim16;  ///< vectors of 16 elements
+};
+
+
+/**\struct KernelVariant
+ * \brief  A single instantiation of the policy-based kernel (see simd_kernel.hpp)
+*/
+struct KernelVariant
+{
+    size_t       unroll;        ///< number of registers processed per iteration
+    size_t       accumulators;  ///< number of independent accumulators
+    size_t       prefetch;      ///< software-prefetch distance in cache lines (0 for none)
+    dot_span_fun dot_span;      ///< dot product of two aligned and padded spans
+};
+
+
+/**\struct KernelTable
+ * \brief  All kernels compiled for a single instruction set level
+*/
+struct KernelTable
+{
+    IsaLevel                level;                ///< instruction set level the kernels were compiled for
+    char const*             id;                   ///< short identifier of the kernel variant (e.g. for the command line)
+    char const*             name;                 ///< name of the kernel variant
+    dot_span_fun            dot_span;             ///< dot product of two aligned and padded spans
+    dot_unaligned_fun       dot_unaligned;        ///< dot product of two spans of any length and alignment
+    dot_span_fun            dot2;                 ///< accurate dot product (Dot2) of two aligned and padded spans
+    dot_unaligned_fun       dot2_unaligned;       ///< accurate dot product (Dot2) of two spans of any length and alignment
+    dot_span_fun            repro;                ///< dot product bitwise independent of the number of threads of two aligned and padded spans
+    dot_unaligned_fun       repro_unaligned;      ///< dot product bitwise independent of the number of threads of two spans of any length and alignment
+    dot_batch_fun           batch;                ///< dot products of all pairs of a batch in a single parallel region
+    dot_gemv_fun            gemv;                 ///< dot products of a vector with all rows of a matrix (register-blocked)
+    dot_topk_fun            topk;                 ///< maximum inner product search over a blocked collection
+    dot_dgemm_fun           dgemm;                ///< cache-blocked matrix product in double precision
+    dot_sgemm_fun           sgemm;                ///< cache-blocked matrix product in single precision
+    dot_peak_fun            peak;                 ///< attainable peak performance of double fused multiply-adds
+    dot_peak_fun            peak_float;           ///< attainable peak performance of single precision fused multiply-adds
+    SoaKernels              soa;                  ///< dot products of many pairs of tiny vectors vectorised across the pairs
+    dot_sparse_fun          sparse;               ///< dot product of a sparse vector with 64 bit positions and a dense vector
+    dot_sparse32_fun        sparse32;             ///< dot product of a sparse vector with 32 bit positions and a dense vector
+    dot_sparse_sparse_fun   sparse_sparse;        ///< dot product of two sparse vectors with 64 bit positions
+    ComplexKernels<double>  zdot;                 ///< dot products of complex double vectors with increments (zdotu, zdotc)
+    ComplexKernels<float>   cdot;                 ///< dot products of complex float vectors with increments (cdotu, cdotc)
+    FusedKernels            fused;                ///< dot product and squared norms of two vectors in a single pass
+    dot_span_float_fun      dot_span_float;       ///< single precision dot product of two aligned and padded spans
+    dot_unaligned_float_fun dot_unaligned_float;  ///< single precision dot product of two spans of any length and alignment
+    dot_int16_fun           dot_int16;            ///< dot product of two aligned and padded spans of 16 bit integers
+    dot_u8s8_fun            dot_u8s8;             ///< dot product of aligned and padded spans of unsigned and signed 8 bit integers
+    CompressedKernels<BlockFp16> fp16;            ///< operands stored in half precision
+    CompressedKernels<BlockBf16> bf16;            ///< operands stored as brain floating point numbers
+    CompressedKernels<BlockQ8>   q8;              ///< operands stored as 8 bit integers with a scale per block
+    CompressedKernels<BlockQ4>   q4;              ///< operands stored as 4 bit integers with a scale per block
+    KernelVariant const*    variants;             ///< instantiation matrix of the policy-based kernel (nullptr if none)
+    size_t                  no_variants;          ///< number of entries of the instantiation matrix
+};
+
+
+/// kernel tables defined in the translation units compiled with the respective flags
+extern KernelTable const kernels_scalar;
+extern KernelTable const kernels_sse2;
+extern KernelTable const kernels_avx2;
+extern KernelTable const kernels_avx512;
+
+/// 8 bit integer kernel using AVX512 VNNI (kernels_avx512_vnni.cpp, nullptr if the compiler lacks support)
+extern dot_u8s8_fun const kernel_avx512_vnni_u8s8;
+
+
+/**\fn        kernel_table
+ * \brief     Kernel table for the given instruction set \p level
+ *
+ * \param[in] level   the instruction set level
+ * \return    Reference to the corresponding kernel table
+*/
+inline KernelTable const& kernel_table(IsaLevel const level)
+{
+    switch (level)
+    {
+        case IsaLevel::avx512: return kernels_avx512;
+        case IsaLevel::avx2:   return kernels_avx2;
+        case IsaLevel::sse2:   return kernels_sse2;
+        case IsaLevel::scalar: break;
+    }
+    return kernels_scalar;
+}
+
+
+/**\fn        active_kernels
+ * \brief     Kernel table of the fastest instruction set level supported by the host
+ *            (or the level forced by the environment variable ISA_ENV_VAR)
+ *
+ * \return    Reference to the selected kernel table
+*/
+inline KernelTable const& active_kernels()
+{
+    return kernel_table(select_isa());
+}
+
+
+/**\fn        available_kernels
+ * \brief     All kernel tables that may be executed on this host in ascending order
+ *            of their instruction set level, e.g. for benchmarking them against each
+ *            other
+ *
+ * \return    Vector of pointers to the executable kernel tables
+*/
+inline std::vector<KernelTable const*> available_kernels()
+{
+    std::vector<KernelTable const*> tables;
+    for (int l = static_cast<int>(IsaLevel::scalar); l <= static_cast<int>(select_isa()); ++l)
+    {
+        tables.push_back(&kernel_table(static_cast<IsaLevel>(l)));
+    }
+    return tables;
+}
+
+
+/**\fn        compressed_kernels
+ * \brief     Kernels of the table \p table for operands in the compressed format \p B
+ *
+ * \param[in] table   the kernel table
+ * \return    Reference to the kernels of the format
+*/
+template <typename B>
+inline CompressedKernels<B> const& compressed_kernels(KernelTable const &table)
+{
+    if constexpr (std::is_same<B,BlockFp16>::value == true)
+    {
+        return table.fp16;
+    }
+    else if constexpr (std::is_same<B,BlockBf16>::value == true)
+    {
+        return table.bf16;
+    }
+    else if constexpr (std::is_same<B,BlockQ8>::value == true)
+    {
+        return table.q8;
+    }
+    else
+    {
+        static_assert(std::is_same<B,BlockQ4>::value == true, "Unknown compressed format");
+        return table.q4;
+    }
+}
+
+
+/**\fn        complex_kernels
+ * \brief     Kernels of the table \p table for complex vectors of precision \p T
+ *
+ * \param[in] table   the kernel table
+ * \return    Reference to the kernels of the precision
+*/
+template <typename T>
+inline ComplexKernels<T> const& complex_kernels(KernelTable const &table)
+{
+    if constexpr (std::is_same<T,double>::value == true)
+    {
+        return table.zdot;
+    }
+    else
+    {
+        static_assert(std::is_same<T,float>::value == true, "Complex vectors of double or float only");
+        return table.cdot;
+    }
+}
+
+
+/**\fn        vnni_kernel
+ * \brief     The AVX512 VNNI kernel for unsigned times signed 8 bit integers if it may be
+ *            executed on this host (AVX512 selected and VNNI supported), nullptr otherwise
+ *
+ * \return    Pointer to the kernel or nullptr
+*/
+inline dot_u8s8_fun vnni_kernel()
+{
+    if ((select_isa() == IsaLevel::avx512) && (detect_avx512_vnni() == true))
+    {
+        return kernel_avx512_vnni_u8s8;
+    }
+    return nullptr;
+}
+
+
+/**\fn        dot_span
+ * \brief     Calculate dot product of two vectors \p x and \p y with the fastest
+ *            kernel available on this host, container: C++ span
+ *
+ * \param[in] x   an aligned and padded C++ span
+ * \param[in] y   an aligned and padded C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double dot_span(std::span<double> const &x, std::span<double> const &y)
+{
+    return active_kernels().dot_span(x, y);
+}
+
+
+/**\fn        dot_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of any length and
+ *            alignment with the fastest kernel available on this host without copying
+ *            them, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double dot_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    return active_kernels().dot_unaligned(x, y);
+}
+
+
+/**\fn        dot2
+ * \brief     Calculate dot product of two vectors \p x and \p y of any length and
+ *            alignment in about twice the working precision (Dot2, see compensated.hpp)
+ *            with the fastest kernel available on this host, container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double dot2(std::span<double const> const &x, std::span<double const> const &y)
+{
+    return active_kernels().dot2_unaligned(x, y);
+}
+
+
+/**\fn        dot_reproducible
+ * \brief     Calculate dot product of two vectors \p x and \p y of any length and
+ *            alignment bitwise independent of the number of threads (see
+ *            reproducible.hpp) with the fastest kernel available on this host,
+ *            container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double dot_reproducible(std::span<double const> const &x, std::span<double const> const &y)
+{
+    return active_kernels().repro_unaligned(x, y);
+}
+
+
+/**\fn         dot_batch
+ * \brief      Calculate the dot products of all \p pairs of a batch in a single parallel
+ *             region (see batched.hpp) with the fastest kernel available on this host
+ *
+ * \param[in]  pairs     the pairs of the batch
+ * \param[out] results   the dot products of the pairs
+*/
+inline void dot_batch(std::span<DotPair const> const &pairs, std::span<double> const &results)
+{
+    active_kernels().batch(pairs, results);
+}
+
+
+/**\fn         dot_batch
+ * \brief      Calculate the dot products of all pairs of a batch stored back to back in
+ *             the pooled buffers \p x_pool and \p y_pool (see pooled_pairs) in a single
+ *             parallel region with the fastest kernel available on this host
+ *
+ * \param[in]  x_pool    buffer holding the first operands of all pairs
+ * \param[in]  y_pool    buffer holding the second operands of all pairs
+ * \param[in]  offsets   offsets of the pairs into the buffers (one more entry than pairs)
+ * \param[out] results   the dot products of the pairs
+*/
+inline void dot_batch(std::span<double const> const &x_pool, std::span<double const> const &y_pool,
+                      std::span<size_t const> const &offsets, std::span<double> const &results)
+{
+    std::vector<DotPair> const pairs = pooled_pairs(x_pool, y_pool, offsets);
+    active_kernels().batch(pairs, results);
+}
+
+
+/**\fn         gemv
+ * \brief      Calculate the dot products r_j = y_j·x of \p x with all rows y_j of the
+ *             matrix \p a stored in \p layout (see gemv.hpp) with the fastest kernel
+ *             available on this host
+ *
+ * \param[in]  a        the matrix of r.size() rows and x.size() columns
+ * \param[in]  layout   storage order of the matrix
+ * \param[in]  x        the shared operand
+ * \param[out] r        the dot products of all rows
+*/
+inline void gemv(std::span<double const> const &a, Layout const layout,
+                 std::span<double const> const &x, std::span<double> const &r)
+{
+    active_kernels().gemv(a, layout, x, r);
+}
+
+
+/**\fn         topk
+ * \brief      Search the \p k vectors of the \p collection with the largest dot product
+ *             with \p query (see topk.hpp) with the fastest kernel available on this host
+ *
+ * \param[in]  collection   the blocked collection (see make_blocked_collection)
+ * \param[in]  query        the query of collection.dim elements
+ * \param[in]  k            number of wished results
+ * \param[out] hits         the (at most) k best vectors in the order of decreasing dot products
+ * \return     Number of blocks that were skipped
+*/
+inline size_t topk(BlockedCollection const &collection, std::span<double const> const &query,
+                   size_t const k, std::vector<ScoredIndex> &hits)
+{
+    return active_kernels().topk(collection, query, k, hits);
+}
+
+
+/**\fn         dgemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) blocked for the cache hierarchy (see gemm.hpp) with the
+ *             fastest kernel available on this host
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+inline void dgemm(std::span<double const> const &a, std::span<double const> const &b,
+                  std::span<double> const &c, size_t const m, size_t const n, size_t const k)
+{
+    active_kernels().dgemm(a, b, c, m, n, k);
+}
+
+
+/**\fn         sgemm
+ * \brief      Calculate the matrix product c = a·b of the row-major single precision
+ *             matrices \p a (m x k) and \p b (k x n) blocked for the cache hierarchy (see
+ *             gemm.hpp) with the fastest kernel available on this host
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+inline void sgemm(std::span<float const> const &a, std::span<float const> const &b,
+                  std::span<float> const &c, size_t const m, size_t const n, size_t const k)
+{
+    active_kernels().sgemm(a, b, c, m, n, k);
+}
+
+
+/**\fn         soa_kernel
+ * \brief      Kernel of the \p table for pairs of tiny vectors of \p dim elements stored
+ *             as structure of arrays (the one without manual vectorisation for numbers of
+ *             elements without a dedicated kernel)
+ *
+ * \param[in]  table   the kernel table
+ * \param[in]  dim     number of elements of the vectors
+ * \return     The kernel
+*/
+inline dot_soa_fun soa_kernel(KernelTable const &table, size_t const dim)
+{
+    switch (dim)
+    {
+        case 3:  return table.soa.dim3;
+        case 4:  return table.soa.dim4;
+        case 8:  return table.soa.dim8;
+        case 16: return table.soa.dim16;
+        default: return scalar_omp_soa<0>;
+    }
+}
+
+
+/**\fn         dot_soa
+ * \brief      Calculate the dot products r_j = x_j·y_j of all pairs of tiny vectors stored
+ *             as structure of arrays (see soa.hpp) with the fastest kernel available on
+ *             this host
+ *
+ * \param[in]  x   the first vectors of the pairs
+ * \param[in]  y   the second vectors of the pairs
+ * \param[out] r   the dot products of the pairs
+*/
+inline void dot_soa(SoaVectors const &x, SoaVectors const &y, std::span<double> const &r)
+{
+    soa_kernel(active_kernels(), x.dim)(x, y, r);
+}
+
+
+/**\fn        dot_sparse
+ * \brief     Calculate dot product of the sparse vector \p x and the dense vector \p y
+ *            (see sparse.hpp) with the fastest kernel available on this host
+ *
+ * \param[in] x   the sparse vector with 64 bit positions
+ * \param[in] y   the dense vector
+ * \return    Dot product of the two vectors
+*/
+inline double dot_sparse(SparseVector<int64_t> const &x, std::span<double const> const &y)
+{
+    return active_kernels().sparse(x, y);
+}
+
+
+/**\fn        dot_sparse
+ * \brief     Calculate dot product of the sparse vector \p x and the dense vector \p y
+ *            (see sparse.hpp) with the fastest kernel available on this host
+ *
+ * \param[in] x   the sparse vector with 32 bit positions
+ * \param[in] y   the dense vector
+ * \return    Dot product of the two vectors
+*/
+inline double dot_sparse(SparseVector<int32_t> const &x, std::span<double const> const &y)
+{
+    return active_kernels().sparse32(x, y);
+}
+
+
+/**\fn        dot_sparse
+ * \brief     Calculate dot product of the sparse vectors \p x and \p y (see sparse.hpp)
+ *            with the fastest kernel available on this host
+ *
+ * \param[in] x   the first sparse vector with 64 bit positions
+ * \param[in] y   the second sparse vector with 64 bit positions
+ * \return    Dot product of the two vectors
+*/
+inline double dot_sparse(SparseVector<int64_t> const &x, SparseVector<int64_t> const &y)
+{
+    return active_kernels().sparse_sparse(x, y);
+}
+
+
+/**\fn        dot_complex
+ * \brief     Calculate the dot product of the complex vectors \p x and \p y of \p n
+ *            elements with increments like the BLAS (see complex.hpp) with the fastest
+ *            kernel available on this host
+ *
+ * \param[in] n           number of elements
+ * \param[in] x           the first vector
+ * \param[in] incx        increment between two elements of \p x (backwards if negative)
+ * \param[in] y           the second vector
+ * \param[in] incy        increment between two elements of \p y (backwards if negative)
+ * \param[in] conjugate   conjugate \p x (zdotc, cdotc) or not (zdotu, cdotu)
+ * \return    Dot product of the two vectors
+*/
+template <typename T>
+inline std::complex<T> dot_complex(size_t const n, std::complex<T> const* const x, std::ptrdiff_t const incx,
+                                   std::complex<T> const* const y, std::ptrdiff_t const incy, bool const conjugate = false)
+{
+    ComplexKernels<T> const &kernels = complex_kernels<T>(active_kernels());
+    return (conjugate == true) ? kernels.dotc(n, x, incx, y, incy) : kernels.dotu(n, x, incx, y, incy);
+}
+
+
+/**\fn        dot_complex
+ * \brief     Calculate the dot product of the contiguous complex vectors \p x and \p y
+ *            with the fastest kernel available on this host, container: C++ span
+ *
+ * \param[in] x           a C++ span of any length and alignment
+ * \param[in] y           a C++ span of any length and alignment
+ * \param[in] conjugate   conjugate \p x (zdotc, cdotc) or not (zdotu, cdotu)
+ * \return    Dot product of the two vectors
+*/
+template <typename T>
+inline std::complex<T> dot_complex(std::span<std::complex<T> const> const &x, std::span<std::complex<T> const> const &y,
+                                   bool const conjugate = false)
+{
+    assert(x.size() == y.size());
+    return dot_complex<T>(x.size(), x.data(), 1, y.data(), 1, conjugate);
+}
+
+
+/**\fn        dot_fused
+ * \brief     Calculate the dot product and the squared norms of the vectors \p x and \p y
+ *            (and their sums, minima and maxima if \p stats) in a single pass (see
+ *            fused.hpp) with the fastest kernel available on this host
+ *
+ * \param[in] x       a C++ span of any length and alignment
+ * \param[in] y       a C++ span of any length and alignment
+ * \param[in] stats   compute the sums, minima and maxima as well
+ * \return    The results of the pass
+*/
+inline FusedSums dot_fused(std::span<double const> const &x, std::span<double const> const &y, bool const stats = false)
+{
+    FusedKernels const &kernels = active_kernels().fused;
+    return (stats == true) ? kernels.stats(x, y) : kernels.norms(x, y);
+}
+
+
+/**\fn        cosine_similarity
+ * \brief     Calculate the cosine similarity x·y/(‖x‖‖y‖) of the vectors \p x and \p y
+ *            in a single pass over both with the fastest kernel available on this host
+ *
+ * \param[in] x   a C++ span of any length and alignment
+ * \param[in] y   a C++ span of any length and alignment
+ * \return    Cosine similarity of the two vectors, 0 if one of them is zero
+*/
+inline double cosine_similarity(std::span<double const> const &x, std::span<double const> const &y)
+{
+    return cosine_from_fused(active_kernels().fused.norms(x, y));
+}
+
+
+/**\fn        dot_span
+ * \brief     Calculate single precision dot product of two vectors \p x and \p y with
+ *            the fastest kernel available on this host, container: C++ span
+ *
+ * \param[in] x   an aligned and padded C++ span
+ * \param[in] y   an aligned and padded C++ span
+ * \return    Dot product of the two vectors
+*/
+inline float dot_span(std::span<float> const &x, std::span<float> const &y)
+{
+    return active_kernels().dot_span_float(x, y);
+}
+
+
+/**\fn        dot_unaligned
+ * \brief     Calculate single precision dot product of two vectors \p x and \p y of any
+ *            length and alignment with the fastest kernel available on this host,
+ *            container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline float dot_unaligned(std::span<float const> const &x, std::span<float const> const &y)
+{
+    return active_kernels().dot_unaligned_float(x, y);
+}
+
+
+/**\fn        dot_span
+ * \brief     Calculate the exact dot product of two vectors \p x and \p y of 16 bit
+ *            integers with the fastest kernel available on this host, container: C++ span
+ *
+ * \param[in] x   an aligned and padded C++ span
+ * \param[in] y   an aligned and padded C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t dot_span(std::span<int16_t> const &x, std::span<int16_t> const &y)
+{
+    return active_kernels().dot_int16(x, y);
+}
+
+
+/**\fn        dot_span
+ * \brief     Calculate the exact dot product of a vector \p x of unsigned and a vector
+ *            \p y of signed 8 bit integers with the fastest kernel available on this host
+ *            (AVX512 VNNI if supported), container: C++ span
+ *
+ * \param[in] x   an aligned and padded C++ span
+ * \param[in] y   an aligned and padded C++ span
+ * \return    Dot product of the two vectors
+*/
+inline int64_t dot_span(std::span<uint8_t> const &x, std::span<int8_t> const &y)
+{
+    static dot_u8s8_fun const vnni = vnni_kernel();
+    return (vnni != nullptr) ? vnni(x, y) : active_kernels().dot_u8s8(x, y);
+}
+
+#endif // DISPATCH_H_INCLUDED
@@ -0,0 +1,185 @@
+#ifndef FIXED_LENGTHS_H_INCLUDED
+#define FIXED_LENGTHS_H_INCLUDED
+
+/**
+ * \file     fixed_lengths.hpp
+ * \mainpage Benchmark of the dot products whose length is known at compile time (see
+ *           constexpr_func.hpp) for lengths from a few elements up to more than a
+ *           million. For every length the OpenMP loop over C++ arrays (omp_simd_arr) is
+ *           the reference, the dispatched kernel for spans of any length as well as the
+ *           fixed-size kernels for C++ arrays and spans of static extent are compared to
+ *           it. The fixed-size kernels use the instruction set this translation unit is
+ *           compiled for. Besides the time per call the speed-up and the relative
+ *           deviation from the reference are reported.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "benchmark.hpp"
+#include "constexpr_func.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "omp_simd.hpp"
+
+
+/// number of elements processed per timed sample and kernel if the calls per sample are not given
+#define FIXED_ELEMENTS_PER_SAMPLE 100000
+
+
+/**\struct FixedSettings
+ * \brief  Settings of the benchmark of the dot products of a length known at compile time
+*/
+struct FixedSettings
+{
+    size_t iterations = 0;      ///< number of calls per timed sample, FIXED_ELEMENTS_PER_SAMPLE elements if 0
+    bool   csv        = false;  ///< print comma-separated values instead of a table
+};
+
+
+/**\struct FixedRow
+ * \brief  Result of a single kernel and length of the benchmark of the fixed-size dot products
+*/
+struct FixedRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          length;       ///< number of elements of the vectors
+    BenchmarkResult res;          ///< statistics and throughput of a single call
+    double          speedup;      ///< speed-up over the OpenMP loop over C++ arrays
+    double          deviation;    ///< relative deviation from the result of the loop
+};
+
+
+/**\fn         print_fixed_row
+ * \brief      Print a row of the benchmark of the fixed-size dot products (or the header
+ *             if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_fixed_row(FixedRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,length,median_s,min_s,mad_s,ns_per_elem,gflops,speedup,rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(10) << "length"
+            << std::setw(14) << "median[ns]" << std::setw(10) << "MAD%" << std::setw(12) << "ns/elem"
+            << std::setw(10) << "GFLOP/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->length << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.ns_per_elem << "," << row->res.gflops << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(10) << row->length
+        << std::setprecision(1) << std::setw(14) << s.median*1.0e9 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setprecision(3) << std::setw(12) << row->res.ns_per_elem
+        << std::setprecision(2) << std::setw(10) << row->res.gflops << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         run_fixed_length
+ * \brief      Benchmark the dot products of vectors of \p N elements whose length is
+ *             known at compile time against the OpenMP loop over C++ arrays
+ *
+ * \param[in]  fixed      settings of the benchmark of the fixed-size dot products
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+template <size_t N>
+inline void run_fixed_length(FixedSettings const &fixed, BenchmarkSettings settings, std::ostream &out)
+{
+    settings.iterations = (fixed.iterations > 0) ? fixed.iterations : std::max<size_t>(1, FIXED_ELEMENTS_PER_SAMPLE/N);
+
+    // the arrays are allocated on the heap as the long ones do not fit onto the stack
+    std::unique_ptr<std::array<double,N>> const x = std::make_unique<std::array<double,N>>();
+    std::unique_ptr<std::array<double,N>> const y = std::make_unique<std::array<double,N>>();
+    vec_to_arr(init_vec<double>(N), *x);
+    vec_to_arr(init_vec<double>(N, 1), *y);
+
+    // the operands are accessed through volatile pointers so that the calls of the inlined
+    // fixed-size kernels cannot be hoisted out of the loop of the benchmark harness
+    std::array<double,N> const* volatile x_arr = x.get();
+    std::array<double,N> const* volatile y_arr = y.get();
+    double const                         bytes = 2.0*sizeof(double);
+
+    BenchmarkResult const loop = benchmark_callable([&]()
+    {
+        return omp_simd_arr(*x_arr, *y_arr);
+    }, N, bytes, 2.0, settings);
+    FixedRow const loop_row = {"OMP SIMD array loop", N, loop, 1.0, 0.0};
+    print_fixed_row(&loop_row, out, fixed.csv);
+
+    auto const row = [&](std::string const &name, BenchmarkResult const &res)
+    {
+        FixedRow const r = {name, N, res, loop.stats.median/res.stats.median,
+                            std::abs(res.result - loop.result)/std::abs(loop.result)};
+        print_fixed_row(&r, out, fixed.csv);
+    };
+
+    KernelTable const &table = active_kernels();
+    row(std::string(table.id) + " dynamic span", benchmark_callable([&]()
+    {
+        return table.dot_unaligned(std::span<double const>(x_arr->data(), N), std::span<double const>(y_arr->data(), N));
+    }, N, bytes, 2.0, settings));
+
+    row("fixed std::array", benchmark_callable([&]()
+    {
+        return cef::dot(*x_arr, *y_arr);
+    }, N, bytes, 2.0, settings));
+
+    row("fixed std::span", benchmark_callable([&]()
+    {
+        return cef::dot(std::span<double const,N>(*x_arr), std::span<double const,N>(*y_arr));
+    }, N, bytes, 2.0, settings));
+}
+
+
+/**\fn         run_fixed_lengths
+ * \brief      Benchmark the dot products whose length is known at compile time for all
+ *             lengths \p N
+ *
+ * \param[in]  fixed      settings of the benchmark of the fixed-size dot products
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+template <size_t... N>
+inline void run_fixed_lengths(FixedSettings const &fixed, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (fixed.csv == false)
+    {
+        out << "DOT PRODUCTS OF LENGTHS KNOWN AT COMPILE TIME (" << CEF_SIMD_BYTES << " byte registers, unrolled up to "
+            << CEF_UNROLL_MAX << " elements, parallel from " << CEF_PARALLEL_MIN << " elements)" << std::endl;
+    }
+    print_fixed_row(nullptr, out, fixed.csv);
+
+    (run_fixed_length<N>(fixed, settings, out), ...);
+}
+
+#endif // FIXED_LENGTHS_H_INCLUDED
@@ -0,0 +1,289 @@
+#ifndef FUSED_H_INCLUDED
+#define FUSED_H_INCLUDED
+
+/**
+ * \file     fused.hpp
+ * \brief    dot product and norms of two vectors in a single pass (cosine similarity)
+ * \mainpage The cosine similarity x·y/(‖x‖‖y‖) requires the dot product as well as the
+ *           squared norms of both vectors. Computed by three dot products (x,y), (x,x)
+ *           and (y,y) both vectors are streamed from memory twice. The fused kernels
+ *           load a register of x and y once and accumulate x·y, ‖x‖² and ‖y‖² (and
+ *           optionally the sums, minima and maxima of x and y) in separate registers.
+ *           The partial results of the threads are combined with a single user-defined
+ *           OpenMP reduction of all values. The last elements that do not fill a
+ *           register are handled one by one so that zero padding cannot distort the
+ *           minima and maxima. The elements are distributed over the threads statically.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of registers of x and y per iteration of the SIMD kernels (independent accumulators)
+#define FUSED_UNROLL 2
+
+/// registers per iteration with the sums, minima and maxima for instruction sets of 16 registers (9 accumulators each)
+#define FUSED_UNROLL_STATS 1
+
+
+/**\struct FusedSums
+ * \brief  Results of a single pass over two vectors x and y (the sums, minima and maxima
+ *         only if requested)
+*/
+struct FusedSums
+{
+    double dot   = 0.0;                                          ///< x·y
+    double xx    = 0.0;                                          ///< ‖x‖², squared Euclidean norm of x
+    double yy    = 0.0;                                          ///< ‖y‖², squared Euclidean norm of y
+    double sum_x = 0.0;                                          ///< sum of the elements of x
+    double sum_y = 0.0;                                          ///< sum of the elements of y
+    double min_x = std::numeric_limits<double>::infinity();      ///< smallest element of x
+    double min_y = std::numeric_limits<double>::infinity();      ///< smallest element of y
+    double max_x = -std::numeric_limits<double>::infinity();     ///< largest element of x
+    double max_y = -std::numeric_limits<double>::infinity();     ///< largest element of y
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        combine_fused
+ * \brief     Combine the results \p a and \p b of two parts of the vectors
+ *
+ * \param[in] a   results of the first part
+ * \param[in] b   results of the second part
+ * \return    Results of both parts
+*/
+inline FusedSums combine_fused(FusedSums const &a, FusedSums const &b)
+{
+    FusedSums r;
+    r.dot   = a.dot   + b.dot;
+    r.xx    = a.xx    + b.xx;
+    r.yy    = a.yy    + b.yy;
+    r.sum_x = a.sum_x + b.sum_x;
+    r.sum_y = a.sum_y + b.sum_y;
+    r.min_x = std::min(a.min_x, b.min_x);
+    r.min_y = std::min(a.min_y, b.min_y);
+    r.max_x = std::max(a.max_x, b.max_x);
+    r.max_y = std::max(a.max_y, b.max_y);
+    return r;
+}
+
+
+/// OpenMP reduction of all results of a single pass at once
+#pragma omp declare reduction \
+    (fused: FusedSums: omp_out = combine_fused(omp_out, omp_in)) \
+    initializer(omp_priv = FusedSums())
+
+
+/**\fn            add_fused
+ * \brief         Add the elements \p a of x and \p b of y to the results \p r
+ *
+ * \param[in]     a   element of x
+ * \param[in]     b   element of y
+ * \param[in,out] r   the results
+*/
+template <bool Extended>
+inline void add_fused(double const a, double const b, FusedSums &r)
+{
+    r.dot += a*b;
+    r.xx  += a*a;
+    r.yy  += b*b;
+    if constexpr (Extended == true)
+    {
+        r.sum_x += a;
+        r.sum_y += b;
+        r.min_x  = std::min(r.min_x, a);
+        r.min_y  = std::min(r.min_y, b);
+        r.max_x  = std::max(r.max_x, a);
+        r.max_y  = std::max(r.max_y, b);
+    }
+}
+
+
+/**\fn        cosine_from_fused
+ * \brief     Cosine similarity from the results \p r of a single pass
+ *
+ * \param[in] r   the results with the dot product and both squared norms
+ * \return    x·y/(‖x‖‖y‖), 0 if one of the vectors is zero
+*/
+inline double cosine_from_fused(FusedSums const &r)
+{
+    double const norms = std::sqrt(r.xx)*std::sqrt(r.yy);
+    return (norms > 0.0) ? r.dot/norms : 0.0;
+}
+
+
+/**\fn        scalar_omp_fused
+ * \brief     Calculate the dot product and the squared norms (and the sums, minima and
+ *            maxima if \p Extended) of the vectors \p x and \p y in a single pass without
+ *            manual vectorisation
+ *
+ * \param[in] x   a C++ span of any length and alignment
+ * \param[in] y   a C++ span of any length and alignment
+ * \return    The results of the pass
+*/
+template <bool Extended>
+inline FusedSums scalar_omp_fused(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+
+    double const* const xd = x.data();
+    double const* const yd = y.data();
+    size_t const        N  = x.size();
+
+    FusedSums res;
+
+    #pragma omp parallel for schedule(static) reduction(fused: res)
+    for (size_t i = 0; i < N; ++i)
+    {
+        add_fused<Extended>(xd[i], yd[i], res);
+    }
+
+    return res;
+}
+
+
+/**\fn        simd_omp_fused
+ * \brief     Calculate the dot product and the squared norms (and the sums, minima and
+ *            maxima if \p Extended) of the vectors \p x and \p y in a single pass with the
+ *            instruction set \p Isa (see fused.hpp)
+ *
+ * \param[in] x   a C++ span of any length and alignment
+ * \param[in] y   a C++ span of any length and alignment
+ * \return    The results of the pass
+*/
+template <typename Isa, size_t Unroll, bool Extended>
+inline FusedSums simd_omp_fused(std::span<double const> const &x, std::span<double const> const &y)
+{
+    static_assert(Unroll > 0, "At least a single register is required");
+    assert(x.size() == y.size());
+
+    typedef typename Isa::reg reg;
+    constexpr size_t    width = Isa::width;
+    constexpr size_t    step  = Unroll*width;
+    double const* const xd    = x.data();
+    double const* const yd    = y.data();
+    size_t const        N     = x.size();
+    size_t const        body  = N/step*step;
+    size_t const        end   = N/width*width;
+
+    FusedSums res;
+    for (size_t i = end; i < N; ++i)
+    {
+        add_fused<Extended>(xd[i], yd[i], res);
+    }
+
+    #pragma omp parallel reduction(fused: res)
+    {
+        reg _dot[Unroll], _xx[Unroll], _yy[Unroll];
+        reg _sum_x[Unroll], _sum_y[Unroll], _min_x[Unroll], _min_y[Unroll], _max_x[Unroll], _max_y[Unroll];
+        for (size_t u = 0; u < Unroll; ++u)
+        {
+            _dot[u]   = Isa::zero();
+            _xx[u]    = Isa::zero();
+            _yy[u]    = Isa::zero();
+            _sum_x[u] = Isa::zero();
+            _sum_y[u] = Isa::zero();
+            _min_x[u] = Isa::broadcast(std::numeric_limits<double>::infinity());
+            _min_y[u] = Isa::broadcast(std::numeric_limits<double>::infinity());
+            _max_x[u] = Isa::broadcast(-std::numeric_limits<double>::infinity());
+            _max_y[u] = Isa::broadcast(-std::numeric_limits<double>::infinity());
+        }
+
+        auto const accumulate = [&](size_t const i, size_t const u)
+        {
+            reg const _x = Isa::loadu(xd + i);
+            reg const _y = Isa::loadu(yd + i);
+            _dot[u] = Isa::fmadd(_x, _y, _dot[u]);
+            _xx[u]  = Isa::fmadd(_x, _x, _xx[u]);
+            _yy[u]  = Isa::fmadd(_y, _y, _yy[u]);
+            if constexpr (Extended == true)
+            {
+                _sum_x[u] = Isa::add(_sum_x[u], _x);
+                _sum_y[u] = Isa::add(_sum_y[u], _y);
+                _min_x[u] = Isa::min(_min_x[u], _x);
+                _min_y[u] = Isa::min(_min_y[u], _y);
+                _max_x[u] = Isa::max(_max_x[u], _x);
+                _max_y[u] = Isa::max(_max_y[u], _y);
+            }
+        };
+
+        #pragma omp for schedule(static) nowait
+        for (size_t i = 0; i < body; i += step)
+        {
+            #pragma GCC unroll 16
+            for (size_t u = 0; u < Unroll; ++u)
+            {
+                accumulate(i + u*width, u);
+            }
+        }
+
+        // remaining entire registers that do not fill an unrolled iteration
+        #pragma omp for schedule(static) nowait
+        for (size_t i = body; i < end; i += width)
+        {
+            accumulate(i, 0);
+        }
+
+        for (size_t u = 1; u < Unroll; ++u)
+        {
+            _dot[0]   = Isa::add(_dot[0], _dot[u]);
+            _xx[0]    = Isa::add(_xx[0],  _xx[u]);
+            _yy[0]    = Isa::add(_yy[0],  _yy[u]);
+            _sum_x[0] = Isa::add(_sum_x[0], _sum_x[u]);
+            _sum_y[0] = Isa::add(_sum_y[0], _sum_y[u]);
+            _min_x[0] = Isa::min(_min_x[0], _min_x[u]);
+            _min_y[0] = Isa::min(_min_y[0], _min_y[u]);
+            _max_x[0] = Isa::max(_max_x[0], _max_x[u]);
+            _max_y[0] = Isa::max(_max_y[0], _max_y[u]);
+        }
+
+        FusedSums part;
+        part.dot = Isa::reduce(_dot[0]);
+        part.xx  = Isa::reduce(_xx[0]);
+        part.yy  = Isa::reduce(_yy[0]);
+        if constexpr (Extended == true)
+        {
+            alignas(CACHE_LINE) double min_x[width], min_y[width], max_x[width], max_y[width];
+            Isa::storeu(min_x, _min_x[0]);
+            Isa::storeu(min_y, _min_y[0]);
+            Isa::storeu(max_x, _max_x[0]);
+            Isa::storeu(max_y, _max_y[0]);
+            part.sum_x = Isa::reduce(_sum_x[0]);
+            part.sum_y = Isa::reduce(_sum_y[0]);
+            part.min_x = *std::min_element(min_x, min_x + width);
+            part.min_y = *std::min_element(min_y, min_y + width);
+            part.max_x = *std::max_element(max_x, max_x + width);
+            part.max_y = *std::max_element(max_y, max_y + width);
+        }
+        res = combine_fused(res, part);
+    }
+
+    return res;
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // FUSED_H_INCLUDED
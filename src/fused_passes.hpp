@@ -0,0 +1,164 @@
+#ifndef FUSED_PASSES_H_INCLUDED
+#define FUSED_PASSES_H_INCLUDED
+
+/**
+ * \file     fused_passes.hpp
+ * \mainpage Benchmark of the cosine similarity computed by the fused single-pass kernels
+ *           (see fused.hpp) against three dot products (x,y), (x,x) and (y,y) of the
+ *           dispatched kernel for vectors fitting into the first and second level cache
+ *           as well as vectors residing in main memory. The fused kernels are benchmarked
+ *           with and without the sums, minima and maxima for every instruction set of the
+ *           host. The throughput counts the bytes of both vectors once, the data actually
+ *           streamed by the three dot products is twice as much for vectors in main memory.
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "fused.hpp"
+#include "random.hpp"
+
+
+/// number of elements processed per timed sample and kernel if the calls per sample are not given
+#define FUSED_ELEMENTS_PER_SAMPLE 10000000
+
+
+/**\struct FusedSettings
+ * \brief  Settings of the benchmark of the fused single-pass kernels
+*/
+struct FusedSettings
+{
+    std::vector<size_t>      lengths    = {4096, 65536, 16777216};  ///< numbers of elements per vector
+    size_t                   iterations = 0;                        ///< number of calls per timed sample, FUSED_ELEMENTS_PER_SAMPLE elements if 0
+    std::vector<std::string> ids;                                   ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv        = false;                    ///< print comma-separated values instead of a table
+};
+
+
+/**\struct FusedRow
+ * \brief  Result of a single kernel and length of the benchmark of the fused single-pass kernels
+*/
+struct FusedRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          length;       ///< number of elements per vector
+    BenchmarkResult res;          ///< statistics and throughput of the kernel
+    double          speedup;      ///< speed-up over three dot products
+    double          deviation;    ///< relative deviation of the cosine similarity from the one of three dot products
+};
+
+
+/**\fn         print_fused_row
+ * \brief      Print a row of the benchmark of the fused single-pass kernels (or the header
+ *             if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_fused_row(FusedRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,length,median_s,min_s,mad_s,gbs,gflops,speedup,rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(10) << "length"
+            << std::setw(14) << "median[us]" << std::setw(10) << "MAD%" << std::setw(10) << "GB/s"
+            << std::setw(10) << "GFLOP/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->length << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.gbs << "," << row->res.gflops << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(10) << row->length
+        << std::setprecision(3) << std::setw(14) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setw(10) << row->res.gbs << std::setw(10) << row->res.gflops
+        << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         run_fused_passes
+ * \brief      Benchmark the cosine similarity of the fused single-pass kernels of the
+ *             instruction sets supported by the host against three dot products for
+ *             vectors in the caches and in main memory
+ *
+ * \param[in]  fused      settings of the benchmark of the fused single-pass kernels
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_fused_passes(FusedSettings const &fused, BenchmarkSettings settings, std::ostream &out = std::cout)
+{
+    if (fused.csv == false)
+    {
+        out << "COSINE SIMILARITY IN A SINGLE PASS (" << FUSED_UNROLL
+            << " registers of both vectors per iteration, three dot products as reference)" << std::endl;
+    }
+    print_fused_row(nullptr, out, fused.csv);
+
+    KernelTable const& active = active_kernels();
+    for (size_t const n: fused.lengths)
+    {
+        settings.iterations = (fused.iterations > 0) ? fused.iterations : std::max<size_t>(1, FUSED_ELEMENTS_PER_SAMPLE/n);
+
+        AlignedBuffer<double> x(n), y(n);
+        random_fill(x.data(), n, 0);
+        random_fill(y.data(), n, 1);
+        std::span<double const> const xs(x.data(), n), ys(y.data(), n);
+
+        // what has to be done without fused kernels: a dot product per reduction
+        double expected = 0.0;
+        BenchmarkResult const reference = benchmark_callable([&]()
+        {
+            FusedSums r;
+            r.dot = active.dot_unaligned(xs, ys);
+            r.xx  = active.dot_unaligned(xs, xs);
+            r.yy  = active.dot_unaligned(ys, ys);
+            expected = cosine_from_fused(r);
+            return expected;
+        }, n, 2.0*sizeof(double), 6.0, settings);
+        FusedRow const reference_row = {std::string(active.id) + " three dot products", n, reference, 1.0, 0.0};
+        print_fused_row(&reference_row, out, fused.csv);
+
+        auto const row = [&](std::string const &name, dot_fused_fun const f, double const flops)
+        {
+            BenchmarkResult const res = benchmark_callable([&]()
+            {
+                return cosine_from_fused(f(xs, ys));
+            }, n, 2.0*sizeof(double), flops, settings);
+            FusedRow const r = {name, n, res, reference.stats.median/res.stats.median,
+                                std::abs(res.result - expected)/std::abs(expected)};
+            print_fused_row(&r, out, fused.csv);
+        };
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((fused.ids.empty() == false) && (std::find(fused.ids.begin(), fused.ids.end(), table->id) == fused.ids.end()))
+            {
+                continue;
+            }
+
+            std::string const id(table->id);
+            row(id + " fused", table->fused.norms, 6.0);
+            row(id + " fused + sum/min/max", table->fused.stats, 12.0);
+        }
+    }
+}
+
+#endif // FUSED_PASSES_H_INCLUDED
@@ -0,0 +1,462 @@
+#ifndef GEMM_H_INCLUDED
+#define GEMM_H_INCLUDED
+
+/**
+ * \file     gemm.hpp
+ * \brief    cache-blocked dense matrix product C = A·B (DGEMM and SGEMM)
+ * \mainpage Matrix product of a row-major m x k matrix A with a row-major k x n matrix B
+ *           built on the fused multiply-adds of the SIMD dot product kernels. Computing
+ *           every element of C by a separate dot product loads every row of A n times
+ *           and every column of B m times, here the operands are blocked for the cache
+ *           hierarchy instead (the loops of Goto's algorithm):
+ *           - B is split into blocks of GEMM_KC x GEMM_NC elements (L3 cache) that are
+ *             packed by all threads together into cache-aligned micro-panels of
+ *             Columns columns, element p of a micro-panel being Columns contiguous numbers.
+ *           - The rows of A are split into blocks of GEMM_MC x GEMM_KC elements (L2
+ *             cache) packed into micro-panels of Rows rows by the thread that needs them.
+ *           - The microkernel keeps a tile of Rows x Columns elements of C in registers:
+ *             for every element p of the depth it loads a row of the micro-panel of B
+ *             (L1 cache) and broadcasts the Rows elements of A, so that every load feeds
+ *             Rows fused multiply-adds.
+ *           The macro-tiles of GEMM_MC rows and GEMM_NB columns of C are distributed over
+ *           the threads. Partial tiles at the borders are padded with zeros when packing.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// depth of the packed panels (a micro-panel of B stays in the L1 cache)
+#define GEMM_KC 384
+
+/// number of rows of a packed block of A (stays in the L2 cache)
+#define GEMM_MC 192
+
+/// number of columns of a packed block of B (stays in the L3 cache)
+#define GEMM_NC 4096
+
+/// number of columns of a macro-tile of C handed out to a thread
+#define GEMM_NB 512
+
+/// number of rows and columns of the register tile of the kernels without manual vectorisation
+#define GEMM_SCALAR_ROWS    4
+#define GEMM_SCALAR_COLUMNS 8
+
+/// number of independent chains of fused multiply-adds per thread of the vectorised peak measurement
+#define GEMM_PEAK_CHAINS 10
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn         pack_gemm_a
+ * \brief      Pack a block of \p mc rows and \p kc columns of the row-major matrix \p a
+ *             into micro-panels of Rows rows (rows beyond \p mc are set to zero)
+ *
+ * \param[in]  a        pointer to the first element of the block
+ * \param[in]  lda      distance between two rows of \p a
+ * \param[in]  mc       number of rows of the block
+ * \param[in]  kc       number of columns of the block
+ * \param[out] packed   the micro-panels, element p of row r of panel i at i*Rows*kc + p*Rows + r
+*/
+template <size_t Rows, typename T>
+inline void pack_gemm_a(T const* const a, size_t const lda, size_t const mc, size_t const kc, T* const packed)
+{
+    for (size_t i = 0; i < mc; i += Rows)
+    {
+        T* const     panel = packed + i*kc;
+        size_t const rows  = std::min(Rows, mc - i);
+        for (size_t r = 0; r < Rows; ++r)
+        {
+            for (size_t p = 0; p < kc; ++p)
+            {
+                panel[p*Rows + r] = (r < rows) ? a[(i + r)*lda + p] : static_cast<T>(0);
+            }
+        }
+    }
+}
+
+
+/**\fn         pack_gemm_b
+ * \brief      Pack the micro-panel \p j of Columns columns of a block of \p kc rows and
+ *             \p nc columns of the row-major matrix \p b (columns beyond \p nc are set to zero)
+ *
+ * \param[in]  b        pointer to the first element of the block
+ * \param[in]  ldb      distance between two rows of \p b
+ * \param[in]  kc       number of rows of the block
+ * \param[in]  nc       number of columns of the block
+ * \param[in]  j        index of the micro-panel
+ * \param[out] packed   the micro-panels, element p of column c of panel j at j*Columns*kc + p*Columns + c
+*/
+template <size_t Columns, typename T>
+inline void pack_gemm_b(T const* const b, size_t const ldb, size_t const kc, size_t const nc, size_t const j,
+                        T* const packed)
+{
+    T* const     panel   = packed + j*Columns*kc;
+    size_t const first   = j*Columns;
+    size_t const columns = std::min(Columns, nc - first);
+    for (size_t p = 0; p < kc; ++p)
+    {
+        for (size_t c = 0; c < Columns; ++c)
+        {
+            panel[p*Columns + c] = (c < columns) ? b[p*ldb + first + c] : static_cast<T>(0);
+        }
+    }
+}
+
+
+/**\fn         omp_gemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) blocked for the cache hierarchy (see gemm.hpp), the tiles
+ *             of Rows x Columns elements of \p c being computed by \p tile
+ *
+ * \param[in]  a      the m x k matrix
+ * \param[in]  b      the k x n matrix
+ * \param[out] c      the m x n product
+ * \param[in]  m      number of rows of \p a and \p c
+ * \param[in]  n      number of columns of \p b and \p c
+ * \param[in]  k      number of columns of \p a and rows of \p b
+ * \param[in]  tile   callable (kc, a panel, b panel, c, ldc, rows, columns, accumulate) computing a tile
+*/
+template <size_t Rows, size_t Columns, typename T, typename Tile>
+void omp_gemm(std::span<T const> const &a, std::span<T const> const &b, std::span<T> const &c,
+              size_t const m, size_t const n, size_t const k, Tile const &tile)
+{
+    static_assert((GEMM_MC % Rows == 0) && (GEMM_NB % Columns == 0) && (GEMM_NC % GEMM_NB == 0),
+                  "The blocks must consist of entire tiles");
+    assert((a.size() == m*k) && (b.size() == k*n) && (c.size() == m*n));
+
+    if (k == 0)
+    {
+        std::fill(c.begin(), c.end(), static_cast<T>(0));
+        return;
+    }
+
+    size_t const kc_max = std::min<size_t>(GEMM_KC, k);
+    size_t const nc_max = std::min<size_t>(GEMM_NC, (n + Columns - 1)/Columns*Columns);
+    size_t const mc_max = std::min<size_t>(GEMM_MC, (m + Rows - 1)/Rows*Rows);
+    KernelVector<T> b_packed(kc_max*nc_max);
+
+    #pragma omp parallel shared(a, b, c, b_packed)
+    {
+        KernelVector<T> a_packed(mc_max*kc_max);
+
+        for (size_t jc = 0; jc < n; jc += GEMM_NC)
+        {
+            size_t const nc     = std::min<size_t>(GEMM_NC, n - jc);
+            size_t const panels = (nc + Columns - 1)/Columns;
+            size_t const blocks = (nc + GEMM_NB - 1)/GEMM_NB;
+
+            for (size_t pc = 0; pc < k; pc += GEMM_KC)
+            {
+                size_t const kc = std::min<size_t>(GEMM_KC, k - pc);
+
+                #pragma omp for schedule(static)
+                for (size_t j = 0; j < panels; ++j)
+                {
+                    pack_gemm_b<Columns>(b.data() + pc*n + jc, n, kc, nc, j, b_packed.data());
+                }
+
+                // macro-tiles of the same rows are consecutive, so that a thread packs a block of A only once
+                size_t packed_ic = m;
+                #pragma omp for schedule(static) collapse(2)
+                for (size_t ic = 0; ic < m; ic += GEMM_MC)
+                {
+                    for (size_t jb = 0; jb < blocks; ++jb)
+                    {
+                        size_t const mc = std::min<size_t>(GEMM_MC, m - ic);
+                        if (packed_ic != ic)
+                        {
+                            pack_gemm_a<Rows>(a.data() + ic*k + pc, k, mc, kc, a_packed.data());
+                            packed_ic = ic;
+                        }
+
+                        size_t const j_end = std::min(panels, (jb + 1)*GEMM_NB/Columns);
+                        for (size_t j = jb*GEMM_NB/Columns; j < j_end; ++j)
+                        {
+                            size_t const columns = std::min(Columns, nc - j*Columns);
+                            for (size_t i = 0; i < mc; i += Rows)
+                            {
+                                tile(kc, a_packed.data() + i*kc, b_packed.data() + j*Columns*kc,
+                                     c.data() + (ic + i)*n + jc + j*Columns, n,
+                                     std::min(Rows, mc - i), columns, pc > 0);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/**\fn         scalar_gemm_tile
+ * \brief      Calculate a tile of Rows x Columns elements of the matrix product from a
+ *             micro-panel of A and one of B without manual vectorisation
+ *
+ * \param[in]  kc           depth of the micro-panels
+ * \param[in]  a            the micro-panel of A (Rows elements per step)
+ * \param[in]  b            the micro-panel of B (Columns elements per step)
+ * \param[out] c            pointer to the first element of the tile of C
+ * \param[in]  ldc          distance between two rows of \p c
+ * \param[in]  rows         number of valid rows of the tile
+ * \param[in]  columns      number of valid columns of the tile
+ * \param[in]  accumulate   add the tile to \p c instead of overwriting it
+*/
+template <size_t Rows, size_t Columns, typename T>
+inline void scalar_gemm_tile(size_t const kc, T const* const a, T const* const b, T* const c, size_t const ldc,
+                             size_t const rows, size_t const columns, bool const accumulate)
+{
+    T acc[Rows][Columns] = {};
+    for (size_t p = 0; p < kc; ++p)
+    {
+        for (size_t r = 0; r < Rows; ++r)
+        {
+            #pragma omp simd
+            for (size_t j = 0; j < Columns; ++j)
+            {
+                acc[r][j] += a[p*Rows + r]*b[p*Columns + j];
+            }
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        for (size_t j = 0; j < columns; ++j)
+        {
+            c[r*ldc + j] = (accumulate == true) ? c[r*ldc + j] + acc[r][j] : acc[r][j];
+        }
+    }
+}
+
+
+/**\fn         scalar_omp_gemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) (see omp_gemm) without manual vectorisation
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+template <typename T>
+inline void scalar_omp_gemm(std::span<T const> const &a, std::span<T const> const &b, std::span<T> const &c,
+                            size_t const m, size_t const n, size_t const k)
+{
+    omp_gemm<GEMM_SCALAR_ROWS, GEMM_SCALAR_COLUMNS>(a, b, c, m, n, k,
+                                                    scalar_gemm_tile<GEMM_SCALAR_ROWS, GEMM_SCALAR_COLUMNS, T>);
+}
+
+
+/**\fn         simd_gemm_tile
+ * \brief      Calculate a tile of Rows x (2 registers) elements of the matrix product from
+ *             a micro-panel of A and one of B with the instruction set \p Isa: the tile is
+ *             kept in registers, a step loads two registers of B and broadcasts the Rows
+ *             elements of A
+ *
+ * \param[in]  kc           depth of the micro-panels
+ * \param[in]  a            the micro-panel of A (Rows elements per step)
+ * \param[in]  b            the cache-aligned micro-panel of B (two registers per step)
+ * \param[out] c            pointer to the first element of the tile of C
+ * \param[in]  ldc          distance between two rows of \p c
+ * \param[in]  rows         number of valid rows of the tile
+ * \param[in]  columns      number of valid columns of the tile
+ * \param[in]  accumulate   add the tile to \p c instead of overwriting it
+*/
+template <typename Isa, size_t Rows>
+inline void simd_gemm_tile(size_t const kc, typename Isa::value_type const* const a,
+                           typename Isa::value_type const* const b, typename Isa::value_type* const c,
+                           size_t const ldc, size_t const rows, size_t const columns, bool const accumulate)
+{
+    typedef typename Isa::value_type T;
+    typedef typename Isa::reg        reg;
+    constexpr size_t width   = Isa::width;
+    constexpr size_t Columns = 2*width;
+
+    reg _c0[Rows];
+    reg _c1[Rows];
+    for (size_t r = 0; r < Rows; ++r)
+    {
+        _c0[r] = Isa::zero();
+        _c1[r] = Isa::zero();
+    }
+    for (size_t p = 0; p < kc; ++p)
+    {
+        reg const _b0 = Isa::load(b + p*Columns);
+        reg const _b1 = Isa::load(b + p*Columns + width);
+        #pragma GCC unroll 16
+        for (size_t r = 0; r < Rows; ++r)
+        {
+            reg const _a = Isa::broadcast(a[p*Rows + r]);
+            _c0[r] = Isa::fmadd(_a, _b0, _c0[r]);
+            _c1[r] = Isa::fmadd(_a, _b1, _c1[r]);
+        }
+    }
+
+    if ((rows == Rows) && (columns == Columns))
+    {
+        for (size_t r = 0; r < Rows; ++r)
+        {
+            T* const row = c + r*ldc;
+            Isa::storeu(row,         (accumulate == true) ? Isa::add(Isa::loadu(row),         _c0[r]) : _c0[r]);
+            Isa::storeu(row + width, (accumulate == true) ? Isa::add(Isa::loadu(row + width), _c1[r]) : _c1[r]);
+        }
+        return;
+    }
+
+    // partial tile at the border of C
+    alignas(CACHE_LINE) T buffer[Rows*Columns];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        Isa::storeu(buffer + r*Columns,         _c0[r]);
+        Isa::storeu(buffer + r*Columns + width, _c1[r]);
+        for (size_t j = 0; j < columns; ++j)
+        {
+            c[r*ldc + j] = (accumulate == true) ? c[r*ldc + j] + buffer[r*Columns + j] : buffer[r*Columns + j];
+        }
+    }
+}
+
+
+/**\fn         simd_omp_gemm
+ * \brief      Calculate the matrix product c = a·b of the row-major matrices \p a (m x k)
+ *             and \p b (k x n) (see omp_gemm) with the instruction set \p Isa and a register
+ *             tile of Rows x (2 registers) elements
+ *
+ * \param[in]  a   the m x k matrix
+ * \param[in]  b   the k x n matrix
+ * \param[out] c   the m x n product
+ * \param[in]  m   number of rows of \p a and \p c
+ * \param[in]  n   number of columns of \p b and \p c
+ * \param[in]  k   number of columns of \p a and rows of \p b
+*/
+template <typename Isa, size_t Rows>
+inline void simd_omp_gemm(std::span<typename Isa::value_type const> const &a,
+                          std::span<typename Isa::value_type const> const &b,
+                          std::span<typename Isa::value_type> const &c, size_t const m, size_t const n, size_t const k)
+{
+    omp_gemm<Rows, 2*Isa::width>(a, b, c, m, n, k, simd_gemm_tile<Isa, Rows>);
+}
+
+
+/**\fn         scalar_omp_peak
+ * \brief      Run as many independent chains of \p iterations multiply-adds per thread as
+ *             the register tile of scalar_omp_gemm has elements (multiplication and
+ *             addition are not fused without manual vectorisation, so that more chains
+ *             are needed to hide their latency) to measure the attainable peak
+ *             performance of the arithmetic
+ *
+ * \param[in]  iterations   number of multiply-adds per chain
+ * \param[out] flops        number of floating point operations that were performed
+ * \return     Checksum of the chains
+*/
+template <typename T>
+inline double scalar_omp_peak(size_t const iterations, double &flops)
+{
+    constexpr size_t chains = GEMM_SCALAR_ROWS*GEMM_SCALAR_COLUMNS;
+
+    double sum = 0.0;
+    size_t threads = 1;
+
+    #pragma omp parallel reduction(+: sum)
+    {
+        #pragma omp single
+        threads = omp_get_num_threads();
+
+        T acc[chains];
+        for (size_t i = 0; i < chains; ++i)
+        {
+            acc[i] = static_cast<T>(i);
+        }
+        T const factor = static_cast<T>(0.999);
+        T const addend = static_cast<T>(0.001);
+        for (size_t n = 0; n < iterations; ++n)
+        {
+            #pragma omp simd
+            for (size_t i = 0; i < chains; ++i)
+            {
+                acc[i] = acc[i]*factor + addend;
+            }
+        }
+        for (size_t i = 0; i < chains; ++i)
+        {
+            sum += acc[i];
+        }
+    }
+
+    flops = 2.0*threads*iterations*chains;
+    return sum;
+}
+
+
+/**\fn         simd_omp_peak
+ * \brief      Run GEMM_PEAK_CHAINS independent chains of \p iterations fused multiply-adds
+ *             of registers per thread with the instruction set \p Isa to measure the
+ *             attainable peak performance of the arithmetic
+ *
+ * \param[in]  iterations   number of fused multiply-adds per chain
+ * \param[out] flops        number of floating point operations that were performed
+ * \return     Checksum of the chains
+*/
+template <typename Isa>
+inline double simd_omp_peak(size_t const iterations, double &flops)
+{
+    typedef typename Isa::value_type T;
+    typedef typename Isa::reg        reg;
+
+    double sum = 0.0;
+    size_t threads = 1;
+
+    #pragma omp parallel reduction(+: sum)
+    {
+        #pragma omp single
+        threads = omp_get_num_threads();
+
+        reg _acc[GEMM_PEAK_CHAINS];
+        for (size_t i = 0; i < GEMM_PEAK_CHAINS; ++i)
+        {
+            _acc[i] = Isa::broadcast(static_cast<T>(i));
+        }
+        reg const _factor = Isa::broadcast(static_cast<T>(0.999));
+        reg const _addend = Isa::broadcast(static_cast<T>(0.001));
+        for (size_t n = 0; n < iterations; ++n)
+        {
+            #pragma GCC unroll 16
+            for (size_t i = 0; i < GEMM_PEAK_CHAINS; ++i)
+            {
+                _acc[i] = Isa::fmadd(_acc[i], _factor, _addend);
+            }
+        }
+        for (size_t i = 0; i < GEMM_PEAK_CHAINS; ++i)
+        {
+            sum += Isa::reduce(_acc[i]);
+        }
+    }
+
+    flops = 2.0*threads*iterations*GEMM_PEAK_CHAINS*Isa::width;
+    return sum;
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // GEMM_H_INCLUDED
@@ -0,0 +1,268 @@
+#ifndef GEMM_SIZES_H_INCLUDED
+#define GEMM_SIZES_H_INCLUDED
+
+/**
+ * \file     gemm_sizes.hpp
+ * \mainpage Benchmark of the cache-blocked matrix product (see gemm.hpp) for square
+ *           matrices of 64 rows up to a maximum size in steps of a factor of two. For
+ *           every instruction set of the host the attainable peak performance of its
+ *           fused multiply-adds is measured first (independent chains in registers), the
+ *           GFLOP/s of DGEMM and SGEMM are reported as a fraction of it. For small
+ *           matrices computing every element of C by a call of the dot product kernel is
+ *           benchmarked as well. The largest deviation from a plain triple loop in
+ *           double precision relative to the largest element of C is printed as a check.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "gemm.hpp"
+#include "init.hpp"
+
+
+/// number of fused multiply-adds per chain of a call of the peak measurement
+#define GEMM_PEAK_ITERATIONS 10000000
+
+
+/**\struct GemmSettings
+ * \brief  Settings of the benchmark of the matrix product
+*/
+struct GemmSettings
+{
+    size_t                   max_size     = 2048;   ///< number of rows and columns of the largest matrices
+    size_t                   max_dot_size = 256;    ///< largest matrices for which a dot product per element is benchmarked
+    std::vector<std::string> ids;                   ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv          = false;  ///< print comma-separated values instead of a table
+};
+
+
+/**\struct GemmRow
+ * \brief  Result of a single kernel and size of the benchmark of the matrix product
+*/
+struct GemmRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          size;         ///< number of rows and columns of the matrices
+    BenchmarkResult res;          ///< statistics and throughput of the kernel for the entire product
+    double          peak;         ///< attainable peak performance of the instruction set in GFLOP/s
+    double          deviation;    ///< largest deviation from the reference relative to its largest element
+};
+
+
+/**\fn         print_gemm_row
+ * \brief      Print a row of the benchmark of the matrix product (or the header if \p row
+ *             is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_gemm_row(GemmRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,size,median_s,min_s,mad_s,gflops,peak_gflops,fraction_of_peak,max_rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(8) << "size"
+            << std::setw(14) << "median[us]" << std::setw(10) << "MAD%" << std::setw(10) << "GFLOP/s"
+            << std::setw(10) << "peak" << std::setw(10) << "of peak%" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->size << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.gflops << "," << row->peak << "," << row->res.gflops/row->peak << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(8) << row->size
+        << std::setprecision(3) << std::setw(14) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setw(10) << row->res.gflops << std::setw(10) << row->peak
+        << std::setw(10) << 100.0*row->res.gflops/row->peak << std::scientific << std::setprecision(3)
+        << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         reference_gemm
+ * \brief      Calculate the matrix product c = a·b of the square row-major matrices \p a
+ *             and \p b of \p size rows by a plain triple loop in double precision
+ *
+ * \param[in]  a      the first matrix
+ * \param[in]  b      the second matrix
+ * \param[in]  size   number of rows and columns of the matrices
+ * \return     The product
+*/
+template <typename T>
+inline std::vector<double> reference_gemm(T const* const a, T const* const b, size_t const size)
+{
+    std::vector<double> c(size*size, 0.0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < size; ++i)
+    {
+        for (size_t p = 0; p < size; ++p)
+        {
+            double const a_ip = a[i*size + p];
+            for (size_t j = 0; j < size; ++j)
+            {
+                c[i*size + j] += a_ip*b[p*size + j];
+            }
+        }
+    }
+    return c;
+}
+
+
+/**\fn         gemm_deviation
+ * \brief      Largest deviation of the product \p c from the \p reference relative to the
+ *             largest element of the reference
+ *
+ * \param[in]  c           the product
+ * \param[in]  reference   the reference product
+ * \return     The relative deviation
+*/
+template <typename T>
+inline double gemm_deviation(T const* const c, std::vector<double> const &reference)
+{
+    double deviation = 0.0;
+    double largest   = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        deviation = std::max(deviation, std::abs(c[i] - reference[i]));
+        largest   = std::max(largest, std::abs(reference[i]));
+    }
+    return (largest > 0.0) ? deviation/largest : deviation;
+}
+
+
+/**\fn         run_gemm_sizes
+ * \brief      Benchmark the matrix products of the instruction sets supported by the host
+ *             for square matrices of increasing size against their peak performance
+ *
+ * \param[in]  gemm       settings of the benchmark of the matrix product
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_gemm_sizes(GemmSettings const &gemm, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (gemm.csv == false)
+    {
+        out << "MATRIX PRODUCT (square matrices, blocks of " << GEMM_MC << " x " << GEMM_KC << " of A and "
+            << GEMM_KC << " x " << GEMM_NC << " of B, peak measured by independent fused multiply-adds)" << std::endl;
+    }
+    print_gemm_row(nullptr, out, gemm.csv);
+
+    std::vector<KernelTable const*> tables;
+    std::vector<double>             peaks;
+    std::vector<double>             peaks_float;
+    for (KernelTable const* table: available_kernels())
+    {
+        if ((gemm.ids.empty() == true) || (std::find(gemm.ids.begin(), gemm.ids.end(), table->id) != gemm.ids.end()))
+        {
+            for (dot_peak_fun const peak: {table->peak, table->peak_float})
+            {
+                double flops = 0.0;
+                peak(GEMM_PEAK_ITERATIONS, flops);
+                BenchmarkResult const res = benchmark_callable([peak]()
+                {
+                    double unused_flops = 0.0;
+                    return peak(GEMM_PEAK_ITERATIONS, unused_flops);
+                }, static_cast<size_t>(flops), 0.0, 1.0, settings);
+                ((peak == table->peak) ? peaks : peaks_float).push_back(res.gflops);
+            }
+            tables.push_back(table);
+        }
+    }
+
+    for (size_t size = 64; size <= gemm.max_size; size *= 2)
+    {
+        size_t const elements = size*size;
+        double const flops    = 2.0*size;
+
+        AlignedBuffer<double> a(init_vec<double>(elements));
+        AlignedBuffer<double> b(init_vec<double>(elements, 1));
+        AlignedBuffer<double> b_t(elements);
+        AlignedBuffer<double> c(elements);
+        AlignedBuffer<float>  a_float(elements);
+        AlignedBuffer<float>  b_float(elements);
+        AlignedBuffer<float>  c_float(elements);
+        for (size_t i = 0; i < elements; ++i)
+        {
+            b_t[(i % size)*size + i/size] = b[i];
+            a_float[i] = static_cast<float>(a[i]);
+            b_float[i] = static_cast<float>(b[i]);
+        }
+        std::span<double const> const a_span(a.data(), elements);
+        std::span<double const> const b_span(b.data(), elements);
+        std::span<double const> const b_t_span(b_t.data(), elements);
+        std::span<float const> const  a_float_span(a_float.data(), elements);
+        std::span<float const> const  b_float_span(b_float.data(), elements);
+
+        std::vector<double> const reference       = reference_gemm(a.data(), b.data(), size);
+        std::vector<double> const reference_float = reference_gemm(a_float.data(), b_float.data(), size);
+
+        for (size_t t = 0; t < tables.size(); ++t)
+        {
+            KernelTable const &table = *tables[t];
+
+            if (size <= gemm.max_dot_size)
+            {
+                BenchmarkResult const res = benchmark_callable([&]()
+                {
+                    for (size_t i = 0; i < size; ++i)
+                    {
+                        for (size_t j = 0; j < size; ++j)
+                        {
+                            c[i*size + j] = table.dot_unaligned(a_span.subspan(i*size, size), b_t_span.subspan(j*size, size));
+                        }
+                    }
+                    return c[0];
+                }, elements, 0.0, flops, settings);
+                GemmRow const row = {std::string(table.id) + " dot per element", size, res, peaks[t],
+                                     gemm_deviation(c.data(), reference)};
+                print_gemm_row(&row, out, gemm.csv);
+            }
+
+            BenchmarkResult const res = benchmark_callable([&]()
+            {
+                table.dgemm(a_span, b_span, std::span<double>(c.data(), elements), size, size, size);
+                return c[0];
+            }, elements, 0.0, flops, settings);
+            GemmRow const row = {std::string(table.id) + " dgemm", size, res, peaks[t], gemm_deviation(c.data(), reference)};
+            print_gemm_row(&row, out, gemm.csv);
+
+            BenchmarkResult const res_float = benchmark_callable([&]()
+            {
+                table.sgemm(a_float_span, b_float_span, std::span<float>(c_float.data(), elements), size, size, size);
+                return c_float[0];
+            }, elements, 0.0, flops, settings);
+            GemmRow const row_float = {std::string(table.id) + " sgemm", size, res_float, peaks_float[t],
+                                       gemm_deviation(c_float.data(), reference_float)};
+            print_gemm_row(&row_float, out, gemm.csv);
+        }
+    }
+}
+
+#endif // GEMM_SIZES_H_INCLUDED
@@ -0,0 +1,401 @@
+#ifndef GEMV_H_INCLUDED
+#define GEMV_H_INCLUDED
+
+/**
+ * \file     gemv.hpp
+ * \brief    dot products of a single vector with many vectors (matrix-vector product)
+ * \mainpage One-vs-many dot products r_j = y_j·x of a vector x with the k rows y_j of a
+ *           dense matrix (GEMV). Calling a dot product kernel k times loads x k times
+ *           from memory, here several rows are register-blocked instead so that every
+ *           load of x feeds several fused multiply-adds:
+ *           - Row-major (the rows y_j are contiguous): Rows rows are processed at once,
+ *             every register of x is multiplied with a register of each of the rows.
+ *           - Column-major (element i of all rows is contiguous): Columns elements of x
+ *             are broadcast at once and multiplied with every register of a panel of
+ *             results that stays in the L1 cache while the columns are streamed.
+ *           Row-major matrices are distributed over the threads by blocks of rows if
+ *           there are enough of them, column-major ones by columns if there are enough
+ *           of them, otherwise the other dimension is split. Partial results of split
+ *           rows are added up in the order of the threads.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of rows of a column-major matrix whose results stay in the L1 cache while streaming through the columns
+#define GEMV_ROW_PANEL 1024
+
+/// minimum number of columns per thread for splitting a column-major matrix by columns instead of rows
+#define GEMV_COLUMNS_PER_THREAD 8
+
+
+/**\enum  Layout
+ * \brief Storage order of a dense matrix
+*/
+enum class Layout
+{
+    row_major,  ///< the rows are contiguous
+    col_major   ///< the columns are contiguous
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn         split_range
+ * \brief      Part of the \p n rows or columns a thread \p t of \p threads computes if
+ *             they are split among the threads, rounded to entire registers of \p width
+ *             elements
+ *
+ * \param[in]  n         number of rows or columns
+ * \param[in]  width     number of elements of a register
+ * \param[in]  t         number of the thread
+ * \param[in]  threads   number of threads
+ * \param[out] begin     first row or column of the thread
+ * \param[out] end       row or column behind the last one of the thread
+*/
+inline void split_range(size_t const n, size_t const width, size_t const t, size_t const threads,
+                        size_t &begin, size_t &end)
+{
+    size_t const per_thread = (n + threads*width - 1)/(threads*width)*width;
+    begin = std::min(n, t*per_thread);
+    end   = std::min(n, begin + per_thread);
+}
+
+
+/**\fn         add_partial_results
+ * \brief      Add up the partial results \p partial of \p threads threads (\p rows each)
+ *             in the order of the threads
+ *
+ * \param[in]  partial   the partial results, thread by thread
+ * \param[in]  threads   number of threads
+ * \param[out] r         the results
+*/
+inline void add_partial_results(KernelVector<double> const &partial, size_t const threads, std::span<double> const &r)
+{
+    size_t const rows = r.size();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < rows; ++j)
+    {
+        double res = 0.0;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            res += partial[t*rows + j];
+        }
+        r[j] = res;
+    }
+}
+
+
+/**\fn         scalar_omp_gemv
+ * \brief      Calculate the dot products r_j = y_j·x of \p x with all rows y_j of the
+ *             matrix \p a stored in \p layout without manual vectorisation
+ *
+ * \param[in]  a        the matrix of r.size() rows and x.size() columns
+ * \param[in]  layout   storage order of the matrix
+ * \param[in]  x        the shared operand
+ * \param[out] r        the dot products of all rows
+*/
+inline void scalar_omp_gemv(std::span<double const> const &a, Layout const layout,
+                            std::span<double const> const &x, std::span<double> const &r)
+{
+    size_t const rows = r.size();
+    size_t const cols = x.size();
+    assert(a.size() == rows*cols);
+
+    if (layout == Layout::row_major)
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t j = 0; j < rows; ++j)
+        {
+            double res = 0.0;
+            for (size_t i = 0; i < cols; ++i)
+            {
+                res += a[j*cols + i]*x[i];
+            }
+            r[j] = res;
+        }
+        return;
+    }
+
+    size_t const        threads = omp_get_max_threads();
+    KernelVector<double> partial(threads*rows, 0.0);
+
+    #pragma omp parallel
+    {
+        size_t c0 = 0;
+        size_t c1 = 0;
+        split_range(cols, 1, omp_get_thread_num(), omp_get_num_threads(), c0, c1);
+
+        double* const p = partial.data() + omp_get_thread_num()*rows;
+        for (size_t i = c0; i < c1; ++i)
+        {
+            for (size_t j = 0; j < rows; ++j)
+            {
+                p[j] += a[i*rows + j]*x[i];
+            }
+        }
+    }
+
+    add_partial_results(partial, threads, r);
+}
+
+
+/**\fn         simd_gemv_rows
+ * \brief      Calculate the partial dot products of the columns [\p c0, \p c1) of \p Rows
+ *             consecutive rows of a row-major matrix starting at \p a with \p x: every
+ *             register of x is multiplied with a register of each of the rows
+ *
+ * \param[in]  a      pointer to the first element of the first row
+ * \param[in]  cols   number of columns of the matrix (distance between the rows)
+ * \param[in]  x      pointer to the first element of x
+ * \param[in]  c0     first column
+ * \param[in]  c1     column behind the last column
+ * \param[out] r      the \p Rows partial dot products
+*/
+template <typename Isa, size_t Rows>
+inline void simd_gemv_rows(double const* const a, size_t const cols, double const* const x,
+                           size_t const c0, size_t const c1, double* const r)
+{
+    typedef typename Isa::reg reg;
+    constexpr size_t width = Isa::width;
+    size_t const     body  = c0 + (c1 - c0)/width*width;
+
+    reg _acc[Rows];
+    for (size_t j = 0; j < Rows; ++j)
+    {
+        _acc[j] = Isa::zero();
+    }
+
+    for (size_t i = c0; i < body; i += width)
+    {
+        reg const _x = Isa::loadu(x + i);
+        #pragma GCC unroll 16
+        for (size_t j = 0; j < Rows; ++j)
+        {
+            _acc[j] = Isa::fmadd(Isa::loadu(a + j*cols + i), _x, _acc[j]);
+        }
+    }
+    if (body < c1)
+    {
+        reg const _x = Isa::load_partial(x + body, c1 - body);
+        for (size_t j = 0; j < Rows; ++j)
+        {
+            _acc[j] = Isa::fmadd(Isa::load_partial(a + j*cols + body, c1 - body), _x, _acc[j]);
+        }
+    }
+
+    for (size_t j = 0; j < Rows; ++j)
+    {
+        r[j] = Isa::reduce(_acc[j]);
+    }
+}
+
+
+/**\fn         simd_gemv_panel
+ * \brief      Add the products of the \p Columns columns starting from \p i of the rows
+ *             [\p jb, \p je) of a column-major matrix \p a with the corresponding
+ *             elements of \p x to \p r: the elements of x are broadcast once and each of
+ *             them is multiplied with every register of the rows
+ *
+ * \param[in]  a      pointer to the first element of the matrix
+ * \param[in]  rows   number of rows of the matrix (distance between the columns)
+ * \param[in]  x      pointer to the first element of x
+ * \param[in]  i      first column
+ * \param[in]  jb     first row
+ * \param[in]  je     row behind the last row
+ * \param[out] r      the dot products of all rows (accumulated)
+*/
+template <typename Isa, size_t Columns>
+inline void simd_gemv_panel(double const* const a, size_t const rows, double const* const x, size_t const i,
+                            size_t const jb, size_t const je, double* const r)
+{
+    typedef typename Isa::reg reg;
+    constexpr size_t width = Isa::width;
+    size_t const     body  = jb + (je - jb)/width*width;
+
+    reg _x[Columns];
+    for (size_t c = 0; c < Columns; ++c)
+    {
+        _x[c] = Isa::broadcast(x[i + c]);
+    }
+    for (size_t j = jb; j < body; j += width)
+    {
+        reg _r = Isa::loadu(r + j);
+        #pragma GCC unroll 16
+        for (size_t c = 0; c < Columns; ++c)
+        {
+            _r = Isa::fmadd(Isa::loadu(a + (i + c)*rows + j), _x[c], _r);
+        }
+        Isa::storeu(r + j, _r);
+    }
+    for (size_t j = body; j < je; ++j)
+    {
+        for (size_t c = 0; c < Columns; ++c)
+        {
+            r[j] += a[(i + c)*rows + j]*x[i + c];
+        }
+    }
+}
+
+
+/**\fn         simd_gemv_cols
+ * \brief      Add the partial dot products of the columns [\p c0, \p c1) of the rows
+ *             [\p j0, \p j1) of a column-major matrix \p a with \p x to \p r: the rows are
+ *             processed in panels of GEMV_ROW_PANEL rows that stay in the L1 cache while
+ *             the columns are streamed through \p Columns at a time (see simd_gemv_panel)
+ *
+ * \param[in]  a      pointer to the first element of the matrix
+ * \param[in]  rows   number of rows of the matrix (distance between the columns)
+ * \param[in]  x      pointer to the first element of x
+ * \param[in]  j0     first row
+ * \param[in]  j1     row behind the last row
+ * \param[in]  c0     first column
+ * \param[in]  c1     column behind the last column
+ * \param[out] r      the dot products of all rows (accumulated)
+*/
+template <typename Isa, size_t Columns>
+inline void simd_gemv_cols(double const* const a, size_t const rows, double const* const x, size_t const j0,
+                           size_t const j1, size_t const c0, size_t const c1, double* const r)
+{
+    for (size_t jb = j0; jb < j1; jb += GEMV_ROW_PANEL)
+    {
+        size_t const je = std::min(j1, jb + GEMV_ROW_PANEL);
+        size_t       i  = c0;
+        for (; i + Columns <= c1; i += Columns)
+        {
+            simd_gemv_panel<Isa, Columns>(a, rows, x, i, jb, je, r);
+        }
+        for (; i < c1; ++i)
+        {
+            simd_gemv_panel<Isa, 1>(a, rows, x, i, jb, je, r);
+        }
+    }
+}
+
+
+/**\fn         simd_omp_gemv
+ * \brief      Calculate the dot products r_j = y_j·x of \p x with all rows y_j of the
+ *             matrix \p a stored in \p layout with the instruction set \p Isa:
+ *             \p Rows rows of a row-major matrix and \p Columns columns of a
+ *             column-major matrix are register-blocked
+ *
+ * \param[in]  a        the matrix of r.size() rows and x.size() columns
+ * \param[in]  layout   storage order of the matrix
+ * \param[in]  x        the shared operand
+ * \param[out] r        the dot products of all rows
+*/
+template <typename Isa, size_t Rows, size_t Columns>
+inline void simd_omp_gemv(std::span<double const> const &a, Layout const layout,
+                          std::span<double const> const &x, std::span<double> const &r)
+{
+    static_assert((Rows > 0) && (Columns > 0), "At least a single row and column are required");
+
+    size_t const rows    = r.size();
+    size_t const cols    = x.size();
+    size_t const threads = omp_get_max_threads();
+    assert(a.size() == rows*cols);
+
+    if (layout == Layout::col_major)
+    {
+        // enough columns: every thread streams through a contiguous part of the matrix
+        if (cols >= GEMV_COLUMNS_PER_THREAD*threads)
+        {
+            KernelVector<double> partial(threads*rows, 0.0);
+
+            #pragma omp parallel
+            {
+                size_t c0 = 0;
+                size_t c1 = 0;
+                split_range(cols, 1, omp_get_thread_num(), omp_get_num_threads(), c0, c1);
+                simd_gemv_cols<Isa, Columns>(a.data(), rows, x.data(), 0, rows, c0, c1,
+                                             partial.data() + omp_get_thread_num()*rows);
+            }
+
+            add_partial_results(partial, threads, r);
+            return;
+        }
+
+        // few long columns: the rows are split among the threads
+        std::fill(r.begin(), r.end(), 0.0);
+
+        #pragma omp parallel
+        {
+            size_t j0 = 0;
+            size_t j1 = 0;
+            split_range(rows, Isa::width, omp_get_thread_num(), omp_get_num_threads(), j0, j1);
+            simd_gemv_cols<Isa, Columns>(a.data(), rows, x.data(), j0, j1, 0, cols, r.data());
+        }
+        return;
+    }
+
+    // computes the rows [j, j + Rows) or less of the columns [c0, c1)
+    size_t const units = (rows + Rows - 1)/Rows;
+    auto const   unit  = [&](size_t const j, size_t const c0, size_t const c1, double* const res)
+    {
+        if (j + Rows <= rows)
+        {
+            simd_gemv_rows<Isa, Rows>(a.data() + j*cols, cols, x.data(), c0, c1, res);
+            return;
+        }
+        for (size_t k = j; k < rows; ++k)
+        {
+            simd_gemv_rows<Isa, 1>(a.data() + k*cols, cols, x.data(), c0, c1, res + (k - j));
+        }
+    };
+
+    // enough blocks of rows for all threads: every row is computed by a single thread
+    if (units >= threads)
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t u = 0; u < units; ++u)
+        {
+            unit(u*Rows, 0, cols, r.data() + u*Rows);
+        }
+        return;
+    }
+
+    // few long rows: the columns are split among the threads
+    KernelVector<double> partial(threads*rows, 0.0);
+
+    #pragma omp parallel
+    {
+        size_t c0 = 0;
+        size_t c1 = 0;
+        split_range(cols, Isa::width, omp_get_thread_num(), omp_get_num_threads(), c0, c1);
+
+        double* const p = partial.data() + omp_get_thread_num()*rows;
+        for (size_t u = 0; (u < units) && (c0 < c1); ++u)
+        {
+            unit(u*Rows, c0, c1, p + u*Rows);
+        }
+    }
+
+    add_partial_results(partial, threads, r);
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // GEMV_H_INCLUDED
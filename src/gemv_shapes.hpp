@@ -0,0 +1,198 @@
+#ifndef GEMV_SHAPES_H_INCLUDED
+#define GEMV_SHAPES_H_INCLUDED
+
+/**
+ * \file     gemv_shapes.hpp
+ * \mainpage Benchmark of the register-blocked one-vs-many dot products (see gemv.hpp)
+ *           for matrices of the same number of elements but different shapes, from a
+ *           few long rows to many short ones. For every instruction set of the host
+ *           calling the dot product kernel once per row is compared to the GEMV
+ *           kernel for a row-major and a column-major matrix. The throughput refers to
+ *           the compulsory traffic (matrix and x once), besides it the speed-up over
+ *           the repeated dot products and the largest relative deviation from their
+ *           results are reported.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "gemv.hpp"
+#include "init.hpp"
+
+
+/**\struct GemvSettings
+ * \brief  Settings of the benchmark of the one-vs-many dot products
+*/
+struct GemvSettings
+{
+    size_t                   elements = 8388608;                  ///< number of elements of the matrix for all shapes
+    std::vector<size_t>      rows     = {4, 16, 64, 256, 4096};  ///< numbers of rows of the shapes
+    std::vector<std::string> ids;                                 ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv      = false;                    ///< print comma-separated values instead of a table
+};
+
+
+/**\struct GemvRow
+ * \brief  Result of a single kernel and shape of the benchmark of the one-vs-many dot products
+*/
+struct GemvRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          rows;         ///< number of rows of the matrix
+    size_t          cols;         ///< number of columns of the matrix
+    BenchmarkResult res;          ///< statistics and throughput of the kernel for the entire matrix
+    double          speedup;      ///< speed-up over calling the dot product once per row
+    double          deviation;    ///< largest relative deviation from the results of the dot products
+};
+
+
+/**\fn         print_gemv_row
+ * \brief      Print a row of the benchmark of the one-vs-many dot products (or the header
+ *             if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_gemv_row(GemvRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,rows,cols,median_s,min_s,mad_s,ns_per_elem,gbs,gflops,speedup,max_rel_deviation,checksum" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(8) << "rows" << std::setw(10) << "cols"
+            << std::setw(12) << "median[us]" << std::setw(10) << "MAD%" << std::setw(10) << "GB/s" << std::setw(10) << "GFLOP/s"
+            << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::setw(18) << "checksum" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->rows << "," << row->cols << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->res.ns_per_elem << "," << row->res.gbs << "," << row->res.gflops << "," << row->speedup << ","
+            << row->deviation << "," << row->res.result << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(8) << row->rows
+        << std::setw(10) << row->cols << std::setprecision(3) << std::setw(12) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setw(10) << row->res.gbs << std::setw(10) << row->res.gflops
+        << std::setw(10) << row->speedup << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation
+        << std::fixed << std::setw(18) << row->res.result << std::endl;
+}
+
+
+/**\fn         run_gemv_shapes
+ * \brief      Benchmark the repeated dot products and the GEMV kernels of the instruction
+ *             sets supported by the host for matrices of different shapes
+ *
+ * \param[in]  gemv       settings of the benchmark of the one-vs-many dot products
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_gemv_shapes(GemvSettings const &gemv, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (gemv.csv == false)
+    {
+        out << "ONE-VS-MANY DOT PRODUCTS (matrices of " << gemv.elements << " elements, row-major and column-major)" << std::endl;
+    }
+    print_gemv_row(nullptr, out, gemv.csv);
+
+    // checksum over all results so that the harness has a result to report
+    auto const checksum = [](std::vector<double> const &results)
+    {
+        double sum = 0.0;
+        for (double const r: results)
+        {
+            sum += r;
+        }
+        return sum;
+    };
+
+    for (size_t const rows: gemv.rows)
+    {
+        size_t const cols = std::max<size_t>(1, gemv.elements/rows);
+
+        // row-major matrix and its column-major copy (transposed in parallel)
+        AlignedBuffer<double> a(init_vec<double>(rows*cols));
+        AlignedBuffer<double> x(init_vec<double>(cols, 1));
+        AlignedBuffer<double> a_t(rows*cols);
+        std::span<double const> const a_span(a.span().data(), rows*cols);
+        std::span<double const> const x_span(x.span().data(), cols);
+        std::span<double const> const a_t_span(a_t.span().data(), rows*cols);
+
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < cols; ++i)
+        {
+            for (size_t j = 0; j < rows; ++j)
+            {
+                a_t[i*rows + j] = a[j*cols + i];
+            }
+        }
+
+        std::vector<double> loop_results(rows, 0.0);
+        std::vector<double> gemv_results(rows, 0.0);
+        double const        bytes = sizeof(double)*(1.0 + 1.0/rows);
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((gemv.ids.empty() == false) && (std::find(gemv.ids.begin(), gemv.ids.end(), table->id) == gemv.ids.end()))
+            {
+                continue;
+            }
+
+            BenchmarkResult const loop = benchmark_callable([&]()
+            {
+                for (size_t j = 0; j < rows; ++j)
+                {
+                    loop_results[j] = table->dot_unaligned(a_span.subspan(j*cols, cols), x_span);
+                }
+                return checksum(loop_results);
+            }, rows*cols, bytes, 2.0, settings);
+            GemvRow const loop_row = {std::string(table->id) + " dot per row", rows, cols, loop, 1.0, 0.0};
+            print_gemv_row(&loop_row, out, gemv.csv);
+
+            for (Layout const layout: {Layout::row_major, Layout::col_major})
+            {
+                std::span<double const> const matrix = (layout == Layout::row_major) ? a_span : a_t_span;
+                BenchmarkResult const res = benchmark_callable([&]()
+                {
+                    table->gemv(matrix, layout, x_span, gemv_results);
+                    return checksum(gemv_results);
+                }, rows*cols, bytes, 2.0, settings);
+
+                double deviation = 0.0;
+                for (size_t j = 0; j < rows; ++j)
+                {
+                    deviation = std::max(deviation, std::abs(gemv_results[j] - loop_results[j])/std::abs(loop_results[j]));
+                }
+                std::string const name = std::string(table->id) + ((layout == Layout::row_major) ? " gemv row-major" : " gemv col-major");
+                GemvRow const     row  = {name, rows, cols, res, loop.stats.median/res.stats.median, deviation};
+                print_gemv_row(&row, out, gemv.csv);
+            }
+        }
+    }
+}
+
+#endif // GEMV_SHAPES_H_INCLUDED
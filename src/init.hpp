@@ -6,6 +6,8 @@
  * \mainpage Functions that initialise a vector and then an array with random
  *           numbers.
  * \warning  Initialise vector first and then copy the values to an array.
+ *           Memory is initialised in parallel so that the pages are placed on
+ *           the NUMA node of the thread that later reads them (first touch).
 */
 
 
@@ -19,27 +21,62 @@
     }
 #endif
 
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
 #include <assert.h>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include "align.hpp"
+#include "random.hpp"
 
 
 /**\fn        init_vec
- * \brief     Initialise vecor of size \p length with random numbers
+ * \brief     Initialise vecor of size \p length with random numbers of the stream
+ *            \p stream of the seed random_seed(). The numbers only depend on the seed,
+ *            the stream and the index and are generated in parallel (see random_fill),
+ *            which first touches the memory with the partition of the kernels.
  *
  * \param[in] length   length of the wished vector
- * \return    A vector of size \p length and random entries between 0 and 1
+ * \param[in] stream   number of the random stream (different for every operand)
+ * \return    A vector of size \p length and random entries in [0,1)
 */
 template <typename T = double>
-VEC(T) init_vec(size_t const length)
+VEC(T) init_vec(size_t const length, std::uint64_t const stream = 0)
 {
     assert(length > 0);
 
-    VEC(T) res(length,0);
+    // the allocator leaves the elements untouched
+    VEC(T) res(length);
+    random_fill(res.data(), res.size(), stream);
+
+    return res;
+}
+
 
-    for (size_t i = 0; i < res.size(); ++i)
+/**\fn        misalign_vec
+ * \brief     Copy the values of the vector \p vec behind \p offset leading zeros, so that
+ *            the copy starting at element \p offset is not aligned to a cache line. The
+ *            copy is made in parallel (first touch).
+ *
+ * \param[in] vec      C++ std vector filled with numbers
+ * \param[in] offset   number of leading elements
+ * \return    A vector of size \p vec.size() + \p offset
+*/
+template <typename T = double>
+VEC(T) misalign_vec(VEC(T) const &vec, size_t const offset)
+{
+    VEC(T) res(vec.size() + offset);
+    T*       const dst    = res.data();
+    T const* const src    = vec.data();
+    size_t   const length = res.size();
+
+    #pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < length; ++i)
     {
-        res[i] = static_cast<T>(std::rand())/static_cast<T>(RAND_MAX);
+        dst[i] = (i < offset) ? static_cast<T>(0) : src[i - offset];
     }
 
     return res;
@@ -47,17 +84,21 @@ VEC(T) init_vec(size_t const length)
 
 
 /**\fn         vec_to_arr
- * \brief      Copy values from the vector \p vec to the array \p arr
+ * \brief      Copy values from the vector \p vec to the array \p arr in parallel with
+ *             the same static partition as the OpenMP kernels
  *
  * \param[in]  vec   C++ std vector filled with numbers
  * \param[out] arr   preferably empty C++ array
 */
 template <typename T = double, size_t N>
-void vec_to_arr(VEC(T) const vec, std::array<T,N> &arr)
+void vec_to_arr(VEC(T) const &vec, std::array<T,N> &arr)
 {
     assert(vec.size() <= N);
 
-    for (size_t i = 0; i < vec.size(); ++i)
+    size_t const length = vec.size();
+
+    #pragma omp parallel for simd schedule(static) shared(vec, arr)
+    for (size_t i = 0; i < length; ++i)
     {
         arr[i] = vec[i];
     }
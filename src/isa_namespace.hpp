@@ -0,0 +1,57 @@
+#ifndef ISA_NAMESPACE_H_INCLUDED
+#define ISA_NAMESPACE_H_INCLUDED
+
+/**
+ * \file     isa_namespace.hpp
+ * \mainpage The kernel headers are compiled once per instruction set (see kernels_<isa>.cpp
+ *           and the Makefile). Inline functions, template instantiations and their OpenMP
+ *           outlined regions are emitted as weak symbols by every translation unit that
+ *           uses them and the linker keeps a single arbitrary copy, possibly one compiled
+ *           with -mavx2 that the baseline kernels would then call on hosts without AVX2.
+ *           Therefore the kernel headers declare their functions and internal types in
+ *           an inline namespace named after the instruction set of the translation unit,
+ *           so that every instruction set has its own symbols. Types that are part of the
+ *           interface of the kernel tables (see dispatch.hpp) stay in the global namespace
+ *           and scratch memory is held by KernelVector instead of std::vector. The binaries
+ *           are checked for functions compiled for the wrong instruction set by 'make check'.
+*/
+
+
+#include <vector>
+#include "align.hpp"
+
+
+/// inline namespace of the kernels named after the widest instruction set of the translation unit
+#if defined(__AVX512VNNI__)
+    #define ISA_NAMESPACE isa_avx512_vnni
+#elif defined(__AVX512F__)
+    #define ISA_NAMESPACE isa_avx512
+#elif defined(__AVX2__)
+    #define ISA_NAMESPACE isa_avx2
+#else
+    #define ISA_NAMESPACE isa_baseline
+#endif
+
+
+inline namespace ISA_NAMESPACE
+{
+
+/**\struct KernelTag
+ * \brief  Tag that makes the instantiations of the allocator (and of the containers using
+ *         it) distinct for every instruction set
+*/
+struct KernelTag
+{
+};
+
+/// cache-aligned allocator of the scratch memory of the kernels
+template <typename T>
+using KernelAllocator = AlignedAllocator<T, CACHE_LINE, KernelTag>;
+
+/// cache-aligned vector for the scratch memory of the kernels (elements are default-initialised)
+template <typename T>
+using KernelVector = std::vector<T, KernelAllocator<T>>;
+
+} // namespace ISA_NAMESPACE
+
+#endif // ISA_NAMESPACE_H_INCLUDED
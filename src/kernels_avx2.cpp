@@ -0,0 +1,53 @@
+/**
+ * \file     kernels_avx2.cpp
+ * \mainpage Kernel table for hosts supporting AVX2, FMA3 and F16C. Compiled with
+ *           -mavx2 -mfma -mf16c (see Makefile).
+*/
+
+
+#include "dispatch.hpp"
+#include "avx2_omp.hpp"
+
+
+/// instantiation matrix of the policy-based kernel
+static KernelVariant const avx2_variants[] =
+{
+    SIMD_KERNEL_VARIANTS(SimdAvx2)
+};
+
+KernelTable const kernels_avx2 =
+{
+    .level               = IsaLevel::avx2,
+    .id                  = "avx2",
+    .name                = "AVX2 OMP",
+    .dot_span            = avx2_omp_span,
+    .dot_unaligned       = avx2_omp_unaligned,
+    .dot2                = avx2_omp_dot2,
+    .dot2_unaligned      = avx2_omp_dot2_unaligned,
+    .repro               = avx2_omp_reproducible,
+    .repro_unaligned     = avx2_omp_reproducible_unaligned,
+    .batch               = avx2_omp_batch,
+    .gemv                = avx2_omp_gemv,
+    .topk                = avx2_omp_topk,
+    .dgemm               = avx2_omp_dgemm,
+    .sgemm               = avx2_omp_sgemm,
+    .peak                = avx2_omp_peak,
+    .peak_float          = avx2_omp_peak_float,
+    .soa                 = {.dim3 = avx2_omp_soa<3>, .dim4 = avx2_omp_soa<4>, .dim8 = avx2_omp_soa<8>, .dim16 = avx2_omp_soa<16>},
+    .sparse              = avx2_omp_sparse<int64_t>,
+    .sparse32            = avx2_omp_sparse<int32_t>,
+    .sparse_sparse       = avx2_omp_sparse_sparse,
+    .zdot                = {.dotu = simd_omp_dot_complex<SimdAvx2,false>, .dotc = simd_omp_dot_complex<SimdAvx2,true>},
+    .cdot                = {.dotu = simd_omp_dot_complex<SimdAvx2Float,false>, .dotc = simd_omp_dot_complex<SimdAvx2Float,true>},
+    .fused               = {.norms = simd_omp_fused<SimdAvx2,FUSED_UNROLL,false>, .stats = simd_omp_fused<SimdAvx2,FUSED_UNROLL_STATS,true>},
+    .dot_span_float      = avx2_omp_span_float,
+    .dot_unaligned_float = avx2_omp_unaligned_float,
+    .dot_int16           = avx2_omp_span_int16,
+    .dot_u8s8            = avx2_omp_span_u8s8,
+    .fp16                = {.dot = simd_omp_compressed<Avx2Fp16Codec>, .dot2 = simd_omp_compressed2<Avx2Fp16Codec>},
+    .bf16                = {.dot = simd_omp_compressed<Avx2Bf16Codec>, .dot2 = simd_omp_compressed2<Avx2Bf16Codec>},
+    .q8                  = {.dot = simd_omp_compressed<Avx2Q8Codec>, .dot2 = simd_omp_compressed2<Avx2Q8Codec>},
+    .q4                  = {.dot = simd_omp_compressed<Avx2Q4Codec>, .dot2 = simd_omp_compressed2<Avx2Q4Codec>},
+    .variants            = avx2_variants,
+    .no_variants         = sizeof(avx2_variants)/sizeof(avx2_variants[0])
+};
@@ -0,0 +1,54 @@
+/**
+ * \file     kernels_avx512.cpp
+ * \mainpage Kernel table for hosts supporting AVX512 F, CD, BW, DQ and VL.
+ *           Compiled with -mf16c -mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl
+ *           (see Makefile).
+*/
+
+
+#include "dispatch.hpp"
+#include "avx512_omp.hpp"
+
+
+/// instantiation matrix of the policy-based kernel
+static KernelVariant const avx512_variants[] =
+{
+    SIMD_KERNEL_VARIANTS(SimdAvx512)
+};
+
+KernelTable const kernels_avx512 =
+{
+    .level               = IsaLevel::avx512,
+    .id                  = "avx512",
+    .name                = "AVX512 OMP",
+    .dot_span            = avx512_omp_span,
+    .dot_unaligned       = avx512_omp_unaligned,
+    .dot2                = avx512_omp_dot2,
+    .dot2_unaligned      = avx512_omp_dot2_unaligned,
+    .repro               = avx512_omp_reproducible,
+    .repro_unaligned     = avx512_omp_reproducible_unaligned,
+    .batch               = avx512_omp_batch,
+    .gemv                = avx512_omp_gemv,
+    .topk                = avx512_omp_topk,
+    .dgemm               = avx512_omp_dgemm,
+    .sgemm               = avx512_omp_sgemm,
+    .peak                = avx512_omp_peak,
+    .peak_float          = avx512_omp_peak_float,
+    .soa                 = {.dim3 = avx512_omp_soa<3>, .dim4 = avx512_omp_soa<4>, .dim8 = avx512_omp_soa<8>, .dim16 = avx512_omp_soa<16>},
+    .sparse              = avx512_omp_sparse<int64_t>,
+    .sparse32            = avx512_omp_sparse<int32_t>,
+    .sparse_sparse       = avx512_omp_sparse_sparse,
+    .zdot                = {.dotu = simd_omp_dot_complex<SimdAvx512,false>, .dotc = simd_omp_dot_complex<SimdAvx512,true>},
+    .cdot                = {.dotu = simd_omp_dot_complex<SimdAvx512Float,false>, .dotc = simd_omp_dot_complex<SimdAvx512Float,true>},
+    .fused               = {.norms = simd_omp_fused<SimdAvx512,FUSED_UNROLL,false>, .stats = simd_omp_fused<SimdAvx512,FUSED_UNROLL,true>},
+    .dot_span_float      = avx512_omp_span_float,
+    .dot_unaligned_float = avx512_omp_unaligned_float,
+    .dot_int16           = avx512_omp_span_int16,
+    .dot_u8s8            = avx512_omp_span_u8s8,
+    .fp16                = {.dot = simd_omp_compressed<Avx512Fp16Codec>, .dot2 = simd_omp_compressed2<Avx512Fp16Codec>},
+    .bf16                = {.dot = simd_omp_compressed<Avx512Bf16Codec>, .dot2 = simd_omp_compressed2<Avx512Bf16Codec>},
+    .q8                  = {.dot = simd_omp_compressed<Avx512Q8Codec>, .dot2 = simd_omp_compressed2<Avx512Q8Codec>},
+    .q4                  = {.dot = simd_omp_compressed<Avx512Q4Codec>, .dot2 = simd_omp_compressed2<Avx512Q4Codec>},
+    .variants            = avx512_variants,
+    .no_variants         = sizeof(avx512_variants)/sizeof(avx512_variants[0])
+};
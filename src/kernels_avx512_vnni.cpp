@@ -0,0 +1,18 @@
+/**
+ * \file     kernels_avx512_vnni.cpp
+ * \mainpage Kernel for unsigned times signed 8 bit integers on hosts supporting
+ *           AVX512 VNNI (Cascade Lake and later). Compiled with the AVX512 flags
+ *           and -mavx512vnni (see Makefile), selected at runtime only if the
+ *           host supports it (see vnni_kernel).
+*/
+
+
+#include "dispatch.hpp"
+#include "avx512_omp.hpp"
+
+
+#ifdef __AVX512VNNI__
+dot_u8s8_fun const kernel_avx512_vnni_u8s8 = avx512_vnni_omp_span_u8s8;
+#else
+dot_u8s8_fun const kernel_avx512_vnni_u8s8 = nullptr;
+#endif
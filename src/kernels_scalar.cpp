@@ -0,0 +1,57 @@
+/**
+ * \file     kernels_scalar.cpp
+ * \mainpage Kernel table for hosts without SIMD support. Compiled without
+ *           auto-vectorisation (see Makefile).
+*/
+
+
+#include "batched.hpp"
+#include "compensated.hpp"
+#include "complex.hpp"
+#include "dispatch.hpp"
+#include "fused.hpp"
+#include "gemm.hpp"
+#include "gemv.hpp"
+#include "omp_simd.hpp"
+#include "reproducible.hpp"
+#include "soa.hpp"
+#include "sparse.hpp"
+#include "topk.hpp"
+
+
+KernelTable const kernels_scalar =
+{
+    .level               = IsaLevel::scalar,
+    .id                  = "scalar",
+    .name                = "Scalar OMP",
+    .dot_span            = scalar_omp_span<double>,
+    .dot_unaligned       = scalar_omp_unaligned<double>,
+    .dot2                = scalar_omp_dot2_span,
+    .dot2_unaligned      = scalar_omp_dot2,
+    .repro               = scalar_omp_reproducible_span,
+    .repro_unaligned     = scalar_omp_reproducible,
+    .batch               = scalar_omp_batch,
+    .gemv                = scalar_omp_gemv,
+    .topk                = scalar_omp_topk,
+    .dgemm               = scalar_omp_gemm<double>,
+    .sgemm               = scalar_omp_gemm<float>,
+    .peak                = scalar_omp_peak<double>,
+    .peak_float          = scalar_omp_peak<float>,
+    .soa                 = {.dim3 = scalar_omp_soa<3>, .dim4 = scalar_omp_soa<4>, .dim8 = scalar_omp_soa<8>, .dim16 = scalar_omp_soa<16>},
+    .sparse              = scalar_omp_sparse<int64_t>,
+    .sparse32            = scalar_omp_sparse<int32_t>,
+    .sparse_sparse       = scalar_omp_sparse_sparse<int64_t>,
+    .zdot                = {.dotu = scalar_omp_dot_complex<double,false>, .dotc = scalar_omp_dot_complex<double,true>},
+    .cdot                = {.dotu = scalar_omp_dot_complex<float,false>, .dotc = scalar_omp_dot_complex<float,true>},
+    .fused               = {.norms = scalar_omp_fused<false>, .stats = scalar_omp_fused<true>},
+    .dot_span_float      = scalar_omp_span<float>,
+    .dot_unaligned_float = scalar_omp_unaligned<float>,
+    .dot_int16           = scalar_omp_span<int16_t>,
+    .dot_u8s8            = scalar_omp_span<uint8_t>,
+    .fp16                = {.dot = scalar_omp_compressed<BlockFp16>, .dot2 = scalar_omp_compressed2<BlockFp16>},
+    .bf16                = {.dot = scalar_omp_compressed<BlockBf16>, .dot2 = scalar_omp_compressed2<BlockBf16>},
+    .q8                  = {.dot = scalar_omp_compressed<BlockQ8>, .dot2 = scalar_omp_compressed2<BlockQ8>},
+    .q4                  = {.dot = scalar_omp_compressed<BlockQ4>, .dot2 = scalar_omp_compressed2<BlockQ4>},
+    .variants            = nullptr,
+    .no_variants         = 0
+};
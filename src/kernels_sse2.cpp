@@ -0,0 +1,59 @@
+/**
+ * \file     kernels_sse2.cpp
+ * \mainpage Kernel table for hosts supporting SSE2. Compiled with -msse2
+ *           (see Makefile). Single precision and integer kernels rely on the
+ *           auto-vectorisation of OpenMP SIMD.
+*/
+
+
+#include "batched.hpp"
+#include "compensated.hpp"
+#include "complex.hpp"
+#include "dispatch.hpp"
+#include "fused.hpp"
+#include "gemm.hpp"
+#include "gemv.hpp"
+#include "omp_simd.hpp"
+#include "reproducible.hpp"
+#include "soa.hpp"
+#include "sparse.hpp"
+#include "sse2_omp.hpp"
+#include "topk.hpp"
+
+
+KernelTable const kernels_sse2 =
+{
+    .level               = IsaLevel::sse2,
+    .id                  = "sse2",
+    .name                = "SSE2 OMP",
+    .dot_span            = sse2_omp_span,
+    .dot_unaligned       = sse2_omp_unaligned,
+    .dot2                = scalar_omp_dot2_span,
+    .dot2_unaligned      = scalar_omp_dot2,
+    .repro               = scalar_omp_reproducible_span,
+    .repro_unaligned     = scalar_omp_reproducible,
+    .batch               = scalar_omp_batch,
+    .gemv                = scalar_omp_gemv,
+    .topk                = scalar_omp_topk,
+    .dgemm               = scalar_omp_gemm<double>,
+    .sgemm               = scalar_omp_gemm<float>,
+    .peak                = scalar_omp_peak<double>,
+    .peak_float          = scalar_omp_peak<float>,
+    .soa                 = {.dim3 = scalar_omp_soa<3>, .dim4 = scalar_omp_soa<4>, .dim8 = scalar_omp_soa<8>, .dim16 = scalar_omp_soa<16>},
+    .sparse              = scalar_omp_sparse<int64_t>,
+    .sparse32            = scalar_omp_sparse<int32_t>,
+    .sparse_sparse       = scalar_omp_sparse_sparse<int64_t>,
+    .zdot                = {.dotu = simd_omp_dot_complex<SimdSse2,false>, .dotc = simd_omp_dot_complex<SimdSse2,true>},
+    .cdot                = {.dotu = scalar_omp_dot_complex<float,false>, .dotc = scalar_omp_dot_complex<float,true>},
+    .fused               = {.norms = simd_omp_fused<SimdSse2,FUSED_UNROLL,false>, .stats = simd_omp_fused<SimdSse2,FUSED_UNROLL_STATS,true>},
+    .dot_span_float      = omp_simd_span<float>,
+    .dot_unaligned_float = scalar_omp_unaligned<float>,
+    .dot_int16           = omp_simd_span<int16_t>,
+    .dot_u8s8            = omp_simd_span<uint8_t>,
+    .fp16                = {.dot = scalar_omp_compressed<BlockFp16>, .dot2 = scalar_omp_compressed2<BlockFp16>},
+    .bf16                = {.dot = scalar_omp_compressed<BlockBf16>, .dot2 = scalar_omp_compressed2<BlockBf16>},
+    .q8                  = {.dot = scalar_omp_compressed<BlockQ8>, .dot2 = scalar_omp_compressed2<BlockQ8>},
+    .q4                  = {.dot = scalar_omp_compressed<BlockQ4>, .dot2 = scalar_omp_compressed2<BlockQ4>},
+    .variants            = nullptr,
+    .no_variants         = 0
+};
@@ -1,88 +1,312 @@
 #include <vector>
 #include <string.h>
+#include <string>
 #include <memory>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <type_traits>
 #include "disclaimer.hpp"
 #include "align.hpp"
 #include "init.hpp"
 #include "omp_simd.hpp"
-#include "avx_omp.hpp"
+#include "dispatch.hpp"
 #include "benchmark.hpp"
+#include "sweep.hpp"
+#include "scaling.hpp"
+#include "tuning.hpp"
+#include "compression.hpp"
+#include "reproducibility.hpp"
+#include "batching.hpp"
+#include "gemv_shapes.hpp"
+#include "topk_search.hpp"
+#include "gemm_sizes.hpp"
+#include "small_dots.hpp"
+#include "fixed_lengths.hpp"
+#include "sparse_density.hpp"
+#include "sparse_ratio.hpp"
+#include "complex_strides.hpp"
+#include "blas_comparison.hpp"
+#include "fused_passes.hpp"
+#include "cli.hpp"
 #include "constexpr_func.hpp"
 
 
-int main(int argc, char** argv)
+/**\fn         run
+ * \brief      Run the mode selected on the command line \p cl for vectors with elements
+ *             of type \p T (x) and \p Y (y, see DotTraits)
+ *
+ * \param[in]  cl         the settings from the command line
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+ * \return     Exit code of the program
+*/
+template <typename T, typename Y = typename DotTraits<T>::y_type>
+int run(CommandLine const &cl, BenchmarkSettings settings, std::ostream &out)
 {
-    /// benchmark settings
-    constexpr size_t no_threads = 1;  //number of OpenMP threads
-    omp_set_num_threads(no_threads);
+    std::vector<NamedKernel<T>> kernels;
+    if (select_kernels<T>(cl.kernels, kernels) == false)
+    {
+        return EXIT_FAILURE;
+    }
+
+    /// sweep the vector length across the cache hierarchy
+    if (cl.mode == Mode::sweep)
+    {
+        SweepSettings sweep;
+        sweep.csv = cl.csv;
+        run_length_sweep<T>(kernels, sweep, settings, out);
+        return EXIT_SUCCESS;
+    }
 
-    constexpr size_t length = 1e5 + 1;    //unpadded length of vector
-    constexpr size_t it     = 100000; //number of iterations for determining performance
+    /// thread scaling for all or the given placement policies
+    if (cl.mode == Mode::scaling)
+    {
+        ScalingSettings scaling;
+        scaling.csv         = cl.csv;
+        scaling.length      = (cl.length > 0) ? cl.length : scaling.length;
+        scaling.max_threads = (cl.threads > 1) ? cl.threads : 0;
+        scaling.policies    = cl.policies.empty() ? scaling.policies : cl.policies;
+        run_thread_scaling<T>(kernels, scaling, settings, out);
+        return EXIT_SUCCESS;
+    }
 
     /// allocate variables
-    // calculate padding manually
-    constexpr size_t padding = PAD(length, INTR);
-    constexpr size_t padded  = length + padding;
+    size_t const length = (cl.length > 0) ? cl.length : 1e5 + 1;  //unpadded length of vector
+    settings.iterations = (cl.iterations > 0) ? cl.iterations : std::max<size_t>(1, 100000000/length);
 
-    // allocate vector
-    VEC(double) const x_vec = init_vec(length);
-    VEC(double) const y_vec = init_vec(length);
+    /// run benchmarks for every NUMA placement of the operands
+    if (cl.csv == false)
+    {
+        out << std::endl;
+        out << "STARTING BENCHMARKS (" << length << " elements of type " << cl.dtype << ") with "
+            << settings.warmup << " warm-up and " << settings.repetitions << " timed samples of "
+            << settings.iterations << " iterations each (seed " << cl.seed << ")" << std::endl;
+    }
 
-    // allocate aligned and padded array
-    alignas(CACHE_LINE) std::array<INTR,padded> x_arr;
-    alignas(CACHE_LINE) std::array<INTR,padded> y_arr;
-    // copy values from vector to array
-    vec_to_arr(x_vec, x_arr);
-    vec_to_arr(y_vec, y_arr);
+    for (NumaPlacement const placement: cl.numa)
+    {
+        numa_placement() = placement;
+        std::string const suffix = (cl.numa.size() > 1) ? std::string(" [") + numa_placement_name(placement) + "]" : "";
 
+        // allocate vector
+        VEC(T) const x_vec = init_vec<T>(length);
+        VEC(Y) const y_vec = init_vec<Y>(length, 1);
 
-    /// print disclaimer
-    if ( (argc > 1) && ((strcmp(argv[1], "--version") == 0) || (strcmp(argv[1], "--v") == 0)) )
-    {
-        print_disclaimer();
-        exit(EXIT_SUCCESS);
+        // allocate aligned buffer padded with zeros on the heap and copy values from vector
+        AlignedBuffer<T> x_buf(x_vec);
+        AlignedBuffer<Y> y_buf(y_vec);
+        std::span<T> const x_span = x_buf.span();
+        std::span<Y> const y_span = y_buf.span();
+
+        /// check for alignment
+        if ((cl.csv == false) && (placement == cl.numa.front()))
+        {
+            out << std::endl;
+            out << "DATA ALIGNMENT" << std::endl;
+            out << "Vector (" << x_vec.size() << " elements):" << std::endl;
+            test_alignment(&x_vec[0], length, out);
+            out << "Buffer (" << x_buf.padded_size() << " elements):" << std::endl;
+            test_alignment(&x_buf[0], length, out);
+            out << std::endl;
+        }
+        /// check the integer kernels for the operands avoided by the random fill
+        if constexpr (std::is_integral<T>::value == true)
+        {
+            if ((placement == cl.numa.front()) && (check_extreme_operands<T>(kernels, length, out, cl.csv) == false))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        if (placement == cl.numa.front())
+        {
+            print_header(out, cl.csv);
+        }
+
+        // vector: omp parallel for and simd (floating point only)
+        if constexpr (std::is_floating_point<T>::value == true)
+        {
+            if (cl.kernels.empty() == true)
+            {
+                print_result("C++ Vector OMP SIMD" + suffix, benchmark_fun<VEC(T), T>(x_vec, y_vec, omp_simd_vec<T>, settings), out, cl.csv);
+            }
+        }
+
+        // span: omp parallel for and simd as well as manual vectorisation of all instruction sets supported by the host
+        for (NamedKernel<T> const &kernel: kernels)
+        {
+            print_result("C++ Span   " + kernel.name + suffix,
+                         benchmark_fun<std::span<T>>(x_span, y_span, kernel.fun, settings), out, cl.csv);
+        }
+
+        // span without alignment and padding: the operands are shifted by an element
+        VEC(T) const x_shifted = misalign_vec<T>(x_vec, 1);
+        VEC(Y) const y_shifted = misalign_vec<Y>(y_vec, 1);
+        std::span<T const> const x_unaligned(x_shifted.data() + 1, length);
+        std::span<Y const> const y_unaligned(y_shifted.data() + 1, length);
+        for (NamedKernel<T> const &kernel: kernels)
+        {
+            if (kernel.unaligned != nullptr)
+            {
+                print_result("C++ Span   " + kernel.name + " unaligned" + suffix,
+                             benchmark_fun<std::span<T const>>(x_unaligned, y_unaligned, kernel.unaligned, settings), out, cl.csv);
+            }
+        }
     }
 
+    return EXIT_SUCCESS;
+}
 
-    /// check for alignment
-    std::cout << std::endl;
-    std::cout << "DATA ALIGNMENT" << std::endl;
-    std::cout << "Vector (" << x_vec.size() << " elements):" << std::endl;
-    test_alignment(&x_vec[0], length);
-    std::cout << "Array ("  << padded       << " elements):" << std::endl;
-    test_alignment(&x_arr[0], length);
 
+/**\fn         run_fixed_types
+ * \brief      Run a mode with fixed element types: the options of the command line \p cl
+ *             common to these modes are applied to the default settings \p s of the mode
+ *             before it is run by \p fun. --length sets the member \p size of \p s (if
+ *             any) and without --iters a timed sample processes \p per_sample elements
+ *             (a single call if 0) unless the mode determines its calls per sample itself.
+ *
+ * \param[in]  cl           the settings from the command line
+ * \param[in]  s            the default settings of the mode
+ * \param[in]  size         member of \p s given by --length or nullptr
+ * \param[in]  per_sample   number of elements per timed sample, a single call if 0
+ * \param[in]  fun          the benchmark of the mode
+ * \param[in]  settings     settings of the benchmark harness
+ * \param[out] out          stream the results are written to
+ * \return     Exit code of the program
+*/
+template <typename S, typename F>
+int run_fixed_types(CommandLine const &cl, S s, std::type_identity_t<size_t S::*> const size, size_t const per_sample,
+                    F const fun, BenchmarkSettings settings, std::ostream &out)
+{
+    s.csv = cl.csv;
+    if constexpr (requires { s.ids; })
+    {
+        s.ids = cl.kernels;
+    }
+    if ((size != nullptr) && (cl.length > 0))
+    {
+        s.*size = cl.length;
+    }
+    if constexpr (requires { s.iterations; })
+    {
+        s.iterations = cl.iterations;
+    }
+    else if (cl.iterations > 0)
+    {
+        settings.iterations = cl.iterations;
+    }
+    else
+    {
+        settings.iterations = ((per_sample > 0) && (size != nullptr)) ? std::max<size_t>(1, per_sample/(s.*size)) : 1;
+    }
+    fun(s, settings, out);
+    return EXIT_SUCCESS;
+}
 
-    /// run benchmarks
-    std::cout << std::endl;
-    std::cout << "STARTING BENCHMARKS with " << it << " iterations" << std::endl;
-    std::cout << std::fixed << std::setprecision(3) << std::setfill(' ');
 
-    // vector: omp parallel for and simd
-    std::cout << " -C++ Vector OMP SIMD:   ";
-    benchmark_fun(x_vec, y_vec, omp_simd_vec, it);
+int main(int argc, char** argv)
+{
+    /// parse command line
+    CommandLine cl;
+    if (parse_command_line(argc, argv, cl) == false)
+    {
+        return EXIT_FAILURE;
+    }
+
+    /// print usage or disclaimer
+    if (cl.mode == Mode::help)
+    {
+        print_usage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+    if (cl.mode == Mode::version)
+    {
+        print_disclaimer();
+        return EXIT_SUCCESS;
+    }
+
+    /// benchmark settings
+    omp_set_num_threads(cl.threads);  //number of OpenMP threads
+    huge_pages() = cl.huge_pages;     //huge pages for large buffers
+    random_seed() = cl.seed;          //seed of the random operands
 
-    // span: omp parallel for and simd
-    std::cout << " -C++ Span   OMP SIMD:   ";
-    benchmark_fun<std::span<INTR>>(x_arr, y_arr, omp_simd_span, it);
+    BenchmarkSettings settings;
+    settings.warmup      = cl.warmup;       //number of untimed samples
+    settings.repetitions = cl.repetitions;  //number of timed samples for statistics
+    settings.iterations  = 1000;            //number of calls per sample (only used without --iters)
+    settings.outlier     = 3.0;             //outlier rejection threshold in scaled MADs
 
-    // array: omp parallel for and simd
-    std::cout << " -C++ Array  OMP SIMD:   ";
-    benchmark_fun(x_arr, y_arr, omp_simd_arr, it);
+    /// write to console or file
+    std::ofstream file;
+    if (cl.output.empty() == false)
+    {
+        file.open(cl.output);
+        if (!file)
+        {
+            std::cerr << "Could not open output file '" << cl.output << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream &out = cl.output.empty() ? std::cout : file;
 
-    // array: manual avx2 vectorisation and omp parallel for
-    #ifdef __AVX2__
-        std::cout << " -C++ Array  AVX2 OMP:   ";
-        benchmark_fun<std::span<INTR>>(x_arr, y_arr, avx2_omp_span, it);
-    #endif
+    /// sweeps use the first NUMA placement
+    numa_placement() = cl.numa.front();
 
-    // array: manual avx512 vectorisation and omp parallel for
-    #ifdef __AVX512CD__
-        std::cout << " -C++ Array  AVX512 OMP: ";
-        benchmark_fun<std::span<INTR>>(x_arr, y_arr, avx512_omp_span, it);
-    #endif
+    /// modes with fixed element types (see cli.hpp)
+    switch (cl.mode)
+    {
+        case Mode::tune:
+            return run_fixed_types(cl, TuneSettings(),        &TuneSettings::length,            0,         run_kernel_matrix,      settings, out);
+        case Mode::compressed:
+            return run_fixed_types(cl, CompressionSettings(), &CompressionSettings::length,     100000000, run_compressed_formats, settings, out);
+        case Mode::reproducible:
+        {
+            ReproducibilitySettings reproducibility;
+            reproducibility.max_threads = (cl.threads > 1) ? cl.threads : reproducibility.max_threads;
+            return run_fixed_types(cl, reproducibility,       &ReproducibilitySettings::length, 100000000, run_reproducibility,    settings, out);
+        }
+        case Mode::batch:
+            return run_fixed_types(cl, BatchSettings(),       &BatchSettings::pairs,            0,         run_batch,              settings, out);
+        case Mode::gemv:
+            return run_fixed_types(cl, GemvSettings(),        &GemvSettings::elements,          100000000, run_gemv_shapes,        settings, out);
+        case Mode::topk:
+            return run_fixed_types(cl, TopkSettings(),        &TopkSettings::max_size,          0,         run_topk_search,        settings, out);
+        case Mode::gemm:
+            return run_fixed_types(cl, GemmSettings(),        &GemmSettings::max_size,          0,         run_gemm_sizes,         settings, out);
+        case Mode::soa:
+            return run_fixed_types(cl, SoaSettings(),         &SoaSettings::pairs,              0,         run_small_dots,         settings, out);
+        case Mode::fixed:
+            return run_fixed_types(cl, FixedSettings(),       nullptr,                          0,
+                                   run_fixed_lengths<3, 4, 7, 8, 16, 64, 1003, 65536, 1048576>, settings, out);
+        case Mode::sparse:
+            return run_fixed_types(cl, SparseSettings(),      &SparseSettings::length,          0,         run_sparse_density,     settings, out);
+        case Mode::intersect:
+            return run_fixed_types(cl, IntersectSettings(),   &IntersectSettings::nnz,          0,         run_sparse_ratio,       settings, out);
+        case Mode::complex:
+            return run_fixed_types(cl, ComplexSettings(),     &ComplexSettings::length,         0,         run_complex_strides,    settings, out);
+        case Mode::blas:
+            return run_fixed_types(cl, BlasSettings(),        &BlasSettings::length,            0,         run_blas_comparison,    settings, out);
+        case Mode::fused:
+        {
+            FusedSettings fused;
+            fused.lengths = (cl.length > 0) ? std::vector<size_t>{cl.length} : fused.lengths;
+            return run_fixed_types(cl, fused,                 nullptr,                          0,         run_fused_passes,       settings, out);
+        }
+        default:
+            break;
+    }
 
-	return EXIT_SUCCESS;
+    if (cl.dtype == "float")
+    {
+        return run<float>(cl, settings, out);
+    }
+    if (cl.dtype == "int16")
+    {
+        return run<int16_t>(cl, settings, out);
+    }
+    if (cl.dtype == "int8")
+    {
+        return run<uint8_t>(cl, settings, out);
+    }
+    return run<double>(cl, settings, out);
 }
@@ -0,0 +1,186 @@
+#ifndef NUMA_H_INCLUDED
+#define NUMA_H_INCLUDED
+
+/**
+ * \file     numa.hpp
+ * \mainpage Placement of large buffers on the NUMA nodes of multi-socket hosts.
+ *           The memory policy is applied to a freshly mapped range before it is
+ *           touched for the first time: node-local placement relies on the
+ *           parallel first-touch initialisation (see init.hpp), interleaved and
+ *           single-node placement are enforced by the operating system (mbind).
+ *           The system call is used directly so that libnuma is not required.
+ * \warning  Only supported on Linux, on other operating systems all policies
+ *           fall back to the default placement of the operating system.
+*/
+
+
+#ifdef __linux__
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #if __has_include (<linux/mempolicy.h>)
+        #include <linux/mempolicy.h>
+    #endif
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**\enum  NumaPlacement
+ * \brief Placement of the pages of large buffers on the NUMA nodes
+*/
+enum class NumaPlacement
+{
+    local,       ///< first touch: every page is placed on the node of the thread initialising it
+    interleave,  ///< pages are distributed round-robin over all nodes
+    single       ///< all pages are placed on the node of the allocating thread
+};
+
+
+/**\fn        numa_placement
+ * \brief     Process-wide placement policy for buffers mapped by the AlignedAllocator
+ *            (default: node-local first touch)
+ *
+ * \return    Reference to the policy
+*/
+inline NumaPlacement& numa_placement()
+{
+    static NumaPlacement policy = NumaPlacement::local;
+    return policy;
+}
+
+
+/**\fn        numa_placement_name
+ * \brief     Name of a NUMA placement \p policy
+ *
+ * \param[in] policy   the placement policy
+ * \return    The name of the policy
+*/
+inline char const* numa_placement_name(NumaPlacement const policy)
+{
+    switch (policy)
+    {
+        case NumaPlacement::local:      return "local";
+        case NumaPlacement::interleave: return "interleave";
+        case NumaPlacement::single:     return "single";
+    }
+    return "unknown";
+}
+
+
+/**\fn         numa_placement_from_string
+ * \brief      Parse a NUMA placement policy from a string \p str such as "interleave"
+ *
+ * \param[in]  str      the string to be parsed
+ * \param[out] policy   the parsed placement policy
+ * \return     Boolean flag signalling if the string could be parsed
+*/
+inline bool numa_placement_from_string(std::string const &str, NumaPlacement &policy)
+{
+    for (NumaPlacement const p: {NumaPlacement::local, NumaPlacement::interleave, NumaPlacement::single})
+    {
+        if (str == numa_placement_name(p))
+        {
+            policy = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**\fn        numa_nodes
+ * \brief     Online NUMA nodes of the host as given in /sys/devices/system/node/online
+ *            (e.g. "0-1,3")
+ *
+ * \return    Vector of the node numbers (only node 0 if unknown)
+*/
+inline std::vector<int> numa_nodes()
+{
+    std::vector<int> nodes;
+    std::ifstream    file("/sys/devices/system/node/online");
+    std::string      line;
+
+    if (file && std::getline(file, line))
+    {
+        std::stringstream stream(line);
+        std::string       range;
+        while (std::getline(stream, range, ','))
+        {
+            size_t const dash  = range.find('-');
+            int const    first = std::stoi(range.substr(0, dash));
+            int const    last  = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+            for (int n = first; n <= last; ++n)
+            {
+                nodes.push_back(n);
+            }
+        }
+    }
+
+    if (nodes.empty() == true)
+    {
+        nodes.push_back(0);
+    }
+    return nodes;
+}
+
+
+/**\fn        current_numa_node
+ * \brief     NUMA node of the processor the calling thread is currently running on
+ *
+ * \return    The node number (0 if unknown)
+*/
+inline int current_numa_node()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+    {
+        return static_cast<int>(node);
+    }
+#endif
+    return 0;
+}
+
+
+/**\fn        apply_numa_placement
+ * \brief     Apply the NUMA placement \p policy to the page-aligned memory range starting
+ *            at \p ptr of \p bytes that has not been touched yet. Node-local placement
+ *            requires no action, the pages are placed by the first touch.
+ *
+ * \param[in] ptr      page-aligned start of the range
+ * \param[in] bytes    size of the range in bytes
+ * \param[in] policy   the placement policy
+ * \return    Boolean flag signalling if the policy could be applied
+*/
+inline bool apply_numa_placement(void* const ptr, size_t const bytes, NumaPlacement const policy)
+{
+    if (policy == NumaPlacement::local)
+    {
+        return true;
+    }
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(MPOL_INTERLEAVE)
+    std::vector<int> const nodes = (policy == NumaPlacement::interleave) ? numa_nodes()
+                                                                         : std::vector<int>{current_numa_node()};
+    constexpr size_t bits = 8*sizeof(unsigned long);
+    int const        max_node = *std::max_element(nodes.begin(), nodes.end());
+    std::vector<unsigned long> mask(max_node/bits + 1, 0ul);
+    for (int const n: nodes)
+    {
+        mask[n/bits] |= 1ul << (n % bits);
+    }
+
+    int const mode = (policy == NumaPlacement::interleave) ? MPOL_INTERLEAVE : MPOL_BIND;
+    return syscall(SYS_mbind, ptr, bytes, mode, mask.data(), mask.size()*bits + 1, 0) == 0;
+#else
+    static_cast<void>(ptr);
+    static_cast<void>(bytes);
+    return false;
+#endif
+}
+
+#endif // NUMA_H_INCLUDED
@@ -26,8 +26,42 @@
 #endif
 
 #include <assert.h>
+#include <cstdint>
 #include <vector>
 #include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\struct DotTraits
+ * \brief  Element type of the second operand and type of the result of a dot product
+ *         whose first operand holds elements of type \p T: floating point numbers are
+ *         accumulated in their own precision, integers exactly in 64 bit. 8 bit
+ *         integers follow the VNNI convention of unsigned x and signed y.
+*/
+template <typename T>
+struct DotTraits
+{
+    typedef T y_type;
+    typedef T result_type;
+};
+
+template <>
+struct DotTraits<int16_t>
+{
+    typedef int16_t y_type;
+    typedef int64_t result_type;
+};
+
+template <>
+struct DotTraits<uint8_t>
+{
+    typedef int8_t  y_type;
+    typedef int64_t result_type;
+};
 
 
 /**\fn        omp_simd_vec
@@ -84,21 +118,77 @@ inline T omp_simd_arr(std::array<T,N> const &x, std::array<T,N> const &y)
  * \param[in] y   a (un)aligned C++ span
  * \return    Dot product of the two vectors
 */
-template <typename T = double>
-inline T omp_simd_span(std::span<T> const &x, std::span<T> const &y)
+template <typename T = double, typename U = typename DotTraits<T>::y_type, typename R = typename DotTraits<T>::result_type>
+inline R omp_simd_span(std::span<T> const &x, std::span<U> const &y)
 {
     assert(x.size() == y.size());
     size_t const N = x.size();
 
-    T res = static_cast<T>(0.0);
+    R res = static_cast<R>(0.0);
 
     #pragma omp parallel for simd shared(x, y) reduction(+: res)
     for (size_t i = 0; i < N; ++i)
     {
-        res += x[i]*y[i];
+        res += static_cast<R>(x[i])*static_cast<R>(y[i]);
     }
 
     return res;
 }
 
+
+/**\fn        scalar_omp_span
+ * \brief     Calculate dot product of two vectors \p x and \p y without any
+ *            vectorisation (only OpenMP parallel for), container: C++ span.
+ *            Serves as reference and fallback for hosts without SIMD support.
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+template <typename T = double, typename U = typename DotTraits<T>::y_type, typename R = typename DotTraits<T>::result_type>
+inline R scalar_omp_span(std::span<T> const &x, std::span<U> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const N = x.size();
+
+    R res = static_cast<R>(0.0);
+
+    #pragma omp parallel for shared(x, y) reduction(+: res)
+    for (size_t i = 0; i < N; ++i)
+    {
+        res += static_cast<R>(x[i])*static_cast<R>(y[i]);
+    }
+
+    return res;
+}
+
+
+/**\fn        scalar_omp_unaligned
+ * \brief     Calculate dot product of two read-only vectors \p x and \p y of arbitrary
+ *            length and alignment without any vectorisation (only OpenMP parallel
+ *            for), container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+template <typename T = double, typename U = typename DotTraits<T>::y_type, typename R = typename DotTraits<T>::result_type>
+inline R scalar_omp_unaligned(std::span<T const> const &x, std::span<U const> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const N = x.size();
+
+    R res = static_cast<R>(0.0);
+
+    #pragma omp parallel for shared(x, y) reduction(+: res)
+    for (size_t i = 0; i < N; ++i)
+    {
+        res += static_cast<R>(x[i])*static_cast<R>(y[i]);
+    }
+
+    return res;
+}
+
+} // namespace ISA_NAMESPACE
+
 #endif // OMP_SIMD_H_INCLUDED
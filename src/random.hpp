@@ -0,0 +1,150 @@
+#ifndef RANDOM_H_INCLUDED
+#define RANDOM_H_INCLUDED
+
+/**
+ * \file     random.hpp
+ * \mainpage Counter-based random number generator for the benchmark inputs. Every
+ *           element is a pure function of the seed, the stream and its index
+ *           (SplitMix64 finaliser applied to a Weyl sequence), so that the fill
+ *           can be vectorised and parallelised with any partition and produces
+ *           bit-identical data independently of the number of threads and of the
+ *           C library.
+*/
+
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+
+/// default seed of the benchmark inputs (results are reproducible unless --seed is given)
+#define DEFAULT_SEED  0x2b7e151628aed2a6ull
+
+/// increment of the Weyl sequence (golden ratio scaled to 64 bit)
+#define GOLDEN_GAMMA  0x9e3779b97f4a7c15ull
+
+
+/**\fn        random_seed
+ * \brief     Process-wide seed of the benchmark inputs
+ *
+ * \return    Reference to the seed
+*/
+inline std::uint64_t& random_seed()
+{
+    static std::uint64_t seed = DEFAULT_SEED;
+    return seed;
+}
+
+
+/**\fn        splitmix64
+ * \brief     Finaliser of SplitMix64: bijective mixing of a 64 bit integer \p z
+ *
+ * \param[in] z   the integer to be mixed
+ * \return    The mixed integer
+*/
+inline std::uint64_t splitmix64(std::uint64_t z)
+{
+    z = (z ^ (z >> 30))*0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27))*0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+
+/**\fn        random_key
+ * \brief     Key of the independent stream \p stream for the seed \p seed
+ *
+ * \param[in] seed     the seed
+ * \param[in] stream   number of the stream (e.g. 0 for x and 1 for y)
+ * \return    The key of the stream
+*/
+inline std::uint64_t random_key(std::uint64_t const seed, std::uint64_t const stream)
+{
+    return splitmix64(splitmix64(seed) + (stream + 1)*GOLDEN_GAMMA);
+}
+
+
+/**\fn        random_bits
+ * \brief     Random 64 bit integer number \p index of the stream with key \p key
+ *
+ * \param[in] key     key of the stream (see random_key)
+ * \param[in] index   counter of the element
+ * \return    The random integer
+*/
+inline std::uint64_t random_bits(std::uint64_t const key, std::uint64_t const index)
+{
+    return splitmix64(key + (index + 1)*GOLDEN_GAMMA);
+}
+
+
+/**\fn        random_unit
+ * \brief     Convert random bits \p bits to a floating point number uniformly distributed
+ *            in [0,1) using as many bits as the mantissa of \p T holds
+ *
+ * \param[in] bits   the random integer
+ * \return    The floating point number
+*/
+template <typename T = double>
+inline T random_unit(std::uint64_t const bits)
+{
+    static_assert(std::is_floating_point<T>::value, "Only floating point types are supported");
+
+    constexpr int digits = (std::numeric_limits<T>::digits < 64) ? std::numeric_limits<T>::digits : 53;
+    return static_cast<T>(bits >> (64 - digits))*(static_cast<T>(1)/static_cast<T>(1ull << digits));
+}
+
+
+/**\fn        random_integer
+ * \brief     Convert random bits \p bits to an integer of type \p T uniformly distributed
+ *            over the symmetric range of \p T (e.g. [-127,127] for signed 8 bit integers
+ *            as produced by symmetric quantisation, [0,255] for unsigned ones)
+ *
+ * \param[in] bits   the random integer
+ * \return    The integer
+*/
+template <typename T>
+inline T random_integer(std::uint64_t const bits)
+{
+    static_assert(std::is_integral<T>::value, "Only integral types are supported");
+
+    T const value = static_cast<T>(bits >> (64 - 8*sizeof(T)));
+    return ((std::is_signed<T>::value == true) && (value == std::numeric_limits<T>::min())) ? static_cast<T>(value + 1) : value;
+}
+
+
+/**\fn        random_fill
+ * \brief     Fill the \p length elements starting at \p data with random numbers in [0,1)
+ *            (integers over their symmetric range, see random_integer) of stream
+ *            \p stream of the seed \p seed. The fill is vectorised and split
+ *            with the same static partition as the OpenMP kernels so that it also acts
+ *            as first touch of the pages.
+ *
+ * \param[out] data     pointer to the first element
+ * \param[in]  length   number of elements
+ * \param[in]  stream   number of the stream
+ * \param[in]  seed     the seed
+*/
+template <typename T = double>
+void random_fill(T* const data, size_t const length, std::uint64_t const stream = 0,
+                 std::uint64_t const seed = random_seed())
+{
+    std::uint64_t const key = random_key(seed, stream);
+
+    #pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < length; ++i)
+    {
+        if constexpr (std::is_integral<T>::value == true)
+        {
+            data[i] = random_integer<T>(random_bits(key, i));
+        }
+        else
+        {
+            data[i] = random_unit<T>(random_bits(key, i));
+        }
+    }
+}
+
+#endif // RANDOM_H_INCLUDED
@@ -0,0 +1,192 @@
+#ifndef REPRODUCIBILITY_H_INCLUDED
+#define REPRODUCIBILITY_H_INCLUDED
+
+/**
+ * \file     reproducibility.hpp
+ * \mainpage Benchmark of the deterministic reduction (see reproducible.hpp): for
+ *           every instruction set of the host the default kernel is compared to the
+ *           kernel that is bitwise independent of the number of threads. Besides the
+ *           throughput the overhead of the deterministic kernel is reported as well
+ *           as if the results of both kernels are bit-identical for 1..N threads.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "reproducible.hpp"
+
+
+/// default maximum number of threads the results are compared for (threads may exceed the cores)
+#define REPRODUCIBILITY_THREADS 16
+
+
+/**\struct ReproducibilitySettings
+ * \brief  Settings of the benchmark of the deterministic reduction
+*/
+struct ReproducibilitySettings
+{
+    size_t                   length      = 10000001;                 ///< number of elements per vector
+    size_t                   max_threads = REPRODUCIBILITY_THREADS;  ///< results are compared for 1..max_threads threads
+    std::vector<std::string> ids;                                    ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv         = false;                    ///< print comma-separated values instead of a table
+};
+
+
+/**\struct ReproducibilityRow
+ * \brief  Result of a single kernel of the benchmark of the deterministic reduction
+*/
+struct ReproducibilityRow
+{
+    std::string     name;         ///< name of the kernel
+    BenchmarkResult res;          ///< statistics and throughput of the kernel
+    double          overhead;     ///< additional runtime over the default kernel of the same instruction set
+    size_t          distinct;     ///< number of distinct results for 1..max_threads threads
+};
+
+
+/**\fn         print_reproducibility_row
+ * \brief      Print a row of the benchmark of the deterministic reduction (or the header if
+ *             \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_reproducibility_row(ReproducibilityRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,median_s,min_s,mad_s,ns_per_elem,gbs,overhead,distinct_results,result" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(12) << "median[us]"
+            << std::setw(10) << "MAD%" << std::setw(10) << "ns/elem" << std::setw(10) << "GB/s"
+            << std::setw(12) << "overhead%" << std::setw(10) << "distinct" << std::setw(14) << "identical"
+            << std::setw(26) << "result" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << s.median << "," << s.min << "," << s.mad << "," << row->res.ns_per_elem << ","
+            << row->res.gbs << "," << row->overhead << "," << row->distinct << ","
+            << std::setprecision(17) << row->res.result << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setprecision(3)
+        << std::setw(12) << s.median*1.0e6 << std::setprecision(2) << std::setw(10) << 100.0*s.mad/s.median
+        << std::setprecision(4) << std::setw(10) << row->res.ns_per_elem << std::setprecision(2)
+        << std::setw(10) << row->res.gbs << std::setw(12) << 100.0*row->overhead << std::setw(10) << row->distinct
+        << std::setw(14) << ((row->distinct == 1) ? "yes" : "no")
+        << std::scientific << std::setprecision(16) << std::setw(26) << row->res.result << std::endl;
+}
+
+
+/**\fn        count_distinct_results
+ * \brief     Call the kernel \p fun for the operands \p x and \p y with 1..\p max_threads
+ *            threads and count the bitwise distinct results. The number of threads is
+ *            restored afterwards.
+ *
+ * \param[in] x             the first operand
+ * \param[in] y             the second operand
+ * \param[in] fun           the kernel
+ * \param[in] max_threads   maximum number of threads
+ * \return    Number of distinct results
+*/
+inline size_t count_distinct_results(std::span<double> const &x, std::span<double> const &y,
+                                     dot_span_fun const fun, size_t const max_threads)
+{
+    int const threads = omp_get_max_threads();
+
+    std::vector<std::uint64_t> results;
+    for (size_t t = 1; t <= max_threads; ++t)
+    {
+        omp_set_num_threads(static_cast<int>(t));
+        double const  res = fun(x, y);
+        std::uint64_t bits;
+        std::memcpy(&bits, &res, sizeof(res));
+        if (std::find(results.begin(), results.end(), bits) == results.end())
+        {
+            results.push_back(bits);
+        }
+    }
+
+    omp_set_num_threads(threads);
+    return results.size();
+}
+
+
+/**\fn         run_reproducibility
+ * \brief      Benchmark the default and the deterministic kernel of the instruction sets
+ *             supported by the host and check if their results depend on the number of
+ *             threads
+ *
+ * \param[in]  reproducibility   settings of the benchmark of the deterministic reduction
+ * \param[in]  settings          settings of the benchmark harness
+ * \param[out] out               stream the results are written to
+*/
+inline void run_reproducibility(ReproducibilitySettings const &reproducibility, BenchmarkSettings const &settings,
+                                std::ostream &out = std::cout)
+{
+    AlignedBuffer<double> x(init_vec<double>(reproducibility.length));
+    AlignedBuffer<double> y(init_vec<double>(reproducibility.length, 1));
+    std::span<double> const x_span = x.span();
+    std::span<double> const y_span = y.span();
+
+    if (reproducibility.csv == false)
+    {
+        out << "REPRODUCIBILITY (" << reproducibility.length << " elements, blocks of " << REPRODUCIBLE_BLOCK
+            << " elements, results compared for 1.." << reproducibility.max_threads << " threads, timed with "
+            << omp_get_max_threads() << ")" << std::endl;
+    }
+    print_reproducibility_row(nullptr, out, reproducibility.csv);
+
+    for (KernelTable const* table: available_kernels())
+    {
+        if ((reproducibility.ids.empty() == false) &&
+            (std::find(reproducibility.ids.begin(), reproducibility.ids.end(), table->id) == reproducibility.ids.end()))
+        {
+            continue;
+        }
+
+        BenchmarkResult const    plain     = benchmark_fun<std::span<double>>(x_span, y_span, table->dot_span, settings);
+        ReproducibilityRow const plain_row = {std::string(table->id) + " default", plain, 0.0,
+                                              count_distinct_results(x_span, y_span, table->dot_span, reproducibility.max_threads)};
+        print_reproducibility_row(&plain_row, out, reproducibility.csv);
+
+        BenchmarkResult const    repro     = benchmark_fun<std::span<double>>(x_span, y_span, table->repro, settings);
+        ReproducibilityRow const repro_row = {std::string(table->id) + " reproducible", repro,
+                                              repro.stats.median/plain.stats.median - 1.0,
+                                              count_distinct_results(x_span, y_span, table->repro, reproducibility.max_threads)};
+        print_reproducibility_row(&repro_row, out, reproducibility.csv);
+    }
+}
+
+#endif // REPRODUCIBILITY_H_INCLUDED
@@ -0,0 +1,196 @@
+#ifndef REPRODUCIBLE_H_INCLUDED
+#define REPRODUCIBLE_H_INCLUDED
+
+/**
+ * \file     reproducible.hpp
+ * \brief    dot product that is bitwise reproducible for any number of threads
+ * \mainpage Deterministic dot product: the reduction clauses of OpenMP combine the
+ *           partial sums of the threads in an unspecified order and the chunks of the
+ *           threads depend on their number, so that the rounding of the result changes
+ *           with the number of threads. Here the vectors are instead split into blocks
+ *           of a fixed number of elements (REPRODUCIBLE_BLOCK) independent of the
+ *           threads, the threads only decide who computes which block. The partial
+ *           sums of the blocks are stored and combined in a fixed-shape pairwise tree
+ *           afterwards. The result is therefore bit-identical for 1..N threads and any
+ *           schedule, though not across instruction sets (the lanes of the registers
+ *           are a part of the summation order).
+ * \warning  Must not be compiled with -ffast-math as the compiler could reorder the sums!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of elements of a block of the deterministic reduction, must be a multiple of the unrolled step of all kernels
+#define REPRODUCIBLE_BLOCK 4096
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        pairwise_sum
+ * \brief     Sum up the \p n elements of \p p in a fixed-shape binary tree (in place):
+ *            the shape only depends on \p n and so does the rounding of the result
+ *
+ * \param[in] p   the summands, overwritten with intermediate sums
+ * \param[in] n   number of summands
+ * \return    The sum of all elements
+*/
+inline double pairwise_sum(double* const p, size_t const n)
+{
+    for (size_t stride = 1; stride < n; stride *= 2)
+    {
+        for (size_t i = 0; i + stride < n; i += 2*stride)
+        {
+            p[i] += p[i + stride];
+        }
+    }
+    return (n > 0) ? p[0] : 0.0;
+}
+
+
+/**\fn        scalar_omp_reproducible
+ * \brief     Calculate the dot product of two vectors \p x and \p y of any length and
+ *            alignment so that the result is bitwise independent of the number of
+ *            threads (see REPRODUCIBLE_BLOCK) without manual vectorisation
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double scalar_omp_reproducible(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const N      = x.size();
+    size_t const blocks = (N + REPRODUCIBLE_BLOCK - 1)/REPRODUCIBLE_BLOCK;
+
+    KernelVector<double> partials(blocks, 0.0);
+
+    #pragma omp parallel for schedule(static) shared(x, y, partials)
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        size_t const begin = b*REPRODUCIBLE_BLOCK;
+        size_t const end   = std::min(N, begin + REPRODUCIBLE_BLOCK);
+
+        double sum = 0.0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            sum += x[i]*y[i];
+        }
+        partials[b] = sum;
+    }
+
+    return pairwise_sum(partials.data(), blocks);
+}
+
+
+/**\fn        scalar_omp_reproducible_span
+ * \brief     Calculate the dot product of two aligned and padded vectors \p x and \p y
+ *            bitwise independent of the number of threads (see scalar_omp_reproducible),
+ *            container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double scalar_omp_reproducible_span(std::span<double> const &x, std::span<double> const &y)
+{
+    return scalar_omp_reproducible(std::span<double const>(x.data(), x.size()), std::span<double const>(y.data(), y.size()));
+}
+
+
+/**\fn        simd_omp_reproducible
+ * \brief     Calculate the dot product of the \p N elements of \p x and \p y with the
+ *            instruction set \p Isa so that the result is bitwise independent of the
+ *            number of threads: every block of REPRODUCIBLE_BLOCK elements is computed
+ *            with \p Accumulators independent accumulators, which are reduced pairwise,
+ *            and the results of the blocks are combined in a fixed-shape tree. The tail
+ *            is loaded with masks, so any length and alignment is supported (aligned
+ *            loads for \p Aligned). No head is peeled so that the blocks do not depend
+ *            on the alignment of the operands.
+ *
+ * \param[in] x   pointer to the first element of x
+ * \param[in] y   pointer to the first element of y
+ * \param[in] N   number of elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Accumulators, bool Aligned>
+inline double simd_omp_reproducible(double const* const x, double const* const y, size_t const N)
+{
+    static_assert(Accumulators > 0, "At least a single accumulator is required");
+
+    typedef typename Isa::reg reg;
+    constexpr size_t width = Isa::width;
+    constexpr size_t step  = Accumulators*width;
+    static_assert(REPRODUCIBLE_BLOCK % step == 0, "A block must consist of entire unrolled iterations");
+
+    size_t const blocks = (N + REPRODUCIBLE_BLOCK - 1)/REPRODUCIBLE_BLOCK;
+
+    KernelVector<double> partials(blocks, 0.0);
+
+    #pragma omp parallel for schedule(static) shared(partials)
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        size_t const begin = b*REPRODUCIBLE_BLOCK;
+        size_t const end   = std::min(N, begin + REPRODUCIBLE_BLOCK);
+        size_t const body  = begin + (end - begin)/step*step;
+
+        reg _acc[Accumulators];
+        for (size_t a = 0; a < Accumulators; ++a)
+        {
+            _acc[a] = Isa::zero();
+        }
+
+        for (size_t i = begin; i < body; i += step)
+        {
+            #pragma GCC unroll 16
+            for (size_t a = 0; a < Accumulators; ++a)
+            {
+                reg const _x = (Aligned == true) ? Isa::load(x + i + a*width) : Isa::loadu(x + i + a*width);
+                reg const _y = (Aligned == true) ? Isa::load(y + i + a*width) : Isa::loadu(y + i + a*width);
+                _acc[a] = Isa::fmadd(_x, _y, _acc[a]);
+            }
+        }
+
+        // remaining elements of the last block that do not fill an unrolled iteration (masked loads)
+        for (size_t i = body; i < end; i += width)
+        {
+            size_t const m = std::min(end - i, width);
+            _acc[0] = Isa::fmadd(Isa::load_partial(x + i, m), Isa::load_partial(y + i, m), _acc[0]);
+        }
+
+        for (size_t stride = 1; stride < Accumulators; stride *= 2)
+        {
+            for (size_t a = 0; a + stride < Accumulators; a += 2*stride)
+            {
+                _acc[a] = Isa::add(_acc[a], _acc[a + stride]);
+            }
+        }
+        partials[b] = Isa::reduce(_acc[0]);
+    }
+
+    return pairwise_sum(partials.data(), blocks);
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // REPRODUCIBLE_H_INCLUDED
@@ -0,0 +1,185 @@
+#ifndef SCALING_H_INCLUDED
+#define SCALING_H_INCLUDED
+
+/**
+ * \file     scaling.hpp
+ * \mainpage Thread scaling of the kernels: the selected kernels are benchmarked
+ *           for an increasing number of OpenMP threads under different placement
+ *           policies, reporting speed-up and parallel efficiency with respect to a
+ *           single thread.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "affinity.hpp"
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "init.hpp"
+
+
+/**\struct ScalingSettings
+ * \brief  Settings of the thread scaling sweep
+*/
+struct ScalingSettings
+{
+    size_t                 length       = 1 << 24;   ///< number of elements per vector
+    size_t                 max_threads  = 0;         ///< largest number of threads, 0 for all hardware threads of the policy
+    std::vector<Placement> policies     = {Placement::compact, Placement::scatter, Placement::cores, Placement::smt};
+    size_t                 min_elements = 50000000;  ///< minimum number of elements processed per sample (determines the iterations)
+    bool                   csv          = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\fn        thread_counts
+ * \brief     Numbers of threads to be benchmarked: powers of two, the number of
+ *            physical cores and the maximum number of threads
+ *
+ * \param[in] max_threads   the largest number of threads
+ * \param[in] no_cores      the number of physical cores
+ * \return    Vector of strictly increasing thread counts
+*/
+inline std::vector<size_t> thread_counts(size_t const max_threads, size_t const no_cores)
+{
+    std::vector<size_t> counts;
+    for (size_t t = 1; t < max_threads; t *= 2)
+    {
+        counts.push_back(t);
+    }
+    if ((no_cores > 0) && (no_cores < max_threads))
+    {
+        counts.push_back(no_cores);
+    }
+    counts.push_back(max_threads);
+
+    std::sort(counts.begin(), counts.end());
+    counts.erase(std::unique(counts.begin(), counts.end()), counts.end());
+    return counts;
+}
+
+
+/**\fn         run_thread_scaling
+ * \brief      Benchmark the given kernels for 1..N threads for every placement
+ *             policy and print runtime, throughput, speed-up and parallel efficiency
+ *             (speed-up divided by the number of threads)
+ *
+ * \param[in]  kernels    the kernels to be benchmarked
+ * \param[in]  scaling    settings of the thread scaling
+ * \param[in]  settings   settings of the benchmark harness (the iterations are adapted
+ *                        to the length)
+ * \param[out] out        stream the results are written to
+*/
+template <typename T = double, typename Y = typename DotTraits<T>::y_type>
+inline void run_thread_scaling(std::vector<NamedKernel<T>> const &kernels, ScalingSettings const &scaling,
+                               BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    assert(scaling.length > 0);
+
+    #ifdef _OPENMP
+        int const initial_threads = omp_get_max_threads();
+    #endif
+
+    std::vector<HardwareThread> const topology = detect_topology();
+    size_t const no_cores = static_cast<size_t>(std::count_if(topology.begin(), topology.end(),
+                                                              [](HardwareThread const &t){ return t.smt == 0; }));
+
+    AlignedBuffer<T> x(init_vec<T>(scaling.length));
+    AlignedBuffer<Y> y(init_vec<Y>(scaling.length, 1));
+    std::span<T> const x_span = x.span();
+    std::span<Y> const y_span = y.span();
+
+    BenchmarkSettings adapted = settings;
+    adapted.iterations = std::max<size_t>(1, scaling.min_elements/scaling.length);
+
+    // the kernel column fits the longest name (e.g. "AVX512 OMP Reproducible")
+    size_t name_width = 16;
+    for (NamedKernel<T> const &kernel: kernels)
+    {
+        name_width = std::max(name_width, kernel.name.size() + 3);
+    }
+
+    if (scaling.csv == true)
+    {
+        out << "policy,kernel,threads,median_s,stddev_s,gbs,speedup,efficiency" << std::endl;
+    }
+    else
+    {
+        out << "THREAD SCALING (" << scaling.length << " elements, " << topology.size()
+            << " hardware threads on " << no_cores << " physical cores)" << std::endl;
+    }
+
+    for (Placement const policy: scaling.policies)
+    {
+        std::vector<int> const order       = placement_order(topology, policy);
+        size_t const           available   = (policy == Placement::none) ? topology.size() : order.size();
+        size_t const           max_threads = (scaling.max_threads > 0) ? std::min(scaling.max_threads, available) : available;
+
+        if (scaling.csv == false)
+        {
+            out << std::endl << "Placement: " << placement_name(policy) << std::endl;
+            out << std::left << std::setw(static_cast<int>(name_width)) << " kernel" << std::right << std::setw(9) << "threads"
+                << std::setw(14) << "median[ms]" << std::setw(10) << "stddev%" << std::setw(10) << "GB/s"
+                << std::setw(10) << "speedup" << std::setw(12) << "efficiency" << std::endl;
+        }
+
+        for (NamedKernel<T> const &kernel: kernels)
+        {
+            double single = 0.0;
+            for (size_t const threads: thread_counts(max_threads, std::min(no_cores, max_threads)))
+            {
+                if (pin_threads(threads, (policy == Placement::none) ? std::vector<int>() : order) == false)
+                {
+                    std::cerr << "Warning: could not pin " << threads << " threads with policy "
+                              << placement_name(policy) << std::endl;
+                }
+
+                BenchmarkResult const res = benchmark_fun<std::span<T>>(x_span, y_span, kernel.fun, adapted);
+                Statistics const     &s   = res.stats;
+                single = (threads == 1) ? s.median : single;
+                double const speedup    = single/s.median;
+                double const efficiency = speedup/threads;
+
+                if (scaling.csv == true)
+                {
+                    out << std::scientific << std::setprecision(6)
+                        << placement_name(policy) << "," << kernel.name << "," << threads << ","
+                        << s.median << "," << s.stddev << "," << res.gbs << "," << speedup << ","
+                        << efficiency << std::endl;
+                }
+                else
+                {
+                    out << std::fixed << std::left << std::setw(static_cast<int>(name_width)) << (" -" + kernel.name) << std::right
+                        << std::setw(9) << threads << std::setprecision(4) << std::setw(14) << s.median*1.0e3
+                        << std::setprecision(2) << std::setw(10) << 100.0*s.stddev/s.mean
+                        << std::setw(10) << res.gbs << std::setw(10) << speedup
+                        << std::setw(11) << 100.0*efficiency << "%" << std::endl;
+                }
+            }
+        }
+    }
+
+    // restore the initial state: all threads may run on all processors
+    #ifdef _OPENMP
+        pin_threads(static_cast<size_t>(initial_threads), std::vector<int>());
+    #endif
+}
+
+#endif // SCALING_H_INCLUDED
@@ -0,0 +1,233 @@
+#ifndef SIMD_KERNEL_H_INCLUDED
+#define SIMD_KERNEL_H_INCLUDED
+
+/**
+ * \file     simd_kernel.hpp
+ * \brief    policy-based dot product kernel for any SIMD instruction set
+ * \mainpage Dot product: a single kernel template that is parameterised on the
+ *           instruction set (a traits class wrapping the intrinsics, see e.g.
+ *           avx2_omp.hpp), the unroll factor, the number of independent
+ *           accumulators and the software-prefetch distance. Several independent
+ *           accumulators break the dependency chain of the fused multiply-adds so
+ *           that cores with several FMA ports are not bound by the FMA latency.
+ *           Every thread reduces its own accumulators, only the final results are
+ *           reduced by OpenMP. Besides double the traits classes may define other
+ *           element types (e.g. float or integers), a different element type of y,
+ *           a wider result type and accumulators that have to be flushed into
+ *           wider ones regularly to prevent integer overflows.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <xmmintrin.h>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        simd_accumulate_partial
+ * \brief     Multiply the first \p n elements of \p x and \p y with masked loads of the
+ *            instruction set \p Isa and add them to \p _res
+ *
+ * \param[in] x      pointer to the first element of x
+ * \param[in] y      pointer to the first element of y
+ * \param[in] n      number of elements (typically less than a cache line)
+ * \param[in] _res   the accumulator
+ * \return    The updated accumulator
+*/
+template <typename Isa>
+inline typename Isa::acc simd_accumulate_partial(typename Isa::value_type const* x, typename Isa::y_type const* y,
+                                                 size_t const n, typename Isa::acc _res)
+{
+    for (size_t k = 0; k < n; k += Isa::width)
+    {
+        size_t const m = std::min(n - k, Isa::width);
+        _res = Isa::fmadd(Isa::load_partial(x + k, m), Isa::load_partial(y + k, m), _res);
+    }
+    return _res;
+}
+
+
+/**\fn        simd_omp_kernel
+ * \brief     Calculate dot product of the \p N elements of \p x and \p y with the
+ *            instruction set \p Isa. Every iteration of the main loop processes
+ *            \p Unroll registers distributed round-robin over \p Accumulators
+ *            independent accumulators and prefetches the cache lines \p Prefetch
+ *            lines ahead (no prefetches for 0). For \p Aligned operands \p N must be
+ *            a multiple of the register width and \p x and \p y must be cache
+ *            aligned, otherwise the head is peeled up to the next cache line of \p x
+ *            and the tail is loaded with masks. If the traits define a flush interval
+ *            the accumulators are flushed after at most that many updates.
+ *
+ * \param[in] x   pointer to the first element of x
+ * \param[in] y   pointer to the first element of y
+ * \param[in] N   number of elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Unroll, size_t Accumulators, size_t Prefetch, bool Aligned>
+inline typename Isa::result_type simd_omp_kernel(typename Isa::value_type const* const x,
+                                                 typename Isa::y_type const* const y, size_t const N)
+{
+    static_assert((Unroll > 0) && (Accumulators > 0), "At least a single register and accumulator are required");
+    static_assert(Unroll % Accumulators == 0, "The unrolled registers must be distributed evenly over the accumulators");
+    static_assert(sizeof(typename Isa::value_type) == sizeof(typename Isa::y_type), "Elements of x and y must be of equal size");
+
+    typedef typename Isa::reg         reg;
+    typedef typename Isa::acc         acc;
+    typedef typename Isa::result_type result_type;
+    constexpr size_t width = Isa::width;
+    constexpr size_t step  = Unroll*width;
+    constexpr size_t line  = CACHE_LINE/sizeof(typename Isa::value_type);
+    constexpr size_t lines = (step > line) ? step/line : 1;
+    constexpr size_t flush = (Isa::flush_interval > 0) ? std::max<size_t>(1, Isa::flush_interval/(Unroll/Accumulators)) : 0;
+
+    // split into peeled head, unrolled main loop, single registers and masked tail
+    size_t const offset = (reinterpret_cast<std::uintptr_t>(x) % CACHE_LINE)/sizeof(typename Isa::value_type);
+    size_t const head   = (Aligned == true) ? 0 : std::min(N, (line - offset) % line);
+    size_t const body   = head + (N - head)/step*step;
+    size_t const end    = head + (N - head)/width*width;
+    assert((Aligned == false) || ((offset == 0) && (end == N)));
+
+    acc _rest = simd_accumulate_partial<Isa>(x, y, head, Isa::zero());
+    _rest     = simd_accumulate_partial<Isa>(x + end, y + end, N - end, _rest);
+    result_type res = Isa::reduce(_rest);
+
+    #pragma omp parallel reduction(+: res)
+    {
+        acc    _acc[Accumulators];
+        size_t updates = 0;
+        for (size_t a = 0; a < Accumulators; ++a)
+        {
+            _acc[a] = Isa::zero();
+        }
+
+        #pragma omp for schedule(static) nowait
+        for (size_t i = head; i < body; i += step)
+        {
+            if constexpr (Prefetch > 0)
+            {
+                for (size_t l = 0; l < lines; ++l)
+                {
+                    _mm_prefetch(reinterpret_cast<char const*>(x + i + (Prefetch + l)*line), _MM_HINT_T0);
+                    _mm_prefetch(reinterpret_cast<char const*>(y + i + (Prefetch + l)*line), _MM_HINT_T0);
+                }
+            }
+
+            #pragma GCC unroll 16
+            for (size_t u = 0; u < Unroll; ++u)
+            {
+                reg const _y = (Aligned == true) ? Isa::load(y + i + u*width) : Isa::loadu(y + i + u*width);
+                _acc[u % Accumulators] = Isa::fmadd(Isa::load(x + i + u*width), _y, _acc[u % Accumulators]);
+            }
+
+            if constexpr (flush > 0)
+            {
+                if (++updates == flush)
+                {
+                    for (size_t a = 0; a < Accumulators; ++a)
+                    {
+                        _acc[a] = Isa::flush(_acc[a]);
+                    }
+                    updates = 0;
+                }
+            }
+        }
+
+        // remaining entire registers that do not fill an unrolled iteration
+        #pragma omp for schedule(static) nowait
+        for (size_t i = body; i < end; i += width)
+        {
+            reg const _y = (Aligned == true) ? Isa::load(y + i) : Isa::loadu(y + i);
+            _acc[0] = Isa::fmadd(Isa::load(x + i), _y, _acc[0]);
+        }
+
+        // reduce the accumulators pairwise to a single result (flushed first so that they cannot overflow)
+        if constexpr (flush > 0)
+        {
+            for (size_t a = 0; a < Accumulators; ++a)
+            {
+                _acc[a] = Isa::flush(_acc[a]);
+            }
+        }
+        for (size_t stride = 1; stride < Accumulators; stride *= 2)
+        {
+            for (size_t a = 0; a + stride < Accumulators; a += 2*stride)
+            {
+                _acc[a] = Isa::add(_acc[a], _acc[a + stride]);
+            }
+        }
+        res += Isa::reduce(_acc[0]);
+    }
+
+    return res;
+}
+
+
+/**\fn        simd_omp_span
+ * \brief     Calculate dot product of two aligned and padded vectors \p x and \p y with
+ *            the policy-based kernel (see simd_omp_kernel), container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Unroll, size_t Accumulators, size_t Prefetch = 0>
+inline typename Isa::result_type simd_omp_span(std::span<typename Isa::value_type> const &x,
+                                               std::span<typename Isa::y_type> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_kernel<Isa, Unroll, Accumulators, Prefetch, true>(x.data(), y.data(), x.size());
+}
+
+
+/**\fn        simd_omp_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment with the policy-based kernel (see simd_omp_kernel), container:
+ *            C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Unroll, size_t Accumulators, size_t Prefetch = 0>
+inline typename Isa::result_type simd_omp_unaligned(std::span<typename Isa::value_type const> const &x,
+                                                    std::span<typename Isa::y_type const> const &y)
+{
+    assert(x.size() == y.size());
+    return simd_omp_kernel<Isa, Unroll, Accumulators, Prefetch, false>(x.data(), y.data(), x.size());
+}
+
+
+/// instantiation matrix of the policy-based kernel for the instruction set ISA (see KernelVariant)
+#define SIMD_KERNEL_VARIANT(ISA,U,A,P) {.unroll = U, .accumulators = A, .prefetch = P, .dot_span = simd_omp_span<ISA, U, A, P>}
+#define SIMD_KERNEL_VARIANTS_PREFETCH(ISA,P)                                                     \
+    SIMD_KERNEL_VARIANT(ISA,1,1,P), SIMD_KERNEL_VARIANT(ISA,2,1,P), SIMD_KERNEL_VARIANT(ISA,2,2,P), \
+    SIMD_KERNEL_VARIANT(ISA,4,1,P), SIMD_KERNEL_VARIANT(ISA,4,2,P), SIMD_KERNEL_VARIANT(ISA,4,4,P), \
+    SIMD_KERNEL_VARIANT(ISA,8,2,P), SIMD_KERNEL_VARIANT(ISA,8,4,P), SIMD_KERNEL_VARIANT(ISA,8,8,P)
+#define SIMD_KERNEL_VARIANTS(ISA)                                                                \
+    SIMD_KERNEL_VARIANTS_PREFETCH(ISA,0), SIMD_KERNEL_VARIANTS_PREFETCH(ISA,4),                  \
+    SIMD_KERNEL_VARIANTS_PREFETCH(ISA,16)
+
+} // namespace ISA_NAMESPACE
+
+#endif // SIMD_KERNEL_H_INCLUDED
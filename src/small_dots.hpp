@@ -0,0 +1,178 @@
+#ifndef SMALL_DOTS_H_INCLUDED
+#define SMALL_DOTS_H_INCLUDED
+
+/**
+ * \file     small_dots.hpp
+ * \mainpage Benchmark of the dot products of many pairs of tiny vectors stored as
+ *           structure of arrays (see soa.hpp) for vectors of 3, 4, 8 and 16 elements.
+ *           For every dimension a loop over the pairs stored one after the other (array
+ *           of structures) in a single parallel region is the reference, the kernels of
+ *           every instruction set of the host vectorised across the pairs are compared
+ *           to it. Besides the millions of dot products per second the speed-up and the
+ *           largest relative deviation from the reference are reported.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "soa.hpp"
+
+
+/**\struct SoaSettings
+ * \brief  Settings of the benchmark of the dot products of tiny vectors
+*/
+struct SoaSettings
+{
+    size_t                   pairs = 4194304;        ///< number of pairs of vectors
+    std::vector<size_t>      dims  = {3, 4, 8, 16};  ///< numbers of elements of the vectors
+    std::vector<std::string> ids;                    ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv   = false;          ///< print comma-separated values instead of a table
+};
+
+
+/**\struct SoaRow
+ * \brief  Result of a single kernel and dimension of the benchmark of the dot products of tiny vectors
+*/
+struct SoaRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          dim;          ///< number of elements of the vectors
+    BenchmarkResult res;          ///< statistics and throughput of the kernel for all pairs
+    double          speedup;      ///< speed-up over the loop over the array of structures
+    double          deviation;    ///< largest relative deviation from the results of the loop
+};
+
+
+/**\fn         print_soa_row
+ * \brief      Print a row of the benchmark of the dot products of tiny vectors (or the
+ *             header if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_soa_row(SoaRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,dim,median_s,min_s,mad_s,mdots_per_s,gbs,speedup,max_rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(6) << "dim"
+            << std::setw(12) << "median[us]" << std::setw(10) << "MAD%" << std::setw(12) << "Mdots/s"
+            << std::setw(10) << "GB/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s     = row->res.stats;
+    double const      mdots = 1.0e3/row->res.ns_per_elem;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->dim << "," << s.median << "," << s.min << "," << s.mad << ","
+            << mdots << "," << row->res.gbs << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(6) << row->dim
+        << std::setprecision(3) << std::setw(12) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setprecision(1) << std::setw(12) << mdots
+        << std::setprecision(2) << std::setw(10) << row->res.gbs << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         run_small_dots
+ * \brief      Benchmark the dot products of many pairs of tiny vectors of the instruction
+ *             sets supported by the host against a loop over the array of structures
+ *
+ * \param[in]  soa        settings of the benchmark of the dot products of tiny vectors
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_small_dots(SoaSettings const &soa, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (soa.csv == false)
+    {
+        out << "DOT PRODUCTS OF TINY VECTORS (" << soa.pairs << " pairs, structure of arrays vectorised across the pairs)" << std::endl;
+    }
+    print_soa_row(nullptr, out, soa.csv);
+
+    size_t const        pairs = soa.pairs;
+    std::vector<double> loop_results(pairs, 0.0);
+    std::vector<double> soa_results(pairs, 0.0);
+
+    for (size_t const dim: soa.dims)
+    {
+        AlignedBuffer<double> x(init_vec<double>(pairs*dim));
+        AlignedBuffer<double> y(init_vec<double>(pairs*dim, 1));
+        double const* const   xd = x.data();
+        double const* const   yd = y.data();
+        SoaVectors const      x_soa = make_soa_vectors(std::span<double const>(xd, pairs*dim), dim);
+        SoaVectors const      y_soa = make_soa_vectors(std::span<double const>(yd, pairs*dim), dim);
+        double const          bytes = sizeof(double)*(2.0*dim + 1.0);
+
+        BenchmarkResult const loop = benchmark_callable([&]()
+        {
+            double* const r = loop_results.data();
+
+            #pragma omp parallel for schedule(static)
+            for (size_t j = 0; j < pairs; ++j)
+            {
+                double sum = 0.0;
+                for (size_t d = 0; d < dim; ++d)
+                {
+                    sum += xd[j*dim + d]*yd[j*dim + d];
+                }
+                r[j] = sum;
+            }
+            return r[0];
+        }, pairs, bytes, 2.0*dim, settings);
+        SoaRow const loop_row = {"array of structures loop", dim, loop, 1.0, 0.0};
+        print_soa_row(&loop_row, out, soa.csv);
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((soa.ids.empty() == false) && (std::find(soa.ids.begin(), soa.ids.end(), table->id) == soa.ids.end()))
+            {
+                continue;
+            }
+
+            dot_soa_fun const     kernel = soa_kernel(*table, dim);
+            BenchmarkResult const res    = benchmark_callable([&]()
+            {
+                kernel(x_soa, y_soa, soa_results);
+                return soa_results[0];
+            }, pairs, bytes, 2.0*dim, settings);
+
+            double deviation = 0.0;
+            for (size_t j = 0; j < pairs; ++j)
+            {
+                deviation = std::max(deviation, std::abs(soa_results[j] - loop_results[j])/std::abs(loop_results[j]));
+            }
+            SoaRow const row = {std::string(table->id) + " soa", dim, res, loop.stats.median/res.stats.median, deviation};
+            print_soa_row(&row, out, soa.csv);
+        }
+    }
+}
+
+#endif // SMALL_DOTS_H_INCLUDED
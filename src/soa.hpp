@@ -0,0 +1,183 @@
+#ifndef SOA_H_INCLUDED
+#define SOA_H_INCLUDED
+
+/**
+ * \file     soa.hpp
+ * \brief    dot products of many pairs of tiny vectors stored as structure of arrays
+ * \mainpage Dot products of millions of pairs of vectors with only a few elements (e.g.
+ *           3 and 4 for geometry, 8 and 16 for physics) are shorter than a single
+ *           register, so that vectorising a single dot product does not pay off. The
+ *           vectors are stored as structure of arrays instead (element d of all vectors
+ *           contiguous) and the SIMD lanes compute the dot products of width different
+ *           pairs at once: for every element d a register of x and one of y are loaded
+ *           and multiplied-added, the loop over the elements is unrolled entirely as the
+ *           dimension is a template parameter. The pairs are distributed over the threads
+ *           statically.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/**\struct SoaVectors
+ * \brief  Collection of vectors of dim elements each stored as structure of arrays:
+ *         element d of vector j at data[d*stride + j], every array starting at a cache line
+*/
+struct SoaVectors
+{
+    size_t                dim    = 0;   ///< number of elements of a vector
+    size_t                size   = 0;   ///< number of vectors
+    size_t                stride = 0;   ///< distance between the arrays of two elements (multiple of a cache line)
+                                        ///< with an extra cache line so that the arrays do not map to the same
+                                        ///< cache sets for sizes that are powers of two
+    AlignedBuffer<double> data;         ///< the arrays of all elements (padded with zeros)
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        make_soa_vectors
+ * \brief     Store the \p vectors of \p dim elements each (one after the other) as
+ *            structure of arrays
+ *
+ * \param[in] vectors   the vectors one after the other
+ * \param[in] dim       number of elements of a vector
+ * \return    The vectors as structure of arrays
+*/
+inline SoaVectors make_soa_vectors(std::span<double const> const &vectors, size_t const dim)
+{
+    assert((dim > 0) && (vectors.size() % dim == 0));
+
+    SoaVectors soa;
+    soa.dim    = dim;
+    soa.size   = vectors.size()/dim;
+    soa.stride = soa.size + PAD(soa.size, double) + CACHE_LINE/sizeof(double);
+    soa.data   = AlignedBuffer<double>(dim*soa.stride);
+
+    double* const data = soa.data.data();
+    size_t const  size = soa.size;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < size; ++j)
+    {
+        for (size_t d = 0; d < dim; ++d)
+        {
+            data[d*soa.stride + j] = vectors[j*dim + d];
+        }
+    }
+    return soa;
+}
+
+
+/**\fn         scalar_omp_soa
+ * \brief      Calculate the dot products r_j = x_j·y_j of all pairs of vectors of Dim
+ *             elements (any number of elements for Dim = 0) stored as structure of arrays
+ *             without manual vectorisation
+ *
+ * \param[in]  x   the first vectors of the pairs
+ * \param[in]  y   the second vectors of the pairs
+ * \param[out] r   the dot products of the pairs
+*/
+template <size_t Dim>
+inline void scalar_omp_soa(SoaVectors const &x, SoaVectors const &y, std::span<double> const &r)
+{
+    assert(((Dim == 0) || (x.dim == Dim)) && (y.dim == x.dim) && (x.size == y.size) && (r.size() == x.size));
+
+    double const* const xd   = x.data.data();
+    double const* const yd   = y.data.data();
+    size_t const        size = x.size;
+    size_t const        dim  = (Dim > 0) ? Dim : x.dim;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < size; ++j)
+    {
+        double sum = xd[j]*yd[j];
+        #pragma GCC unroll 16
+        for (size_t d = 1; d < dim; ++d)
+        {
+            sum += xd[d*x.stride + j]*yd[d*y.stride + j];
+        }
+        r[j] = sum;
+    }
+}
+
+
+/**\fn         simd_soa_register
+ * \brief      Calculate the dot products of the width pairs starting at pair \p j with the
+ *             instruction set \p Isa, the loop over the Dim elements being unrolled entirely
+ *
+ * \param[in]  x          pointer to the array of the first element of the first vectors
+ * \param[in]  x_stride   distance between the arrays of two elements of \p x
+ * \param[in]  y          pointer to the array of the first element of the second vectors
+ * \param[in]  y_stride   distance between the arrays of two elements of \p y
+ * \param[in]  j          index of the first pair (multiple of the register width)
+ * \return     Register with the dot products of the pairs
+*/
+template <typename Isa, size_t Dim>
+inline typename Isa::reg simd_soa_register(double const* const x, size_t const x_stride,
+                                           double const* const y, size_t const y_stride, size_t const j)
+{
+    typename Isa::reg _sum = Isa::mul(Isa::load(x + j), Isa::load(y + j));
+    #pragma GCC unroll 16
+    for (size_t d = 1; d < Dim; ++d)
+    {
+        _sum = Isa::fmadd(Isa::load(x + d*x_stride + j), Isa::load(y + d*y_stride + j), _sum);
+    }
+    return _sum;
+}
+
+
+/**\fn         simd_omp_soa
+ * \brief      Calculate the dot products r_j = x_j·y_j of all pairs of vectors of Dim
+ *             elements stored as structure of arrays with the instruction set \p Isa,
+ *             vectorised across the pairs (see soa.hpp)
+ *
+ * \param[in]  x   the first vectors of the pairs
+ * \param[in]  y   the second vectors of the pairs
+ * \param[out] r   the dot products of the pairs
+*/
+template <typename Isa, size_t Dim>
+inline void simd_omp_soa(SoaVectors const &x, SoaVectors const &y, std::span<double> const &r)
+{
+    assert((x.dim == Dim) && (y.dim == Dim) && (x.size == y.size) && (r.size() == x.size));
+
+    constexpr size_t    width = Isa::width;
+    double const* const xd    = x.data.data();
+    double const* const yd    = y.data.data();
+    size_t const        size  = x.size;
+    size_t const        full  = size/width*width;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < full; j += width)
+    {
+        Isa::storeu(r.data() + j, simd_soa_register<Isa, Dim>(xd, x.stride, yd, y.stride, j));
+    }
+
+    // the last pairs are completed by the zero padding of the arrays
+    if (full < size)
+    {
+        alignas(CACHE_LINE) double tail[width];
+        Isa::storeu(tail, simd_soa_register<Isa, Dim>(xd, x.stride, yd, y.stride, full));
+        std::copy(tail, tail + (size - full), r.data() + full);
+    }
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // SOA_H_INCLUDED
@@ -0,0 +1,402 @@
+#ifndef SPARSE_H_INCLUDED
+#define SPARSE_H_INCLUDED
+
+/**
+ * \file     sparse.hpp
+ * \brief    dot product of a sparse vector with a dense vector
+ * \mainpage Dot product of a sparse vector stored as sorted positions and values of its
+ *           nonzeros (like a row of a matrix in compressed sparse row format) with a
+ *           dense vector, without expanding the sparse vector. The SIMD kernels load a
+ *           register of nonzeros and gather the matching elements of the dense vector
+ *           with the 64 or 32 bit positions, several registers are accumulated
+ *           independently. The nonzeros are distributed over the threads statically.
+ *           For a density of a few percent only the nonzeros and the cache lines of the
+ *           dense vector they hit have to be read instead of both dense vectors.
+ *           The dot product of two sparse vectors intersects the sorted positions: the
+ *           SIMD kernels compare a register of positions of either vector all-to-all and
+ *           multiply-add the values of equal positions, the vector whose register ends
+ *           first advances. If the ranges of both registers do not overlap the vector
+ *           behind gallops (exponential and binary search) to the first position of the
+ *           other, so that vectors with very different numbers of nonzeros skip most of
+ *           the larger one. A register of the smaller vector spanning many registers of
+ *           the larger one would still be compared to all of them, so from a ratio of the
+ *           numbers of nonzeros of SPARSE_GALLOP_RATIO on every element of the smaller
+ *           vector gallops through the larger one instead. The range of positions is split
+ *           among the threads with equal numbers of nonzeros of the larger vector.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include "align.hpp"
+#include "gemv.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of registers of nonzeros per iteration of the SIMD kernels (independent accumulators)
+#define SPARSE_UNROLL 4
+
+/// ratio of the numbers of nonzeros from which on the SIMD kernels of two sparse vectors gallop element-wise
+#define SPARSE_GALLOP_RATIO 48
+
+
+/**\struct SparseVector
+ * \brief  Sparse vector of dim elements stored as the sorted positions of its nonzeros
+ *         (of type Index) and their values
+*/
+template <typename Index = std::int64_t>
+struct SparseVector
+{
+    size_t                dim = 0;   ///< number of elements of the dense vector
+    AlignedBuffer<Index>  indices;   ///< ascending positions of the nonzeros
+    AlignedBuffer<double> values;    ///< values of the nonzeros
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        make_sparse_vector
+ * \brief     Store the nonzero elements of the dense vector \p dense as sparse vector
+ *
+ * \param[in] dense   the dense vector
+ * \return    The sparse vector
+*/
+template <typename Index = std::int64_t>
+inline SparseVector<Index> make_sparse_vector(std::span<double const> const &dense)
+{
+    assert(dense.size() <= static_cast<size_t>(std::numeric_limits<Index>::max()));
+
+    size_t nnz = 0;
+    for (double const v: dense)
+    {
+        nnz += (std::fpclassify(v) != FP_ZERO);
+    }
+
+    SparseVector<Index> sparse;
+    sparse.dim     = dense.size();
+    sparse.indices = AlignedBuffer<Index>(nnz);
+    sparse.values  = AlignedBuffer<double>(nnz);
+
+    size_t j = 0;
+    for (size_t i = 0; i < dense.size(); ++i)
+    {
+        if (std::fpclassify(dense[i]) != FP_ZERO)
+        {
+            sparse.indices[j] = static_cast<Index>(i);
+            sparse.values[j]  = dense[i];
+            ++j;
+        }
+    }
+    return sparse;
+}
+
+
+/**\fn        scalar_omp_sparse
+ * \brief     Calculate dot product of the sparse vector \p x and the dense vector \p y
+ *            without manual vectorisation
+ *
+ * \param[in] x   the sparse vector
+ * \param[in] y   the dense vector of x.dim elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Index>
+inline double scalar_omp_sparse(SparseVector<Index> const &x, std::span<double const> const &y)
+{
+    assert(x.dim == y.size());
+
+    Index const* const  indices = x.indices.data();
+    double const* const values  = x.values.data();
+    double const* const yd      = y.data();
+    size_t const        nnz     = x.indices.size();
+
+    double res = 0.0;
+
+    #pragma omp parallel for schedule(static) reduction(+: res)
+    for (size_t i = 0; i < nnz; ++i)
+    {
+        res += values[i]*yd[indices[i]];
+    }
+
+    return res;
+}
+
+
+/**\fn        simd_omp_sparse
+ * \brief     Calculate dot product of the sparse vector \p x and the dense vector \p y
+ *            with the instruction set \p Isa: every register of nonzeros is multiplied
+ *            with the elements of y gathered at their positions, \p Unroll registers are
+ *            accumulated independently and the last nonzeros that do not fill a
+ *            register are added one by one
+ *
+ * \param[in] x   the sparse vector
+ * \param[in] y   the dense vector of x.dim elements
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, size_t Unroll, typename Index>
+inline double simd_omp_sparse(SparseVector<Index> const &x, std::span<double const> const &y)
+{
+    static_assert(Unroll > 0, "At least a single register is required");
+    assert(x.dim == y.size());
+
+    typedef typename Isa::reg reg;
+    constexpr size_t    width   = Isa::width;
+    constexpr size_t    step    = Unroll*width;
+    Index const* const  indices = x.indices.data();
+    double const* const values  = x.values.data();
+    double const* const yd      = y.data();
+    size_t const        nnz     = x.indices.size();
+    size_t const        body    = nnz/step*step;
+    size_t const        end     = nnz/width*width;
+
+    double res = 0.0;
+    for (size_t i = end; i < nnz; ++i)
+    {
+        res += values[i]*yd[indices[i]];
+    }
+
+    #pragma omp parallel reduction(+: res)
+    {
+        reg _acc[Unroll];
+        for (size_t u = 0; u < Unroll; ++u)
+        {
+            _acc[u] = Isa::zero();
+        }
+
+        #pragma omp for schedule(static) nowait
+        for (size_t i = 0; i < body; i += step)
+        {
+            #pragma GCC unroll 16
+            for (size_t u = 0; u < Unroll; ++u)
+            {
+                _acc[u] = Isa::fmadd(Isa::loadu(values + i + u*width), Isa::gather(yd, indices + i + u*width), _acc[u]);
+            }
+        }
+
+        // remaining entire registers that do not fill an unrolled iteration
+        #pragma omp for schedule(static) nowait
+        for (size_t i = body; i < end; i += width)
+        {
+            _acc[0] = Isa::fmadd(Isa::loadu(values + i), Isa::gather(yd, indices + i), _acc[0]);
+        }
+
+        for (size_t stride = 1; stride < Unroll; stride *= 2)
+        {
+            for (size_t u = 0; u + stride < Unroll; u += 2*stride)
+            {
+                _acc[u] = Isa::add(_acc[u], _acc[u + stride]);
+            }
+        }
+        res += Isa::reduce(_acc[0]);
+    }
+
+    return res;
+}
+
+
+/**\fn        gallop
+ * \brief     Position of the first element of the sorted \p indices in [\p begin, \p end)
+ *            that is not less than \p value by an exponential search from \p begin
+ *            followed by a binary search, so that short skips are cheap
+ *
+ * \param[in] indices   the sorted positions
+ * \param[in] begin     first element to be searched
+ * \param[in] end       element behind the last one to be searched
+ * \param[in] value     the wished position
+ * \return    The first element not less than \p value (or \p end)
+*/
+template <typename Index>
+inline size_t gallop(Index const* const indices, size_t begin, size_t const end, Index const value)
+{
+    size_t step = 1;
+    while ((begin + step < end) && (indices[begin + step] < value))
+    {
+        begin += step;
+        step  *= 2;
+    }
+    return std::lower_bound(indices + begin, indices + std::min(end, begin + step + 1), value) - indices;
+}
+
+
+/**\fn        sparse_merge
+ * \brief     Sum of the products of the values of the elements with equal positions of
+ *            the elements [\p i, \p i_end) of \p a and [\p j, \p j_end) of \p b, the
+ *            vector behind gallops to the position of the other one
+ *
+ * \param[in] a       the first sparse vector
+ * \param[in] i       first element of \p a
+ * \param[in] i_end   element of \p a behind the last one
+ * \param[in] b       the second sparse vector
+ * \param[in] j       first element of \p b
+ * \param[in] j_end   element of \p b behind the last one
+ * \return    The sum of the products
+*/
+template <typename Index>
+inline double sparse_merge(SparseVector<Index> const &a, size_t i, size_t const i_end,
+                           SparseVector<Index> const &b, size_t j, size_t const j_end)
+{
+    Index const* const ai  = a.indices.data();
+    Index const* const bi  = b.indices.data();
+    double             res = 0.0;
+
+    while ((i < i_end) && (j < j_end))
+    {
+        if (ai[i] < bi[j])
+        {
+            i = gallop(ai, i, i_end, bi[j]);
+        }
+        else if (bi[j] < ai[i])
+        {
+            j = gallop(bi, j, j_end, ai[i]);
+        }
+        else
+        {
+            res += a.values[i]*b.values[j];
+            ++i;
+            ++j;
+        }
+    }
+    return res;
+}
+
+
+/**\fn         sparse_thread_ranges
+ * \brief      Elements of the sparse vectors \p a and \p b thread \p t of \p threads
+ *             intersects: the elements of the larger vector \p b are split evenly, the
+ *             ones of \p a with positions in the same range belong to the same thread
+ *
+ * \param[in]  a         the sparse vector with fewer nonzeros
+ * \param[in]  b         the sparse vector with more nonzeros
+ * \param[in]  t         number of the thread
+ * \param[in]  threads   number of threads
+ * \param[out] i         first element of \p a
+ * \param[out] i_end     element of \p a behind the last one
+ * \param[out] j         first element of \p b
+ * \param[out] j_end     element of \p b behind the last one
+*/
+template <typename Index>
+inline void sparse_thread_ranges(SparseVector<Index> const &a, SparseVector<Index> const &b,
+                                 size_t const t, size_t const threads,
+                                 size_t &i, size_t &i_end, size_t &j, size_t &j_end)
+{
+    Index const* const ai  = a.indices.data();
+    Index const* const bi  = b.indices.data();
+    size_t const       nnz = a.indices.size();
+
+    size_t const       n   = b.indices.size();
+
+    split_range(n, 1, t, threads, j, j_end);
+    i     = (j == 0) ? 0 : ((j == n) ? nnz : std::lower_bound(ai, ai + nnz, bi[j]) - ai);
+    i_end = (j_end == n) ? nnz : std::lower_bound(ai, ai + nnz, bi[j_end]) - ai;
+}
+
+
+/**\fn        scalar_omp_sparse_sparse
+ * \brief     Calculate dot product of the sparse vectors \p x and \p y by intersecting
+ *            their positions without manual vectorisation
+ *
+ * \param[in] x   the first sparse vector
+ * \param[in] y   the second sparse vector of the same dimension
+ * \return    Dot product of the two vectors
+*/
+template <typename Index>
+inline double scalar_omp_sparse_sparse(SparseVector<Index> const &x, SparseVector<Index> const &y)
+{
+    assert(x.dim == y.dim);
+
+    bool const                 swap = (x.indices.size() > y.indices.size());
+    SparseVector<Index> const &a    = (swap == true) ? y : x;
+    SparseVector<Index> const &b    = (swap == true) ? x : y;
+
+    double res = 0.0;
+
+    #pragma omp parallel reduction(+: res)
+    {
+        size_t i = 0, i_end = 0, j = 0, j_end = 0;
+        sparse_thread_ranges(a, b, omp_get_thread_num(), omp_get_num_threads(), i, i_end, j, j_end);
+        res += sparse_merge(a, i, i_end, b, j, j_end);
+    }
+
+    return res;
+}
+
+
+/**\fn        simd_omp_sparse_sparse
+ * \brief     Calculate dot product of the sparse vectors \p x and \p y by intersecting
+ *            their positions register by register with the instruction set \p Isa (see
+ *            sparse.hpp), the last elements that do not fill a register are merged one
+ *            by one as well as all elements of very different numbers of nonzeros
+ *
+ * \param[in] x   the first sparse vector
+ * \param[in] y   the second sparse vector of the same dimension
+ * \return    Dot product of the two vectors
+*/
+template <typename Isa, typename Index>
+inline double simd_omp_sparse_sparse(SparseVector<Index> const &x, SparseVector<Index> const &y)
+{
+    assert(x.dim == y.dim);
+
+    typedef typename Isa::reg reg;
+    constexpr size_t          width = Isa::width;
+    bool const                 swap = (x.indices.size() > y.indices.size());
+    SparseVector<Index> const &a    = (swap == true) ? y : x;
+    SparseVector<Index> const &b    = (swap == true) ? x : y;
+    Index const* const         ai   = a.indices.data();
+    Index const* const         bi   = b.indices.data();
+
+    double res = 0.0;
+
+    #pragma omp parallel reduction(+: res)
+    {
+        size_t i = 0, i_end = 0, j = 0, j_end = 0;
+        sparse_thread_ranges(a, b, omp_get_thread_num(), omp_get_num_threads(), i, i_end, j, j_end);
+
+        reg _acc = Isa::zero();
+        while ((j_end - j <= SPARSE_GALLOP_RATIO*(i_end - i)) && (i + width <= i_end) && (j + width <= j_end))
+        {
+            Index const a_last = ai[i + width - 1];
+            Index const b_last = bi[j + width - 1];
+            if (a_last < bi[j])
+            {
+                i = gallop(ai, i, i_end, bi[j]);
+            }
+            else if (b_last < ai[i])
+            {
+                j = gallop(bi, j, j_end, ai[i]);
+            }
+            else
+            {
+                _acc = Isa::intersect(ai + i, a.values.data() + i, bi + j, b.values.data() + j, _acc);
+                i   += (a_last <= b_last) ? width : 0;
+                j   += (b_last <= a_last) ? width : 0;
+            }
+        }
+        res += Isa::reduce(_acc) + sparse_merge(a, i, i_end, b, j, j_end);
+    }
+
+    return res;
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // SPARSE_H_INCLUDED
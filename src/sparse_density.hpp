@@ -0,0 +1,216 @@
+#ifndef SPARSE_DENSITY_H_INCLUDED
+#define SPARSE_DENSITY_H_INCLUDED
+
+/**
+ * \file     sparse_density.hpp
+ * \mainpage Benchmark of the dot product of a sparse vector with a dense vector (see
+ *           sparse.hpp) for densities from 0.1% to 50%. The nonzeros are placed at random
+ *           positions. For every density the dense kernel applied to the expanded sparse
+ *           vector is the reference, expanding the sparse vector before every call is
+ *           benchmarked as well. The sparse kernels with 64 and 32 bit positions of every
+ *           instruction set of the host are compared to it, so that the density up to
+ *           which the sparse representation pays off can be read off the speed-up.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "random.hpp"
+#include "sparse.hpp"
+
+
+/**\struct SparseSettings
+ * \brief  Settings of the benchmark of the sparse-dense dot product
+*/
+struct SparseSettings
+{
+    size_t                   length    = 8388608;   ///< number of elements of the dense vectors
+    std::vector<double>      densities = {0.001, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5};  ///< fractions of nonzeros
+    std::vector<std::string> ids;                   ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv       = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\struct SparseRow
+ * \brief  Result of a single kernel and density of the benchmark of the sparse-dense dot product
+*/
+struct SparseRow
+{
+    std::string     name;         ///< name of the kernel
+    double          density;      ///< fraction of nonzeros of the sparse vector
+    size_t          nnz;          ///< number of nonzeros of the sparse vector
+    BenchmarkResult res;          ///< statistics and throughput of the kernel
+    double          speedup;      ///< speed-up over the dense kernel
+    double          deviation;    ///< relative deviation from the result of the dense kernel
+};
+
+
+/**\fn         print_sparse_row
+ * \brief      Print a row of the benchmark of the sparse-dense dot product (or the header
+ *             if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_sparse_row(SparseRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,density,nnz,median_s,min_s,mad_s,gbs,speedup,rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(10) << "density%"
+            << std::setw(12) << "nnz" << std::setw(14) << "median[us]" << std::setw(10) << "MAD%"
+            << std::setw(10) << "GB/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->density << "," << row->nnz << "," << s.median << "," << s.min << ","
+            << s.mad << "," << row->res.gbs << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setprecision(2)
+        << std::setw(10) << 100.0*row->density << std::setw(12) << row->nnz << std::setprecision(3)
+        << std::setw(14) << s.median*1.0e6 << std::setprecision(2) << std::setw(10) << 100.0*s.mad/s.median
+        << std::setw(10) << row->res.gbs << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn        random_sparse
+ * \brief     Dense vector of \p length elements of which a fraction \p density (on
+ *            average) at random positions are random numbers in (0,1], all others zero
+ *            (streams \p stream and \p stream + 1 of the seed)
+ *
+ * \param[in] length    number of elements
+ * \param[in] density   probability of an element to be nonzero
+ * \param[in] stream    number of the random stream
+ * \return    The dense vector
+*/
+inline AlignedBuffer<double> random_sparse(size_t const length, double const density, std::uint64_t const stream)
+{
+    AlignedBuffer<double> dense(length);
+    std::uint64_t const   positions = random_key(random_seed(), stream);
+    std::uint64_t const   values    = random_key(random_seed(), stream + 1);
+    double* const         d         = dense.data();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < length; ++i)
+    {
+        bool const nonzero = (random_unit(random_bits(positions, i)) < density);
+        d[i] = (nonzero == true) ? 1.0 - random_unit(random_bits(values, i)) : 0.0;
+    }
+    return dense;
+}
+
+
+/**\fn         run_sparse_density
+ * \brief      Benchmark the sparse-dense dot products of the instruction sets supported
+ *             by the host against the dense kernel for increasing densities
+ *
+ * \param[in]  sparse     settings of the benchmark of the sparse-dense dot product
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_sparse_density(SparseSettings const &sparse, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (sparse.csv == false)
+    {
+        out << "SPARSE-DENSE DOT PRODUCT (" << sparse.length << " elements, nonzeros at random positions, "
+            << SPARSE_UNROLL << " registers of gathers per iteration)" << std::endl;
+    }
+    print_sparse_row(nullptr, out, sparse.csv);
+
+    size_t const                  length = sparse.length;
+    AlignedBuffer<double>         y(init_vec<double>(length, 1));
+    AlignedBuffer<double>         expanded(length);
+    std::span<double const> const y_span(y.data(), length);
+    std::span<double const> const expanded_span(expanded.data(), length);
+    KernelTable const&            active = active_kernels();
+
+    for (double const density: sparse.densities)
+    {
+        AlignedBuffer<double> const   dense = random_sparse(length, density, 2);
+        std::span<double const> const dense_span(dense.data(), length);
+        SparseVector<int64_t> const   x   = make_sparse_vector<int64_t>(dense_span);
+        SparseVector<int32_t> const   x32 = make_sparse_vector<int32_t>(dense_span);
+        size_t const                  nnz = x.indices.size();
+
+        BenchmarkResult const reference = benchmark_callable([&]()
+        {
+            return active.dot_unaligned(dense_span, y_span);
+        }, length, 2.0*sizeof(double), 2.0, settings);
+        SparseRow const reference_row = {std::string(active.id) + " dense", density, nnz, reference, 1.0, 0.0};
+        print_sparse_row(&reference_row, out, sparse.csv);
+
+        auto const row = [&](std::string const &name, BenchmarkResult const &res)
+        {
+            SparseRow const r = {name, density, nnz, res, reference.stats.median/res.stats.median,
+                                 std::abs(res.result - reference.result)/std::abs(reference.result)};
+            print_sparse_row(&r, out, sparse.csv);
+        };
+
+        // what has to be done without sparse kernels: expand the sparse vector before every call
+        row(std::string(active.id) + " expand + dense", benchmark_callable([&]()
+        {
+            double* const e = expanded.data();
+
+            #pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < length; ++i)
+            {
+                e[i] = 0.0;
+            }
+            for (size_t j = 0; j < nnz; ++j)
+            {
+                e[x.indices[j]] = x.values[j];
+            }
+            return active.dot_unaligned(expanded_span, y_span);
+        }, length, 2.0*sizeof(double), 2.0, settings));
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((sparse.ids.empty() == false) && (std::find(sparse.ids.begin(), sparse.ids.end(), table->id) == sparse.ids.end()))
+            {
+                continue;
+            }
+
+            // bytes per nonzero: position, value and the gathered element of y
+            row(std::string(table->id) + " sparse", benchmark_callable([&]()
+            {
+                return table->sparse(x, y_span);
+            }, nnz, sizeof(int64_t) + 2.0*sizeof(double), 2.0, settings));
+            row(std::string(table->id) + " sparse32", benchmark_callable([&]()
+            {
+                return table->sparse32(x32, y_span);
+            }, nnz, sizeof(int32_t) + 2.0*sizeof(double), 2.0, settings));
+        }
+    }
+}
+
+#endif // SPARSE_DENSITY_H_INCLUDED
@@ -0,0 +1,186 @@
+#ifndef SPARSE_RATIO_H_INCLUDED
+#define SPARSE_RATIO_H_INCLUDED
+
+/**
+ * \file     sparse_ratio.hpp
+ * \mainpage Benchmark of the dot product of two sparse vectors (see sparse.hpp) for ratios
+ *           of their numbers of nonzeros from 1 to 1024. The larger vector has a fixed
+ *           number of nonzeros at random positions (an eighth of the dimension), the
+ *           smaller one fewer by the ratio. For every ratio the scalar merge of the
+ *           positions is the reference, expanding the larger vector and gathering with
+ *           the positions of the smaller one is benchmarked as well. The intersecting
+ *           kernels of every instruction set of the host are compared to it, the
+ *           throughput is given in million nonzeros of both vectors per second.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "sparse.hpp"
+#include "sparse_density.hpp"
+
+
+/**\struct IntersectSettings
+ * \brief  Settings of the benchmark of the dot product of two sparse vectors
+*/
+struct IntersectSettings
+{
+    size_t                   nnz    = 1048576;   ///< number of nonzeros of the larger vector
+    std::vector<size_t>      ratios = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};  ///< ratios of the numbers of nonzeros
+    std::vector<std::string> ids;                ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv    = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\struct IntersectRow
+ * \brief  Result of a single kernel and ratio of the benchmark of the dot product of two sparse vectors
+*/
+struct IntersectRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          ratio;        ///< ratio of the numbers of nonzeros of the larger and the smaller vector
+    size_t          nnz;          ///< number of nonzeros of the smaller vector
+    BenchmarkResult res;          ///< statistics of the kernel
+    double          mnnzs;        ///< million nonzeros of both vectors per second
+    double          speedup;      ///< speed-up over the scalar merge
+    double          deviation;    ///< relative deviation from the result of the scalar merge
+};
+
+
+/**\fn         print_intersect_row
+ * \brief      Print a row of the benchmark of the dot product of two sparse vectors (or the
+ *             header if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_intersect_row(IntersectRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,ratio,nnz,median_s,min_s,mad_s,mnnz_s,speedup,rel_deviation" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(8) << "ratio"
+            << std::setw(12) << "nnz" << std::setw(14) << "median[us]" << std::setw(10) << "MAD%"
+            << std::setw(10) << "Mnnz/s" << std::setw(10) << "speedup" << std::setw(14) << "deviation" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->ratio << "," << row->nnz << "," << s.median << "," << s.min << ","
+            << s.mad << "," << row->mnnzs << "," << row->speedup << "," << row->deviation << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(8) << row->ratio
+        << std::setw(12) << row->nnz << std::setprecision(3) << std::setw(14) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setprecision(1) << std::setw(10) << row->mnnzs
+        << std::setprecision(2) << std::setw(10) << row->speedup
+        << std::scientific << std::setprecision(3) << std::setw(14) << row->deviation << std::fixed << std::endl;
+}
+
+
+/**\fn         run_sparse_ratio
+ * \brief      Benchmark the dot products of two sparse vectors of the instruction sets
+ *             supported by the host against the scalar merge for increasing ratios of
+ *             their numbers of nonzeros
+ *
+ * \param[in]  intersect   settings of the benchmark of the dot product of two sparse vectors
+ * \param[in]  settings    settings of the benchmark harness
+ * \param[out] out         stream the results are written to
+*/
+inline void run_sparse_ratio(IntersectSettings const &intersect, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    size_t const dim = 8*intersect.nnz;
+    if (intersect.csv == false)
+    {
+        out << "SPARSE-SPARSE DOT PRODUCT (" << dim << " elements, " << intersect.nnz
+            << " nonzeros of the larger vector at random positions)" << std::endl;
+    }
+    print_intersect_row(nullptr, out, intersect.csv);
+
+    AlignedBuffer<double> const   dense_b = random_sparse(dim, 0.125, 2);
+    SparseVector<int64_t> const   b       = make_sparse_vector<int64_t>(std::span<double const>(dense_b.data(), dim));
+    AlignedBuffer<double>         expanded(dim);
+    std::span<double const> const expanded_span(expanded.data(), dim);
+    KernelTable const&            active  = active_kernels();
+
+    for (size_t const ratio: intersect.ratios)
+    {
+        AlignedBuffer<double> const dense_a = random_sparse(dim, 0.125/ratio, 4);
+        SparseVector<int64_t> const a       = make_sparse_vector<int64_t>(std::span<double const>(dense_a.data(), dim));
+        size_t const                nnz     = a.indices.size();
+        size_t const                total   = nnz + b.indices.size();
+
+        // bytes per nonzero: position and value
+        BenchmarkResult const reference = benchmark_callable([&]()
+        {
+            return scalar_omp_sparse_sparse(a, b);
+        }, total, sizeof(int64_t) + sizeof(double), 2.0*nnz/total, settings);
+
+        auto const row = [&](std::string const &name, BenchmarkResult const &res)
+        {
+            IntersectRow const r = {name, ratio, nnz, res, 1.0e-6*total/res.stats.median,
+                                    reference.stats.median/res.stats.median,
+                                    std::abs(res.result - reference.result)/std::abs(reference.result)};
+            print_intersect_row(&r, out, intersect.csv);
+        };
+        row("scalar merge", reference);
+
+        // what has to be done without intersecting kernels: expand the larger vector before every call
+        row(std::string(active.id) + " expand + gather", benchmark_callable([&]()
+        {
+            double* const e = expanded.data();
+
+            #pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < dim; ++i)
+            {
+                e[i] = 0.0;
+            }
+            for (size_t j = 0; j < b.indices.size(); ++j)
+            {
+                e[b.indices[j]] = b.values[j];
+            }
+            return active.sparse(a, expanded_span);
+        }, total, sizeof(int64_t) + sizeof(double), 2.0*nnz/total, settings));
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((intersect.ids.empty() == false) && (std::find(intersect.ids.begin(), intersect.ids.end(), table->id) == intersect.ids.end()))
+            {
+                continue;
+            }
+
+            row(std::string(table->id) + " intersect", benchmark_callable([&]()
+            {
+                return table->sparse_sparse(a, b);
+            }, total, sizeof(int64_t) + sizeof(double), 2.0*nnz/total, settings));
+        }
+    }
+}
+
+#endif // SPARSE_RATIO_H_INCLUDED
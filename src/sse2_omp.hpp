@@ -0,0 +1,213 @@
+#ifndef SSE2_OMP_H_INCLUDED
+#define SSE2_OMP_H_INCLUDED
+
+/**
+ * \file     sse2_omp.hpp
+ * \brief    dot product calculated with SSE2 intrinsics and OpenMP
+ * \mainpage Dot product: manual SSE2 implementation by means of double
+ *           intrinsics with OpenMP parallel for with propietary reduction
+ *           operation and partial loop unrolling so a single core always
+ *           works on its entire cache line. SSE2 is part of the x86-64
+ *           baseline and serves as fallback for hosts without AVX2. The
+ *           unaligned variant accepts spans of any length and alignment by
+ *           peeling the head and handling the tail element-wise.
+ * \warning  The arrays must be cache aligned (except for the unaligned variant)!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+#ifdef __SSE2__
+
+/// header for SSE2 intrinsics
+#include <emmintrin.h>
+
+// size of the intrinsic (SSE2: 128/8=16) and corresponding number of values of type INTR
+#define SSE2_INTR_SIZE     sizeof(__m128d)
+#define SSE2_REG_SIZE      sizeof(__m128d)/sizeof(INTR)
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/// propietary OpenMP reduction operation for SSE2
+#pragma omp declare reduction \
+    (addpd: __m128d: omp_out = _mm_add_pd(omp_out, omp_in)) \
+    initializer(omp_priv = _mm_setzero_pd())
+
+
+/**\fn        _mm_reduce_add_pd
+ * \brief     Horizontal add function of both numbers in a 128bit SSE2 double intrinsic
+ *
+ * \param[in] _a   a 128bit SSE2 intrinsic with 2 double numbers
+ * \return    The horizontal added intrinsic as a double number
+*/
+static inline double _mm_reduce_add_pd(__m128d _a)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(_a, _mm_unpackhi_pd(_a, _a)));
+}
+
+
+/**\struct SimdSse2
+ * \brief  Traits class of the SSE2 instruction set for the policy-based kernel (SSE2
+ *         has no fused multiply-add, it is emulated by a multiplication and an addition)
+*/
+struct SimdSse2
+{
+    typedef double  value_type;
+    typedef double  y_type;
+    typedef double  result_type;
+    typedef __m128d reg;
+    typedef __m128d acc;
+    static constexpr size_t width          = SSE2_INTR_SIZE/sizeof(double);
+    static constexpr size_t flush_interval = 0;
+
+    static inline reg    zero()                         { return _mm_setzero_pd();                    }
+    static inline reg    load(double const* p)          { return _mm_load_pd(p);                      }
+    static inline reg    loadu(double const* p)         { return _mm_loadu_pd(p);                     }
+    static inline reg    broadcast(double const v)      { return _mm_set1_pd(v);                      }
+    static inline void   storeu(double* p, reg _a)      { _mm_storeu_pd(p, _a);                       }
+    static inline reg    add(reg _a, reg _b)            { return _mm_add_pd(_a, _b);                  }
+    static inline reg    mul(reg _a, reg _b)            { return _mm_mul_pd(_a, _b);                  }
+    static inline reg    fmadd(reg _a, reg _b, reg _c)  { return _mm_add_pd(_mm_mul_pd(_a, _b), _c);  }
+    static inline reg    min(reg _a, reg _b)            { return _mm_min_pd(_a, _b);                  }
+    static inline reg    max(reg _a, reg _b)            { return _mm_max_pd(_a, _b);                  }
+    static inline double reduce(reg _a)                 { return _mm_reduce_add_pd(_a);               }
+
+    /// load the first n (at most width) elements and set the remaining lanes to zero without accessing them
+    static inline reg load_partial(double const* p, size_t const n)
+    {
+        return (n >= width) ? _mm_loadu_pd(p) : ((n == 1) ? _mm_load_sd(p) : _mm_setzero_pd());
+    }
+
+    /// swap the real and imaginary part of the complex number (see complex.hpp)
+    static inline reg swap_pairs(reg _a)
+    {
+        return _mm_shuffle_pd(_a, _a, 1);
+    }
+
+    /// load the complex number of a register, there is no second one the increment inc would apply to
+    static inline reg load_strided(double const* p, std::ptrdiff_t const)
+    {
+        return _mm_loadu_pd(p);
+    }
+};
+
+
+/**\fn        sse2_omp_span
+ * \brief     Calculate dot product of two vectors \p x and \p y using 128bit
+ *            SSE2 double intrinsics (2 double numbers, a quarter cache line),
+ *            container: C++ span
+ *
+ * \param[in] x   an aligned C++ span
+ * \param[in] y   an aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double sse2_omp_span(std::span<double> const &x, std::span<double> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const N = x.size();
+    assert(N % (4*SSE2_REG_SIZE) == 0);
+
+    // divide cache line into four variables handled by the same processor
+    __m128d _res1 = _mm_setzero_pd();
+    __m128d _res2 = _mm_setzero_pd();
+    __m128d _res3 = _mm_setzero_pd();
+    __m128d _res4 = _mm_setzero_pd();
+
+    #pragma omp parallel for shared(x, y) reduction(addpd: _res1, _res2, _res3, _res4)
+    for (size_t i = 0; i < N; i += 4*SSE2_REG_SIZE)
+    {
+        // use partial loop unrolling in order to cover entire cache line (no FMA available)
+        _res1 = _mm_add_pd(_res1, _mm_mul_pd(_mm_load_pd(&x[i]),                 _mm_load_pd(&y[i])));
+        _res2 = _mm_add_pd(_res2, _mm_mul_pd(_mm_load_pd(&x[i+  SSE2_REG_SIZE]), _mm_load_pd(&y[i+  SSE2_REG_SIZE])));
+        _res3 = _mm_add_pd(_res3, _mm_mul_pd(_mm_load_pd(&x[i+2*SSE2_REG_SIZE]), _mm_load_pd(&y[i+2*SSE2_REG_SIZE])));
+        _res4 = _mm_add_pd(_res4, _mm_mul_pd(_mm_load_pd(&x[i+3*SSE2_REG_SIZE]), _mm_load_pd(&y[i+3*SSE2_REG_SIZE])));
+    }
+
+    // reduce all intrinsics to single double
+    __m128d _res = _mm_add_pd(_mm_add_pd(_res1, _res2), _mm_add_pd(_res3, _res4));
+    return _mm_reduce_add_pd(_res);
+}
+
+
+/**\fn        sse2_omp_unaligned
+ * \brief     Calculate dot product of two vectors \p x and \p y of arbitrary length and
+ *            alignment using 128bit SSE2 double intrinsics: the head is peeled up to
+ *            the next cache line boundary of \p x, the main loop works on entire cache
+ *            lines of \p x and the tail is handled element-wise (SSE2 has no masked
+ *            loads), container: C++ span
+ *
+ * \param[in] x   a (un)aligned C++ span
+ * \param[in] y   a (un)aligned C++ span
+ * \return    Dot product of the two vectors
+*/
+inline double sse2_omp_unaligned(std::span<double const> const &x, std::span<double const> const &y)
+{
+    assert(x.size() == y.size());
+    size_t const N = x.size();
+    double const* const px = x.data();
+    double const* const py = y.data();
+
+    // split into peeled head, main loop over aligned cache lines of x and tail
+    size_t const line   = 4*SSE2_REG_SIZE;
+    size_t const offset = (reinterpret_cast<std::uintptr_t>(px) % CACHE_LINE)/sizeof(double);
+    size_t const head   = std::min(N, (line - offset) % line);
+    size_t const end    = head + (N - head)/line*line;
+
+    double rest = 0.0;
+    for (size_t i = 0; i < head; ++i)
+    {
+        rest += px[i]*py[i];
+    }
+
+    // divide cache line into four variables handled by the same processor
+    __m128d _res1 = _mm_setzero_pd();
+    __m128d _res2 = _mm_setzero_pd();
+    __m128d _res3 = _mm_setzero_pd();
+    __m128d _res4 = _mm_setzero_pd();
+
+    #pragma omp parallel for reduction(addpd: _res1, _res2, _res3, _res4)
+    for (size_t i = head; i < end; i += line)
+    {
+        _res1 = _mm_add_pd(_res1, _mm_mul_pd(_mm_load_pd(px + i),                 _mm_loadu_pd(py + i)));
+        _res2 = _mm_add_pd(_res2, _mm_mul_pd(_mm_load_pd(px + i+  SSE2_REG_SIZE), _mm_loadu_pd(py + i+  SSE2_REG_SIZE)));
+        _res3 = _mm_add_pd(_res3, _mm_mul_pd(_mm_load_pd(px + i+2*SSE2_REG_SIZE), _mm_loadu_pd(py + i+2*SSE2_REG_SIZE)));
+        _res4 = _mm_add_pd(_res4, _mm_mul_pd(_mm_load_pd(px + i+3*SSE2_REG_SIZE), _mm_loadu_pd(py + i+3*SSE2_REG_SIZE)));
+    }
+
+    for (size_t i = end; i < N; ++i)
+    {
+        rest += px[i]*py[i];
+    }
+
+    // reduce all intrinsics to single double
+    __m128d _res = _mm_add_pd(_mm_add_pd(_res1, _res2), _mm_add_pd(_res3, _res4));
+    return _mm_reduce_add_pd(_res) + rest;
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif //__SSE2__
+
+#endif // SSE2_OMP_H_INCLUDED
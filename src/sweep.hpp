@@ -0,0 +1,198 @@
+#ifndef SWEEP_H_INCLUDED
+#define SWEEP_H_INCLUDED
+
+/**
+ * \file     sweep.hpp
+ * \mainpage Sweep of the vector length across the cache hierarchy: the selected
+ *           kernels are benchmarked for geometrically growing lengths, starting
+ *           from L1-resident vectors up to several times the last level cache, in
+ *           order to determine the crossover points between the kernels.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <assert.h>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "cpu_features.hpp"
+#include "init.hpp"
+
+
+/**\struct SweepSettings
+ * \brief  Settings of the length sweep
+*/
+struct SweepSettings
+{
+    size_t min_length        = 256;       ///< smallest number of elements per vector
+    size_t max_length        = 0;         ///< largest number of elements per vector, 0 for llc_factor times the last level cache
+    size_t llc_factor        = 4;         ///< working set of the largest length in multiples of the last level cache
+    size_t points_per_octave = 2;         ///< number of lengths per doubling of the length
+    size_t min_elements      = 10000000;  ///< minimum number of elements processed per sample (determines the iterations)
+    bool   csv               = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\fn        sweep_lengths
+ * \brief     Geometric series of vector lengths between \p min_length and \p max_length,
+ *            each rounded up to a multiple of the cache line so that no padding is required
+ *
+ * \param[in] min_length          smallest number of elements
+ * \param[in] max_length          largest number of elements
+ * \param[in] points_per_octave   number of lengths per doubling of the length
+ * \return    Vector of strictly increasing lengths
+*/
+template <typename T = double>
+inline std::vector<size_t> sweep_lengths(size_t const min_length, size_t const max_length, size_t const points_per_octave)
+{
+    assert(min_length > 0);
+    assert(points_per_octave > 0);
+
+    constexpr size_t per_line = CACHE_LINE/sizeof(T);
+    double const     factor   = std::pow(2.0, 1.0/points_per_octave);
+
+    std::vector<size_t> lengths;
+    for (double l = static_cast<double>(min_length); l <= static_cast<double>(max_length)*(1.0 + 1.0e-9); l *= factor)
+    {
+        size_t const length = (static_cast<size_t>(std::llround(l)) + per_line - 1)/per_line*per_line;
+        if (lengths.empty() || (length > lengths.back()))
+        {
+            lengths.push_back(length);
+        }
+    }
+    return lengths;
+}
+
+
+/**\fn        cache_level
+ * \brief     Name of the smallest cache level that fits a working set of \p bytes
+ *
+ * \param[in] bytes    size of the working set in bytes
+ * \param[in] caches   the cache sizes of the host
+ * \return    Name of the cache level ("L1", "L2", "L3" or "DRAM")
+*/
+inline char const* cache_level(size_t const bytes, CacheSizes const &caches)
+{
+    if ((caches.l1 > 0) && (bytes <= caches.l1)) return "L1";
+    if ((caches.l2 > 0) && (bytes <= caches.l2)) return "L2";
+    if ((caches.l3 > 0) && (bytes <= caches.l3)) return "L3";
+    return "DRAM";
+}
+
+
+/**\fn         run_length_sweep
+ * \brief      Benchmark the given kernels for a geometric series of vector lengths
+ *             and print the throughput as a table (GB/s per kernel, cache boundaries
+ *             marked by separator lines) or as comma-separated values (one line per
+ *             kernel and length, cache sizes as comments)
+ *
+ * \param[in]  kernels    the kernels to be benchmarked
+ * \param[in]  sweep      settings of the sweep
+ * \param[in]  settings   settings of the benchmark harness (the iterations are adapted
+ *                        to the length)
+ * \param[out] out        stream the results are written to
+*/
+template <typename T = double, typename Y = typename DotTraits<T>::y_type>
+inline void run_length_sweep(std::vector<NamedKernel<T>> const &kernels, SweepSettings const &sweep,
+                             BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    CacheSizes const caches = detect_cache_sizes();
+    size_t const     llc    = (caches.l3 > 0) ? caches.l3 : ((caches.l2 > 0) ? caches.l2 : (32 << 20));
+
+    // working set consists of two vectors
+    size_t const max_length = (sweep.max_length > 0) ? sweep.max_length
+                                                      : sweep.llc_factor*llc/(2*sizeof(T));
+    std::vector<size_t> const lengths = sweep_lengths<T>(sweep.min_length, max_length, sweep.points_per_octave);
+
+    if (sweep.csv == true)
+    {
+        out << "# cache,L1," << caches.l1 << std::endl;
+        out << "# cache,L2," << caches.l2 << std::endl;
+        out << "# cache,L3," << caches.l3 << std::endl;
+        out << "length,bytes,level,kernel,median_s,min_s,mean_s,stddev_s,mad_s,rejected,ns_per_elem,gbs,gflops,result" << std::endl;
+    }
+    else
+    {
+        out << "LENGTH SWEEP (throughput in GB/s, L1 " << (caches.l1 >> 10) << " KiB, L2 "
+            << (caches.l2 >> 10) << " KiB, L3 " << (caches.l3 >> 10) << " KiB)" << std::endl;
+        out << std::setw(12) << "length" << std::setw(12) << "size[KiB]" << std::setw(7) << "level";
+        for (NamedKernel<T> const &kernel: kernels)
+        {
+            out << std::setw(13) << kernel.name;
+        }
+        out << "   best" << std::endl;
+    }
+
+    std::string previous_level;
+    for (size_t const length: lengths)
+    {
+        size_t const      bytes = 2*length*sizeof(T);
+        std::string const level = cache_level(bytes, caches);
+
+        AlignedBuffer<T> x(init_vec<T>(length));
+        AlignedBuffer<Y> y(init_vec<Y>(length, 1));
+        std::span<T> const x_span = x.span();
+        std::span<Y> const y_span = y.span();
+
+        BenchmarkSettings adapted = settings;
+        adapted.iterations = std::max<size_t>(1, sweep.min_elements/length);
+
+        if ((sweep.csv == false) && (level != previous_level) && (previous_level.empty() == false))
+        {
+            out << "  ---- working set exceeds " << previous_level << " ----" << std::endl;
+        }
+        previous_level = level;
+
+        if (sweep.csv == false)
+        {
+            out << std::setw(12) << length << std::setw(12) << std::fixed << std::setprecision(1)
+                << bytes/1024.0 << std::setw(7) << level << std::setprecision(2);
+        }
+
+        std::string best_name;
+        double      best_gbs = 0.0;
+        for (NamedKernel<T> const &kernel: kernels)
+        {
+            BenchmarkResult const res = benchmark_fun<std::span<T>>(x_span, y_span, kernel.fun, adapted);
+            if (res.gbs > best_gbs)
+            {
+                best_gbs  = res.gbs;
+                best_name = kernel.name;
+            }
+
+            if (sweep.csv == true)
+            {
+                Statistics const &s = res.stats;
+                out << std::scientific << std::setprecision(6)
+                    << length << "," << bytes << "," << level << "," << kernel.name << ","
+                    << s.median << "," << s.min << "," << s.mean << "," << s.stddev << "," << s.mad << ","
+                    << s.rejected << "," << res.ns_per_elem << "," << res.gbs << "," << res.gflops << ","
+                    << res.result << std::endl;
+            }
+            else
+            {
+                out << std::setw(13) << res.gbs << std::flush;
+            }
+        }
+
+        if (sweep.csv == false)
+        {
+            out << "   " << best_name << std::endl;
+        }
+    }
+}
+
+#endif // SWEEP_H_INCLUDED
@@ -0,0 +1,323 @@
+#ifndef TOPK_H_INCLUDED
+#define TOPK_H_INCLUDED
+
+/**
+ * \file     topk.hpp
+ * \brief    maximum inner product search: the k vectors of a collection with the
+ *           largest dot product with a query
+ * \mainpage Top-k search over a resident collection of vectors: the vectors are sorted
+ *           by decreasing norm and stored in blocks of TOPK_BLOCK vectors. Inside a
+ *           block element i of all vectors is contiguous, so that the dot products of
+ *           all vectors of a block with the query are computed in registers by
+ *           broadcasting the elements of the query. Every thread keeps the k best
+ *           candidates it has seen in a bounded heap, the heaps of the threads are
+ *           merged at the end. Blocks whose largest norm times the norm of the query
+ *           (Cauchy-Schwarz bound) is smaller than the k-th best score of the thread
+ *           are skipped without computing a single dot product: as no vector of such
+ *           a block can enter the heap of the thread, it can neither enter the global
+ *           result and the pruning is exact. Sorting by norm makes the bounds tight
+ *           and lets the threads find good candidates early.
+ * \warning  The traits class must be compiled with the flags of its instruction set!
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#if __has_include (<omp.h>)
+    #include <omp.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include "align.hpp"
+#include "isa_namespace.hpp"
+
+
+/// number of vectors of a block of the collection (multiple of the register widths)
+#define TOPK_BLOCK 64
+
+
+/**\struct ScoredIndex
+ * \brief  A candidate of the search: index of a vector and its dot product with the query
+*/
+struct ScoredIndex
+{
+    double score;  ///< dot product with the query
+    size_t index;  ///< index of the vector in the collection
+};
+
+
+/**\struct BlockedCollection
+ * \brief  Collection of vectors sorted by decreasing norm and stored in blocks of
+ *         TOPK_BLOCK vectors with element i of all vectors of a block contiguous
+*/
+struct BlockedCollection
+{
+    size_t                dim  = 0;   ///< number of elements of a vector
+    size_t                size = 0;   ///< number of vectors
+    AlignedBuffer<double> data;       ///< the blocks (the last one padded with zero vectors)
+    std::vector<size_t>   ids;        ///< original index of every stored vector
+    std::vector<double>   max_norm;   ///< largest norm of the vectors of every block
+};
+
+
+inline namespace ISA_NAMESPACE
+{
+
+
+/**\fn        better_candidate
+ * \brief     Order of the candidates: larger dot products first, ties are broken by the
+ *            smaller index so that the result is unique
+ *
+ * \param[in] a   a candidate
+ * \param[in] b   another candidate
+ * \return    Boolean flag signalling if \p a ranks before \p b
+*/
+inline bool better_candidate(ScoredIndex const &a, ScoredIndex const &b)
+{
+    return (a.score > b.score) || (!(a.score < b.score) && !(b.score < a.score) && (a.index < b.index));
+}
+
+
+/**\fn        make_blocked_collection
+ * \brief     Store the \p vectors of \p dim elements each (one after the other) in a
+ *            blocked collection sorted by decreasing norm
+ *
+ * \param[in] vectors   the vectors one after the other
+ * \param[in] dim       number of elements of a vector
+ * \return    The blocked collection
+*/
+inline BlockedCollection make_blocked_collection(std::span<double const> const &vectors, size_t const dim)
+{
+    assert((dim > 0) && (vectors.size() % dim == 0));
+
+    BlockedCollection collection;
+    collection.dim  = dim;
+    collection.size = vectors.size()/dim;
+
+    size_t const        size   = collection.size;
+    size_t const        blocks = (size + TOPK_BLOCK - 1)/TOPK_BLOCK;
+    std::vector<double> norms(size, 0.0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t v = 0; v < size; ++v)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < dim; ++i)
+        {
+            sum += vectors[v*dim + i]*vectors[v*dim + i];
+        }
+        norms[v] = std::sqrt(sum);
+    }
+
+    collection.ids.resize(size);
+    std::iota(collection.ids.begin(), collection.ids.end(), 0);
+    std::stable_sort(collection.ids.begin(), collection.ids.end(), [&norms](size_t const a, size_t const b)
+                     { return norms[a] > norms[b]; });
+
+    collection.data     = AlignedBuffer<double>(blocks*TOPK_BLOCK*dim);
+    collection.max_norm.assign(blocks, 0.0);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        double* const block = collection.data.data() + b*TOPK_BLOCK*dim;
+        for (size_t j = 0; (j < TOPK_BLOCK) && (b*TOPK_BLOCK + j < size); ++j)
+        {
+            size_t const v = collection.ids[b*TOPK_BLOCK + j];
+            for (size_t i = 0; i < dim; ++i)
+            {
+                block[i*TOPK_BLOCK + j] = vectors[v*dim + i];
+            }
+        }
+        collection.max_norm[b] = norms[collection.ids[b*TOPK_BLOCK]];
+    }
+
+    return collection;
+}
+
+
+/**\fn         omp_topk
+ * \brief      Search the \p k vectors of the \p collection with the largest dot product
+ *             with \p query: the blocks are handed out to the threads in the order of
+ *             decreasing norm, every thread keeps its k best candidates in a bounded
+ *             heap and skips blocks that cannot improve it (see the Cauchy-Schwarz
+ *             bound in topk.hpp). The dot products of a block are computed by
+ *             \p score_block.
+ *
+ * \param[in]  collection    the blocked collection
+ * \param[in]  query         the query of collection.dim elements
+ * \param[in]  k             number of wished results
+ * \param[out] hits          the (at most) k best vectors in the order of decreasing dot products
+ * \param[in]  score_block   callable computing the TOPK_BLOCK dot products of a block with the query
+ * \return     Number of blocks that were skipped
+*/
+template <typename Scorer>
+size_t omp_topk(BlockedCollection const &collection, std::span<double const> const &query, size_t const k,
+                std::vector<ScoredIndex> &hits, Scorer const &score_block)
+{
+    assert(query.size() == collection.dim);
+
+    size_t const dim    = collection.dim;
+    size_t const blocks = collection.max_norm.size();
+
+    double q_norm = 0.0;
+    for (size_t i = 0; i < dim; ++i)
+    {
+        q_norm += query[i]*query[i];
+    }
+    q_norm = std::sqrt(q_norm);
+
+    KernelVector<KernelVector<ScoredIndex>> heaps(omp_get_max_threads());
+    size_t pruned = 0;
+
+    #pragma omp parallel shared(collection, query, heaps) reduction(+: pruned)
+    {
+        // bounded heap with the worst of the k best candidates of the thread on top
+        KernelVector<ScoredIndex> &heap = heaps[omp_get_thread_num()];
+        heap.reserve(k + 1);
+        alignas(CACHE_LINE) double scores[TOPK_BLOCK];
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            if ((heap.size() == k) && ((k == 0) || (q_norm*collection.max_norm[b] < heap.front().score)))
+            {
+                ++pruned;
+                continue;
+            }
+
+            score_block(collection.data.data() + b*TOPK_BLOCK*dim, dim, query.data(), scores);
+
+            size_t const n = std::min<size_t>(TOPK_BLOCK, collection.size - b*TOPK_BLOCK);
+            for (size_t j = 0; j < n; ++j)
+            {
+                ScoredIndex const candidate = {scores[j], collection.ids[b*TOPK_BLOCK + j]};
+                if (heap.size() < k)
+                {
+                    heap.push_back(candidate);
+                    std::push_heap(heap.begin(), heap.end(), better_candidate);
+                }
+                else if ((k > 0) && (better_candidate(candidate, heap.front()) == true))
+                {
+                    std::pop_heap(heap.begin(), heap.end(), better_candidate);
+                    heap.back() = candidate;
+                    std::push_heap(heap.begin(), heap.end(), better_candidate);
+                }
+            }
+        }
+    }
+
+    // merge the heaps of the threads
+    KernelVector<ScoredIndex> merged;
+    for (KernelVector<ScoredIndex> const &heap: heaps)
+    {
+        merged.insert(merged.end(), heap.begin(), heap.end());
+    }
+    size_t const n = std::min(k, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + n, merged.end(), better_candidate);
+    hits.assign(merged.begin(), merged.begin() + n);
+
+    return pruned;
+}
+
+
+/**\fn         scalar_omp_topk
+ * \brief      Search the \p k vectors of the \p collection with the largest dot product
+ *             with \p query (see omp_topk) without manual vectorisation
+ *
+ * \param[in]  collection   the blocked collection
+ * \param[in]  query        the query of collection.dim elements
+ * \param[in]  k            number of wished results
+ * \param[out] hits         the (at most) k best vectors in the order of decreasing dot products
+ * \return     Number of blocks that were skipped
+*/
+inline size_t scalar_omp_topk(BlockedCollection const &collection, std::span<double const> const &query,
+                              size_t const k, std::vector<ScoredIndex> &hits)
+{
+    return omp_topk(collection, query, k, hits, [](double const* const block, size_t const dim,
+                                                   double const* const q, double* const scores)
+    {
+        std::fill(scores, scores + TOPK_BLOCK, 0.0);
+        for (size_t i = 0; i < dim; ++i)
+        {
+            for (size_t j = 0; j < TOPK_BLOCK; ++j)
+            {
+                scores[j] += block[i*TOPK_BLOCK + j]*q[i];
+            }
+        }
+    });
+}
+
+
+/**\fn         simd_score_block
+ * \brief      Calculate the dot products of all TOPK_BLOCK vectors of a block with the
+ *             query \p q with the instruction set \p Isa: the dot products are kept in
+ *             registers, every element of the query is broadcast and multiplied with
+ *             the corresponding elements of all vectors of the block
+ *
+ * \param[in]  block    pointer to the first element of the cache-aligned block
+ * \param[in]  dim      number of elements of a vector
+ * \param[in]  q        pointer to the first element of the query
+ * \param[out] scores   the TOPK_BLOCK dot products
+*/
+template <typename Isa>
+inline void simd_score_block(double const* const block, size_t const dim, double const* const q, double* const scores)
+{
+    typedef typename Isa::reg reg;
+    constexpr size_t width = Isa::width;
+    constexpr size_t regs  = TOPK_BLOCK/width;
+    static_assert(TOPK_BLOCK % width == 0, "A block must consist of entire registers");
+
+    reg _acc[regs];
+    for (size_t r = 0; r < regs; ++r)
+    {
+        _acc[r] = Isa::zero();
+    }
+    for (size_t i = 0; i < dim; ++i)
+    {
+        reg const _q = Isa::broadcast(q[i]);
+        #pragma GCC unroll 16
+        for (size_t r = 0; r < regs; ++r)
+        {
+            _acc[r] = Isa::fmadd(Isa::load(block + i*TOPK_BLOCK + r*width), _q, _acc[r]);
+        }
+    }
+    for (size_t r = 0; r < regs; ++r)
+    {
+        Isa::storeu(scores + r*width, _acc[r]);
+    }
+}
+
+
+/**\fn         simd_omp_topk
+ * \brief      Search the \p k vectors of the \p collection with the largest dot product
+ *             with \p query (see omp_topk) with the instruction set \p Isa
+ *
+ * \param[in]  collection   the blocked collection
+ * \param[in]  query        the query of collection.dim elements
+ * \param[in]  k            number of wished results
+ * \param[out] hits         the (at most) k best vectors in the order of decreasing dot products
+ * \return     Number of blocks that were skipped
+*/
+template <typename Isa>
+inline size_t simd_omp_topk(BlockedCollection const &collection, std::span<double const> const &query,
+                            size_t const k, std::vector<ScoredIndex> &hits)
+{
+    return omp_topk(collection, query, k, hits, simd_score_block<Isa>);
+}
+
+} // namespace ISA_NAMESPACE
+
+#endif // TOPK_H_INCLUDED
@@ -0,0 +1,252 @@
+#ifndef TOPK_SEARCH_H_INCLUDED
+#define TOPK_SEARCH_H_INCLUDED
+
+/**
+ * \file     topk_search.hpp
+ * \mainpage Benchmark of the maximum inner product search (see topk.hpp) for
+ *           collections of 10^4 vectors up to a maximum size in steps of a factor of
+ *           ten. The vectors are centred random numbers scaled by a random factor per
+ *           vector, so that their norms vary like the ones of real embeddings. For
+ *           every instruction set of the host the queries per second, the fraction of
+ *           blocks skipped by the Cauchy-Schwarz bound and the recall with respect to
+ *           an exhaustive search are reported. The exhaustive search computes the dot
+ *           products with all vectors (GEMV) and sorts them afterwards, its queries per
+ *           second are reported as a reference as well.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "dispatch.hpp"
+#include "gemv.hpp"
+#include "random.hpp"
+#include "topk.hpp"
+
+
+/**\struct TopkSettings
+ * \brief  Settings of the benchmark of the maximum inner product search
+*/
+struct TopkSettings
+{
+    size_t                   max_size = 10000000;  ///< number of vectors of the largest collection
+    size_t                   dim      = 16;        ///< number of elements of a vector
+    size_t                   k        = 10;        ///< number of wished results per query
+    size_t                   queries  = 16;        ///< number of queries per sample
+    std::vector<std::string> ids;                  ///< identifiers of the instruction sets to be benchmarked, all if empty
+    bool                     csv      = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\struct TopkRow
+ * \brief  Result of a single kernel and collection of the benchmark of the search
+*/
+struct TopkRow
+{
+    std::string     name;         ///< name of the kernel
+    size_t          size;         ///< number of vectors of the collection
+    BenchmarkResult res;          ///< statistics of the kernel for all queries
+    double          qps;          ///< queries per second
+    double          pruned;       ///< fraction of the blocks skipped by the bound
+    double          recall;       ///< fraction of the results of the exhaustive search that were found
+};
+
+
+/**\fn         print_topk_row
+ * \brief      Print a row of the benchmark of the maximum inner product search (or the
+ *             header if \p row is nullptr)
+ *
+ * \param[in]  row   the row to be printed or nullptr for the header
+ * \param[out] out   stream the row is written to
+ * \param[in]  csv   print comma-separated values instead of a table
+*/
+inline void print_topk_row(TopkRow const* const row, std::ostream &out, bool const csv)
+{
+    if (row == nullptr)
+    {
+        if (csv == true)
+        {
+            out << "kernel,vectors,median_s,min_s,mad_s,queries_per_s,pruned,recall" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(28) << " kernel" << std::right << std::setw(12) << "vectors"
+            << std::setw(12) << "median[us]" << std::setw(10) << "MAD%" << std::setw(12) << "queries/s"
+            << std::setw(10) << "pruned%" << std::setw(10) << "recall" << std::endl;
+        return;
+    }
+
+    Statistics const &s = row->res.stats;
+    if (csv == true)
+    {
+        out << std::scientific << std::setprecision(6)
+            << row->name << "," << row->size << "," << s.median << "," << s.min << "," << s.mad << ","
+            << row->qps << "," << row->pruned << "," << row->recall << std::endl;
+        return;
+    }
+    out << std::fixed << std::left << std::setw(28) << (" -" + row->name) << std::right << std::setw(12) << row->size
+        << std::setprecision(3) << std::setw(12) << s.median*1.0e6 << std::setprecision(2)
+        << std::setw(10) << 100.0*s.mad/s.median << std::setprecision(1) << std::setw(12) << row->qps
+        << std::setprecision(2) << std::setw(10) << 100.0*row->pruned << std::setprecision(4)
+        << std::setw(10) << row->recall << std::endl;
+}
+
+
+/**\fn        random_embeddings
+ * \brief     Fill a buffer with \p count vectors of \p dim centred random elements, every
+ *            vector scaled by the square of a random number in [0,1) so that the norms
+ *            vary strongly (streams \p stream and \p stream + 1 of the seed)
+ *
+ * \param[in] count    number of vectors
+ * \param[in] dim      number of elements of a vector
+ * \param[in] stream   number of the random stream
+ * \return    The vectors one after the other
+*/
+inline AlignedBuffer<double> random_embeddings(size_t const count, size_t const dim, std::uint64_t const stream)
+{
+    AlignedBuffer<double> vectors(count*dim);
+    random_fill(vectors.data(), count*dim, stream);
+
+    std::uint64_t const key = random_key(random_seed(), stream + 1);
+    double* const       v   = vectors.data();
+
+    #pragma omp parallel for schedule(static)
+    for (size_t j = 0; j < count; ++j)
+    {
+        double const scale = random_unit(random_bits(key, j));
+        for (size_t i = 0; i < dim; ++i)
+        {
+            v[j*dim + i] = (v[j*dim + i] - 0.5)*scale*scale;
+        }
+    }
+    return vectors;
+}
+
+
+/**\fn         exhaustive_topk
+ * \brief      Search the \p k vectors with the largest dot product with \p query by
+ *             computing the dot products with all vectors (GEMV) and sorting them
+ *
+ * \param[in]  table     kernel table of the instruction set
+ * \param[in]  vectors   the vectors one after the other
+ * \param[in]  query     the query
+ * \param[in]  k         number of wished results
+ * \param[out] scores    the dot products with all vectors
+ * \param[out] hits      the k best vectors in the order of decreasing dot products
+*/
+inline void exhaustive_topk(KernelTable const &table, std::span<double const> const &vectors,
+                            std::span<double const> const &query, size_t const k,
+                            std::vector<double> &scores, std::vector<ScoredIndex> &hits)
+{
+    table.gemv(vectors, Layout::row_major, query, scores);
+
+    hits.resize(scores.size());
+    for (size_t j = 0; j < scores.size(); ++j)
+    {
+        hits[j] = {scores[j], j};
+    }
+    size_t const n = std::min(k, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + n, hits.end(), better_candidate);
+    hits.resize(n);
+}
+
+
+/**\fn         run_topk_search
+ * \brief      Benchmark the maximum inner product search of the instruction sets supported
+ *             by the host for collections of increasing size
+ *
+ * \param[in]  topk       settings of the benchmark of the search
+ * \param[in]  settings   settings of the benchmark harness
+ * \param[out] out        stream the results are written to
+*/
+inline void run_topk_search(TopkSettings const &topk, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    if (topk.csv == false)
+    {
+        out << "MAXIMUM INNER PRODUCT SEARCH (top " << topk.k << " of vectors with " << topk.dim << " elements, "
+            << topk.queries << " queries, blocks of " << TOPK_BLOCK << " vectors)" << std::endl;
+    }
+    print_topk_row(nullptr, out, topk.csv);
+
+    AlignedBuffer<double> const queries = random_embeddings(topk.queries, topk.dim, 4);
+    auto const query = [&](size_t const q)
+    {
+        return std::span<double const>(queries.data() + q*topk.dim, topk.dim);
+    };
+
+    // collections of 10^4, 10^5, ... vectors (a single one if the largest is smaller)
+    for (size_t size = std::min<size_t>(10000, topk.max_size); size <= topk.max_size; size *= 10)
+    {
+        AlignedBuffer<double> const   vectors = random_embeddings(size, topk.dim, 2);
+        std::span<double const> const vectors_span(vectors.data(), size*topk.dim);
+        BlockedCollection const       collection = make_blocked_collection(vectors_span, topk.dim);
+        size_t const                  blocks     = collection.max_norm.size();
+
+        // exhaustive search as reference
+        std::vector<double>                   scores(size, 0.0);
+        std::vector<std::vector<ScoredIndex>> reference(topk.queries);
+        BenchmarkResult const exhaustive = benchmark_callable([&]()
+        {
+            for (size_t q = 0; q < topk.queries; ++q)
+            {
+                exhaustive_topk(active_kernels(), vectors_span, query(q), topk.k, scores, reference[q]);
+            }
+            return reference[0].empty() ? 0.0 : reference[0][0].score;
+        }, size*topk.queries, sizeof(double)*topk.dim, 2.0*topk.dim, settings);
+        TopkRow const exhaustive_row = {std::string(active_kernels().id) + " exhaustive", size, exhaustive,
+                                        topk.queries/exhaustive.stats.median, 0.0, 1.0};
+        print_topk_row(&exhaustive_row, out, topk.csv);
+
+        for (KernelTable const* table: available_kernels())
+        {
+            if ((topk.ids.empty() == false) && (std::find(topk.ids.begin(), topk.ids.end(), table->id) == topk.ids.end()))
+            {
+                continue;
+            }
+
+            std::vector<std::vector<ScoredIndex>> hits(topk.queries);
+            size_t pruned = 0;
+            BenchmarkResult const res = benchmark_callable([&]()
+            {
+                pruned = 0;
+                for (size_t q = 0; q < topk.queries; ++q)
+                {
+                    pruned += table->topk(collection, query(q), topk.k, hits[q]);
+                }
+                return hits[0].empty() ? 0.0 : hits[0][0].score;
+            }, size*topk.queries, sizeof(double)*topk.dim, 2.0*topk.dim, settings);
+
+            size_t found = 0;
+            size_t total = 0;
+            for (size_t q = 0; q < topk.queries; ++q)
+            {
+                for (ScoredIndex const &r: reference[q])
+                {
+                    found += std::any_of(hits[q].begin(), hits[q].end(), [&r](ScoredIndex const &h){ return h.index == r.index; });
+                }
+                total += reference[q].size();
+            }
+
+            TopkRow const row = {std::string(table->id) + " top-k", size, res, topk.queries/res.stats.median,
+                                 static_cast<double>(pruned)/(blocks*topk.queries),
+                                 (total > 0) ? static_cast<double>(found)/total : 1.0};
+            print_topk_row(&row, out, topk.csv);
+        }
+    }
+}
+
+#endif // TOPK_SEARCH_H_INCLUDED
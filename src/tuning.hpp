@@ -0,0 +1,214 @@
+#ifndef TUNING_H_INCLUDED
+#define TUNING_H_INCLUDED
+
+/**
+ * \file     tuning.hpp
+ * \mainpage Benchmark of the instantiation matrix of the policy-based kernel
+ *           (see simd_kernel.hpp): every combination of unroll factor, number of
+ *           accumulators and prefetch distance compiled for the instruction sets of
+ *           the host is benchmarked for a working set resident in each cache level
+ *           and in main memory, and the fastest configuration per length is
+ *           reported.
+*/
+
+
+#if __has_include(<span>)
+    #include <span>
+#else
+    #include "span.hpp"
+    namespace std
+    {
+        using tcb::span;
+    }
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "align.hpp"
+#include "benchmark.hpp"
+#include "cpu_features.hpp"
+#include "dispatch.hpp"
+#include "init.hpp"
+#include "sweep.hpp"
+
+
+/**\struct TuneSettings
+ * \brief  Settings of the benchmark of the instantiation matrix
+*/
+struct TuneSettings
+{
+    size_t                   length       = 0;         ///< number of elements per vector, 0 for a length per cache level
+    size_t                   llc_factor   = 4;         ///< working set of the main memory length in multiples of the last level cache
+    std::vector<std::string> ids;                      ///< identifiers of the instruction sets to be benchmarked, all if empty
+    size_t                   min_elements = 20000000;  ///< minimum number of elements processed per sample (determines the iterations)
+    bool                     csv          = false;     ///< print comma-separated values instead of a table
+};
+
+
+/**\fn        variant_name
+ * \brief     Name of an instantiation \p variant of the policy-based kernel for the
+ *            instruction set of \p table, e.g. "avx512 u8 a4 p0"
+ *
+ * \param[in] table     kernel table the variant belongs to
+ * \param[in] variant   the instantiation
+ * \return    The name of the instantiation
+*/
+inline std::string variant_name(KernelTable const &table, KernelVariant const &variant)
+{
+    return std::string(table.id) + " u" + std::to_string(variant.unroll) + " a" + std::to_string(variant.accumulators)
+           + " p" + std::to_string(variant.prefetch);
+}
+
+
+/**\fn        tune_lengths
+ * \brief     Vector lengths whose working set (two vectors) fills half of each cache
+ *            level, and \p llc_factor times the last level cache for the main memory
+ *
+ * \param[in] caches       the cache sizes of the host
+ * \param[in] llc_factor   working set of the main memory length in multiples of the last level cache
+ * \return    Vector of the cache levels and the corresponding lengths
+*/
+template <typename T = double>
+inline std::vector<std::pair<std::string,size_t>> tune_lengths(CacheSizes const &caches, size_t const llc_factor)
+{
+    constexpr size_t per_line = CACHE_LINE/sizeof(T);
+    auto const round = [](size_t const bytes){ return std::max<size_t>(CACHE_LINE/sizeof(T), bytes/(2*sizeof(T))/per_line*per_line); };
+
+    std::vector<std::pair<std::string,size_t>> lengths;
+    if (caches.l1 > 0) lengths.push_back({"L1", round(caches.l1/2)});
+    if (caches.l2 > 0) lengths.push_back({"L2", round(caches.l2/2)});
+    if (caches.l3 > 0) lengths.push_back({"L3", round(caches.l3/2)});
+
+    size_t const llc = (caches.l3 > 0) ? caches.l3 : ((caches.l2 > 0) ? caches.l2 : (32 << 20));
+    lengths.push_back({"DRAM", round(llc_factor*llc)});
+    return lengths;
+}
+
+
+/**\fn         run_kernel_matrix
+ * \brief      Benchmark all instantiations of the policy-based kernel of the instruction
+ *             sets supported by the host for the given lengths and print the fastest
+ *             one per length together with its speed-up over a single register and
+ *             accumulator without prefetching
+ *
+ * \param[in]  tune       settings of the instantiation matrix
+ * \param[in]  settings   settings of the benchmark harness (the iterations are adapted
+ *                        to the length)
+ * \param[out] out        stream the results are written to
+*/
+inline void run_kernel_matrix(TuneSettings const &tune, BenchmarkSettings const &settings, std::ostream &out = std::cout)
+{
+    std::vector<KernelTable const*> tables;
+    for (KernelTable const* table: available_kernels())
+    {
+        if ((table->no_variants > 0) &&
+            (tune.ids.empty() || (std::find(tune.ids.begin(), tune.ids.end(), table->id) != tune.ids.end())))
+        {
+            tables.push_back(table);
+        }
+    }
+    if (tables.empty() == true)
+    {
+        std::cerr << "No instruction set with a policy-based kernel available on this host" << std::endl;
+        return;
+    }
+
+    CacheSizes const caches = detect_cache_sizes();
+    std::vector<std::pair<std::string,size_t>> const lengths = (tune.length > 0)
+        ? std::vector<std::pair<std::string,size_t>>{{cache_level(2*tune.length*sizeof(double), caches), tune.length}}
+        : tune_lengths<double>(caches, tune.llc_factor);
+
+    if (tune.csv == true)
+    {
+        out << "level,unroll,accumulators,prefetch,";
+        print_header(out, true);
+    }
+    else
+    {
+        out << "KERNEL MATRIX (unroll factor u, accumulators a, prefetch distance p in cache lines)" << std::endl;
+    }
+
+    // fastest instantiation per length and its speed-up over u1 a1 p0 of the same instruction set
+    struct Winner
+    {
+        std::string level;
+        size_t      length;
+        std::string name;
+        double      gbs;
+        double      speedup;
+    };
+    std::vector<Winner> winners;
+
+    for (auto const &[level, length]: lengths)
+    {
+        AlignedBuffer<double> x(init_vec<double>(length));
+        AlignedBuffer<double> y(init_vec<double>(length, 1));
+        std::span<double> const x_span = x.span();
+        std::span<double> const y_span = y.span();
+
+        BenchmarkSettings adapted = settings;
+        adapted.iterations = std::max<size_t>(1, tune.min_elements/length);
+
+        if (tune.csv == false)
+        {
+            out << std::endl << level << ": " << length << " elements (" << (2*length*sizeof(double) >> 10)
+                << " KiB)" << std::endl;
+            print_header(out, false);
+        }
+
+        Winner best = {level, length, "", 0.0, 0.0};
+        for (KernelTable const* table: tables)
+        {
+            double baseline = 0.0;
+            for (size_t v = 0; v < table->no_variants; ++v)
+            {
+                KernelVariant const  &variant = table->variants[v];
+                std::string const     name    = variant_name(*table, variant);
+                BenchmarkResult const res     = benchmark_fun<std::span<double>>(x_span, y_span, variant.dot_span, adapted);
+
+                if (tune.csv == true)
+                {
+                    out << level << "," << variant.unroll << "," << variant.accumulators << "," << variant.prefetch << ",";
+                }
+                print_result(name, res, out, tune.csv);
+
+                if ((variant.unroll == 1) && (variant.accumulators == 1) && (variant.prefetch == 0))
+                {
+                    baseline = res.gbs;
+                }
+                if (res.gbs > best.gbs)
+                {
+                    best.name    = name;
+                    best.gbs     = res.gbs;
+                    best.speedup = (baseline > 0.0) ? res.gbs/baseline : 0.0;
+                }
+            }
+        }
+        winners.push_back(best);
+    }
+
+    if (tune.csv == true)
+    {
+        for (Winner const &w: winners)
+        {
+            out << "# winner," << w.level << "," << w.length << "," << w.name << "," << w.gbs << "," << w.speedup << std::endl;
+        }
+        return;
+    }
+
+    out << std::endl << "WINNERS (speed-up over a single register and accumulator of the same instruction set)" << std::endl;
+    out << std::left << std::setw(6) << " level" << std::right << std::setw(12) << "length" << "   "
+        << std::left << std::setw(20) << "kernel" << std::right << std::setw(10) << "GB/s" << std::setw(10) << "speedup" << std::endl;
+    for (Winner const &w: winners)
+    {
+        out << std::fixed << std::setprecision(2) << std::left << std::setw(6) << (" " + w.level) << std::right
+            << std::setw(12) << w.length << "   " << std::left << std::setw(20) << w.name << std::right
+            << std::setw(10) << w.gbs << std::setw(10) << w.speedup << std::endl;
+    }
+}
+
+#endif // TUNING_H_INCLUDED